@@ -20,6 +20,9 @@ pub fn build(b: *std.Build) void {
     // of this build script using `b.option()`. All defined flags (including
     // target and optimize options) will be listed when running `zig build --help`
     // in this directory.
+    const metrics = b.option(bool, "metrics", "Count calls and time hot paths (zault_metrics_snapshot)") orelse false;
+    const build_options = b.addOptions();
+    build_options.addOption(bool, "metrics", metrics);
 
     // This creates a module, which represents a collection of source files alongside
     // some compilation options, such as optimization mode and linked system libraries.
@@ -40,6 +43,7 @@ pub fn build(b: *std.Build) void {
         // which requires us to specify a target.
         .target = target,
     });
+    mod.addOptions("build_options", build_options);
 
     // Here we define an executable. An executable needs to have a root module
     // which needs to expose a `main` function. While we could add a main function
@@ -154,6 +158,7 @@ pub fn build(b: *std.Build) void {
         .root_source_file = b.path("src/root.zig"),
         .target = wasm_target,
     });
+    wasm_zault_mod.addOptions("build_options", build_options);
 
     const wasm_ffi_mod = b.createModule(.{
         .root_source_file = b.path("src/ffi_wasm.zig"),
@@ -251,6 +256,37 @@ pub fn build(b: *std.Build) void {
     const run_ffi_tests = b.addRunArtifact(ffi_tests);
     test_step.dependOn(&run_ffi_tests.step);
 
+    // =========================================================================
+    // Benchmarks - `zig build bench [-- options]`, JSON results on stdout
+    // =========================================================================
+
+    // Debug numbers are meaningless; default to ReleaseFast unless a
+    // release mode was asked for explicitly
+    const bench_mod = b.createModule(.{
+        .root_source_file = b.path("src/bench.zig"),
+        .target = target,
+        .optimize = if (optimize == .Debug) .ReleaseFast else optimize,
+        .imports = &.{
+            .{ .name = "zault", .module = mod },
+        },
+    });
+    const bench_exe = b.addExecutable(.{
+        .name = "zault-bench",
+        .root_module = bench_mod,
+    });
+
+    const bench_step = b.step("bench", "Run benchmarks (JSON on stdout)");
+    const run_bench = b.addRunArtifact(bench_exe);
+    if (b.args) |args| {
+        run_bench.addArgs(args);
+    }
+    bench_step.dependOn(&run_bench.step);
+
+    const bench_tests = b.addTest(.{
+        .root_module = bench_mod,
+    });
+    test_step.dependOn(&b.addRunArtifact(bench_tests).step);
+
     // Just like flags, top level steps are also listed in the `--help` menu.
     //
     // The Zig build system is entirely implemented in userland, which means
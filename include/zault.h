@@ -31,8 +31,15 @@
  *
  * ## Thread Safety
  *
- * Individual handles are NOT thread-safe. Use separate handles per thread,
- * or protect access with external synchronization.
+ * Vault handles are thread-safe: any number of threads may add, get,
+ * list, share and verify through one handle, which loads the identity and
+ * master key once for all of them. Configure a vault (zault_vault_set_*)
+ * before other threads use it. Identity handles are NOT thread-safe; use
+ * one per thread or protect access with external synchronization.
+ *
+ * To run many vault operations at once without managing threads, create a
+ * ZaultAsync context (zault_async_create()) and submit them there; the
+ * vault may still be used through the blocking functions meanwhile.
  *
  * @copyright MIT License
  */
@@ -113,6 +120,11 @@ extern "C" {
 /** Serialized public identity length (both public keys) */
 #define ZAULT_PUBLIC_IDENTITY_LEN  3136  /* 1952 + 1184 */
 
+/** Verify every block signature on every read */
+#define ZAULT_VERIFY_ALWAYS     0
+/** Verify each block once per vault, then check only its hash (default) */
+#define ZAULT_VERIFY_MEMO       1
+
 /* ============================================================================
  * Opaque Types
  * ============================================================================ */
@@ -130,6 +142,12 @@ typedef struct ZaultVault ZaultVault;
  */
 typedef struct ZaultIdentity ZaultIdentity;
 
+/**
+ * Opaque async context handle.
+ * Create with zault_async_create(), destroy with zault_async_destroy().
+ */
+typedef struct ZaultAsync ZaultAsync;
+
 /* ============================================================================
  * Version Information
  * ============================================================================ */
@@ -258,9 +276,9 @@ void zault_vault_destroy(ZaultVault* vault);
  * Add a file to the vault with full encryption.
  *
  * The file is:
- * 1. Read from disk
+ * 1. Read from disk in fixed-size chunks (memory use does not grow with file size)
  * 2. Encrypted with a random per-file key (ChaCha20-Poly1305)
- * 3. Stored as content + metadata blocks
+ * 3. Stored as one content block per chunk, a chunk manifest and a metadata block
  * 4. Signed with the vault's ML-DSA-65 key
  *
  * @param vault          Vault handle
@@ -278,9 +296,175 @@ int zault_vault_add_file(
     size_t hash_out_len
 );
 
+/**
+ * Store a new version of a file already in the vault.
+ *
+ * The file is cut into content-defined chunks (dedup mode). Chunks whose
+ * content also appears in the previous version are only read and hashed;
+ * their blocks are reused without re-encrypting or re-signing. The new
+ * version is chained to the previous one and replaces it in the listing.
+ *
+ * @param vault          Vault handle
+ * @param previous_hash  32-byte metadata hash of the version being replaced
+ * @param file_path      Path to the new content
+ * @param file_path_len  Length of file_path
+ * @param hash_out       Buffer to receive the new 32-byte metadata hash
+ * @param hash_out_len   Buffer size (must be >= ZAULT_HASH_LEN)
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_update_file(
+    ZaultVault* vault,
+    const uint8_t* previous_hash,
+    const char* file_path,
+    size_t file_path_len,
+    uint8_t* hash_out,
+    size_t hash_out_len
+);
+
+/**
+ * Add a file to the vault from an open file descriptor.
+ *
+ * Same as zault_vault_add_file(), but reads from `fd` until EOF. Works with
+ * pipes and sockets as well as regular files. The descriptor is not closed.
+ *
+ * @param vault         Vault handle
+ * @param fd            Readable file descriptor
+ * @param name          Filename to record in the metadata (used for MIME type)
+ * @param name_len      Length of name
+ * @param hash_out      Buffer to receive 32-byte metadata block hash
+ * @param hash_out_len  Buffer size (must be >= ZAULT_HASH_LEN)
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_add_fd(
+    ZaultVault* vault,
+    int fd,
+    const char* name,
+    size_t name_len,
+    uint8_t* hash_out,
+    size_t hash_out_len
+);
+
+/**
+ * Set the number of threads used to encrypt and sign chunks on add.
+ *
+ * Affects zault_vault_add_file() and zault_vault_add_fd(). With more than
+ * one thread, chunks are sealed in parallel and written in file order;
+ * the resulting blocks are identical to a single-threaded add.
+ *
+ * @param vault    Vault handle
+ * @param threads  Worker threads (0 = one per CPU, 1 = no pipeline, default 1)
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_set_ingest_threads(ZaultVault* vault, size_t threads);
+
+/**
+ * Turn dedup mode on or off for files added from now on.
+ *
+ * In dedup mode files are cut into content-defined chunks, each encrypted
+ * under a key derived from the vault identity and the chunk content, so
+ * chunks already in the vault are not stored again. Off by default.
+ *
+ * @param vault    Vault handle
+ * @param enabled  Nonzero to enable
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_set_dedup(ZaultVault* vault, int enabled);
+
+/**
+ * Write new blocks in the compact format (version 0x02), naming the author
+ * by a 32-byte key fingerprint instead of embedding the 1952-byte public
+ * key. Off by default: older builds cannot read compact blocks or the
+ * ZAULT_BLOCKS_V2 exports that carry them.
+ *
+ * @param vault    Vault handle
+ * @param enabled  Nonzero to enable
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_set_compact_blocks(ZaultVault* vault, int enabled);
+
+/**
+ * Sign content chunks in batches under one Merkle root signature.
+ *
+ * Applies to files added from now on. Each chunk carries an inclusion
+ * proof instead of its own ML-DSA signature, so adding a file costs one
+ * signature per batch. 0 (the default) signs every chunk.
+ *
+ * @param vault   Vault handle
+ * @param leaves  Chunks per batch, at most 256
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_set_signature_batch(ZaultVault* vault, uint16_t leaves);
+
+/**
+ * Keep several block reads and writes in flight during import, export and get.
+ *
+ * Uses io_uring on Linux for vaults in the pack layout. Elsewhere, or when the
+ * kernel refuses io_uring, the vault keeps using synchronous I/O.
+ *
+ * @param vault  Vault handle
+ * @param depth  I/Os kept in flight (0 = off, the default)
+ * @return 1 if asynchronous I/O is in use, 0 if not, negative error code otherwise
+ */
+int zault_vault_set_io_queue_depth(ZaultVault* vault, uint16_t depth);
+
+/**
+ * Block cache counters.
+ */
+typedef struct ZaultCacheStats {
+    uint64_t metadata_hits;
+    uint64_t metadata_misses;
+    uint64_t content_hits;
+    uint64_t content_misses;
+    uint64_t evictions;
+    /** Bytes currently cached, including per-entry overhead */
+    uint64_t metadata_bytes;
+    uint64_t content_bytes;
+} ZaultCacheStats;
+
+/**
+ * Bound the cache of verified blocks.
+ *
+ * Repeated gets and share operations take blocks from this cache instead
+ * of reading them from disk and checking their signatures again. Metadata
+ * (including chunk manifests) and content chunks have separate budgets.
+ * Defaults: 16 MiB for metadata, content not cached.
+ *
+ * @param vault           Vault handle
+ * @param metadata_bytes  Budget for metadata blocks (0 = don't cache)
+ * @param content_bytes   Budget for content chunks (0 = don't cache)
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_set_cache_limits(ZaultVault* vault, size_t metadata_bytes, size_t content_bytes);
+
+/**
+ * Choose how block signatures are checked on read.
+ *
+ * With ZAULT_VERIFY_MEMO, each block's ML-DSA-65 signature is verified once
+ * and recorded in a MAC-protected set in the vault directory (verified.db).
+ * Later reads check only that the block still hashes to its address, which
+ * is much cheaper. ZAULT_VERIFY_ALWAYS verifies on every read.
+ *
+ * @param vault  Vault handle
+ * @param mode   ZAULT_VERIFY_ALWAYS or ZAULT_VERIFY_MEMO
+ * @return ZAULT_OK on success, ZAULT_ERR_INVALID_ARG for an unknown mode
+ */
+int zault_vault_set_verify_mode(ZaultVault* vault, int mode);
+
+/**
+ * Read the block cache counters.
+ *
+ * @param vault      Vault handle
+ * @param stats_out  Receives the counters
+ * @return ZAULT_OK on success, error code otherwise
+ */
+int zault_vault_cache_stats(ZaultVault* vault, ZaultCacheStats* stats_out);
+
 /**
  * Retrieve and decrypt a file from the vault.
  *
+ * The file is decrypted one chunk at a time straight into the output file,
+ * so memory use stays constant regardless of file size.
+ *
  * @param vault            Vault handle
  * @param hash             32-byte metadata block hash
  * @param hash_len         Must be ZAULT_HASH_LEN
@@ -296,6 +480,41 @@ int zault_vault_get_file(
     size_t output_path_len
 );
 
+/**
+ * Callback receiving decrypted file content.
+ *
+ * Called once per chunk, in file order. The data pointer is only valid for
+ * the duration of the call.
+ *
+ * @param ctx   User context passed to zault_vault_get_stream()
+ * @param data  Decrypted bytes
+ * @param len   Number of bytes
+ * @return 0 to continue, non-zero to abort the stream
+ */
+typedef int (*zault_write_fn)(void* ctx, const uint8_t* data, size_t len);
+
+/**
+ * Retrieve and decrypt a file, streaming plaintext to a callback.
+ *
+ * Uses a fixed-size buffer: each chunk is fetched, verified and decrypted,
+ * then handed to `write_fn` before the next chunk is read.
+ *
+ * @param vault     Vault handle
+ * @param hash      32-byte metadata block hash
+ * @param hash_len  Must be ZAULT_HASH_LEN
+ * @param write_fn  Callback receiving plaintext chunks
+ * @param ctx       User context passed to write_fn
+ * @return ZAULT_OK on success, ZAULT_ERR_IO if the callback aborted,
+ *         error code otherwise
+ */
+int zault_vault_get_stream(
+    ZaultVault* vault,
+    const uint8_t* hash,
+    size_t hash_len,
+    zault_write_fn write_fn,
+    void* ctx
+);
+
 /**
  * Get the vault's ML-KEM-768 public key for receiving shares.
  *
@@ -402,6 +621,142 @@ int zault_vault_import_blocks(
     size_t import_path_len
 );
 
+/* ============================================================================
+ * Asynchronous Vault Operations
+ * ============================================================================ */
+
+/**
+ * A finished asynchronous operation.
+ */
+typedef struct ZaultCompletion {
+    /** Request id returned by the submit call */
+    uint64_t id;
+    /** ZAULT_OK or an error code, as from the blocking function */
+    int status;
+    /** add: metadata block hash; redeem: shared file hash */
+    uint8_t hash[ZAULT_HASH_LEN];
+    /** create_share: token length (also set when token_out was too small) */
+    size_t len;
+} ZaultCompletion;
+
+/**
+ * Create a context that runs vault operations on a worker pool.
+ *
+ * Submit calls return immediately with a request id; results are collected
+ * with zault_async_poll() or zault_async_wait(), in completion order.
+ *
+ * @param vault    Vault handle; must outlive the context
+ * @param threads  Worker threads (0 = one per CPU)
+ * @return Context handle, or NULL on error
+ */
+ZaultAsync* zault_async_create(ZaultVault* vault, size_t threads);
+
+/**
+ * Wait for outstanding operations and free the context.
+ *
+ * Completions that were never collected are discarded.
+ *
+ * @param ctx  Context handle (may be NULL)
+ */
+void zault_async_destroy(ZaultAsync* ctx);
+
+/**
+ * Get a file descriptor that is readable while completions are waiting.
+ *
+ * For epoll/poll based event loops. Call zault_async_poll() when it
+ * becomes readable; do not read from it yourself.
+ *
+ * @param ctx  Context handle
+ * @return File descriptor (Linux), or -1 if unavailable
+ */
+int zault_async_fd(ZaultAsync* ctx);
+
+/**
+ * Queue zault_vault_add_file(). The hash arrives in the completion.
+ *
+ * @param ctx            Context handle
+ * @param file_path      Path to the file (copied)
+ * @param file_path_len  Length of file_path
+ * @return Request id, or 0 on invalid arguments or allocation failure
+ */
+uint64_t zault_async_add_file(ZaultAsync* ctx, const char* file_path, size_t file_path_len);
+
+/**
+ * Queue zault_vault_get_file().
+ *
+ * @param ctx              Context handle
+ * @param hash             32-byte metadata block hash (copied)
+ * @param hash_len         Must be ZAULT_HASH_LEN
+ * @param output_path      Where to write the file (copied)
+ * @param output_path_len  Length of output_path
+ * @return Request id, or 0 on failure
+ */
+uint64_t zault_async_get_file(
+    ZaultAsync* ctx,
+    const uint8_t* hash,
+    size_t hash_len,
+    const char* output_path,
+    size_t output_path_len
+);
+
+/**
+ * Queue zault_vault_create_share().
+ *
+ * @param ctx                  Context handle
+ * @param file_hash            32-byte metadata block hash (copied)
+ * @param file_hash_len        Must be ZAULT_HASH_LEN
+ * @param recipient_kem_pk     Recipient's ML-KEM-768 public key (copied)
+ * @param recipient_kem_pk_len Must be ZAULT_MLKEM768_PK_LEN
+ * @param expires_at           Unix timestamp when share expires
+ * @param token_out            Buffer for the token; must stay valid until
+ *                             the request completes
+ * @param token_out_len        Buffer size
+ * @return Request id, or 0 on failure
+ */
+uint64_t zault_async_create_share(
+    ZaultAsync* ctx,
+    const uint8_t* file_hash,
+    size_t file_hash_len,
+    const uint8_t* recipient_kem_pk,
+    size_t recipient_kem_pk_len,
+    int64_t expires_at,
+    uint8_t* token_out,
+    size_t token_out_len
+);
+
+/**
+ * Queue zault_vault_redeem_share(). The file hash arrives in the completion.
+ *
+ * @param ctx        Context handle
+ * @param token      Encrypted share token (copied)
+ * @param token_len  Token length
+ * @return Request id, or 0 on failure
+ */
+uint64_t zault_async_redeem_share(ZaultAsync* ctx, const uint8_t* token, size_t token_len);
+
+/**
+ * Collect finished operations without blocking.
+ *
+ * @param ctx  Context handle
+ * @param out  Array receiving completions
+ * @param max  Capacity of out
+ * @return Number of completions written
+ */
+size_t zault_async_poll(ZaultAsync* ctx, ZaultCompletion* out, size_t max);
+
+/**
+ * Collect finished operations, blocking until at least one is ready.
+ *
+ * Returns early with 0 if nothing is outstanding or the timeout passes.
+ *
+ * @param ctx         Context handle
+ * @param out         Array receiving completions
+ * @param max         Capacity of out
+ * @param timeout_ms  Milliseconds to wait (negative = no limit)
+ * @return Number of completions written
+ */
+size_t zault_async_wait(ZaultAsync* ctx, ZaultCompletion* out, size_t max, int64_t timeout_ms);
+
 /* ============================================================================
  * Cryptographic Utilities
  * ============================================================================ */
@@ -641,6 +996,61 @@ int zault_chacha20_decrypt(
     size_t* plaintext_len_out
 );
 
+/* ============================================================================
+ * Metrics
+ * ============================================================================ */
+
+/* Stage indexes into ZaultMetrics.stages */
+#define ZAULT_METRIC_SIGN         0  /* ML-DSA-65 signing */
+#define ZAULT_METRIC_VERIFY       1  /* ML-DSA-65 verification */
+#define ZAULT_METRIC_ENCAPS       2  /* ML-KEM-768 encapsulation */
+#define ZAULT_METRIC_DECAPS       3  /* ML-KEM-768 decapsulation */
+#define ZAULT_METRIC_AEAD_SEAL    4  /* ChaCha20-Poly1305 encryption */
+#define ZAULT_METRIC_AEAD_OPEN    5  /* ChaCha20-Poly1305 decryption */
+#define ZAULT_METRIC_SHA3         6  /* SHA3-256 block hashes */
+#define ZAULT_METRIC_STORE_READ   7  /* Block store reads */
+#define ZAULT_METRIC_STORE_WRITE  8  /* Block store writes */
+#define ZAULT_METRIC_FSYNC        9  /* fsync of blocks, indexes, directories */
+#define ZAULT_METRIC_COUNT        10
+#define ZAULT_METRIC_BUCKETS      32
+
+/**
+ * Totals for one stage.
+ *
+ * buckets[i] counts calls that took between 2^i and 2^(i+1) nanoseconds;
+ * the last bucket also holds every slower call. Summing buckets 0..i gives
+ * a cumulative count for a "le 2^(i+1) ns" histogram bucket.
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t bytes;
+    uint64_t buckets[ZAULT_METRIC_BUCKETS];
+} ZaultMetricStage;
+
+typedef struct {
+    uint32_t enabled;      /* 0 if built without -Dmetrics=true */
+    uint32_t stage_count;  /* ZAULT_METRIC_COUNT */
+    ZaultMetricStage stages[ZAULT_METRIC_COUNT];
+} ZaultMetrics;
+
+/**
+ * Copy the process-wide counters and latency histograms.
+ *
+ * Metrics are compiled in only when libzault is built with
+ * `zig build -Dmetrics=true`; otherwise `enabled` is 0 and every counter
+ * stays zero. Safe to call from any thread while operations run.
+ *
+ * @param out  Receives the snapshot
+ * @return ZAULT_OK on success, ZAULT_ERR_INVALID_ARG if out is NULL
+ */
+int zault_metrics_snapshot(ZaultMetrics* out);
+
+/**
+ * Zero every counter.
+ */
+void zault_metrics_reset(void);
+
 /* ============================================================================
  * Error Handling
  * ============================================================================ */
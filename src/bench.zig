@@ -0,0 +1,707 @@
+//! Zault benchmarks (`zig build bench`)
+//!
+//! Micro benchmarks time the primitives every block goes through: ML-DSA-65
+//! sign and verify, ML-KEM-768 encaps and decaps, ChaCha20-Poly1305 and
+//! SHA3-256 at several message sizes, and block serialize, deserialize and
+//! parse. Macro benchmarks time whole vault operations (add, get, list,
+//! export, import) on files of each requested size.
+//!
+//! Results are written as one JSON document, to stdout or `--out`, so runs
+//! can be stored and compared for regressions. Progress goes to stderr.
+//!
+//! ## Usage
+//!
+//! ```
+//! zig build bench                                  # 1K, 1M and 64M files
+//! zig build bench -- --sizes 1K,1M,1G,10G --out bench.json
+//! zig build bench -- --filter mldsa --time-ms 2000
+//! ```
+//!
+//! Each case runs until it has taken `--time-ms` and at least one
+//! iteration (micro cases: at least ten). Large macro sizes therefore run
+//! once. Each phase's files are deleted once later phases no longer need
+//! them, so the scratch directory needs room for about three copies of
+//! the largest file: the vault, the export and the imported vault, at
+//! the end. Phases a `--filter` leaves out run once, untimed, when a
+//! selected phase needs their output.
+//!
+//! `getFile` is timed three ways: verifying every signature with the block
+//! cache off (`verify-always`), with the verified-block memo
+//! (`verify-memo`), and with the memo and a block cache large enough for
+//! the file (`cached`). The gap between them is what the memo and the
+//! cache save per read.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const zault = @import("zault");
+
+const crypto = zault.crypto;
+const Block = zault.Block;
+const BlockView = zault.BlockView;
+const BlockHash = zault.BlockHash;
+const Vault = zault.Vault;
+
+const default_sizes = [_]u64{ 1024, 1024 * 1024, 64 * 1024 * 1024 };
+const message_sizes = [_]usize{ 64, 1024, 64 * 1024, 1024 * 1024 };
+
+const Config = struct {
+    /// Minimum wall time per case
+    time_ns: u64 = 500 * std.time.ns_per_ms,
+    /// Only run cases whose name contains this
+    filter: ?[]const u8 = null,
+    /// File sizes for the macro benchmarks
+    sizes: []const u64 = &default_sizes,
+    /// Files in the vault for `listFiles/<N>-files`
+    list_files: usize = 256,
+    /// Scratch directory, deleted afterwards
+    dir: []const u8 = "zig-cache/bench",
+    /// JSON output path; null writes to stdout
+    out: ?[]const u8 = null,
+};
+
+const Result = struct {
+    name: []const u8,
+    group: []const u8,
+    /// Bytes processed per iteration; 0 when throughput is meaningless
+    bytes: u64,
+    iterations: u64,
+    total_ns: u64,
+    min_ns: u64,
+};
+
+/// Accumulates timed iterations of one case
+const Sampler = struct {
+    timer: std.time.Timer,
+    min_iterations: u64,
+    time_ns: u64,
+    iterations: u64 = 0,
+    total_ns: u64 = 0,
+    min_ns: u64 = std.math.maxInt(u64),
+
+    fn init(config: *const Config, min_iterations: u64) !Sampler {
+        return .{
+            .timer = try std.time.Timer.start(),
+            .min_iterations = min_iterations,
+            .time_ns = config.time_ns,
+        };
+    }
+
+    fn start(self: *Sampler) void {
+        self.timer.reset();
+    }
+
+    fn stop(self: *Sampler) void {
+        const elapsed = self.timer.read();
+        self.iterations += 1;
+        self.total_ns += elapsed;
+        self.min_ns = @min(self.min_ns, elapsed);
+    }
+
+    fn done(self: *const Sampler) bool {
+        return self.iterations >= self.min_iterations and self.total_ns >= self.time_ns;
+    }
+};
+
+const Bench = struct {
+    allocator: std.mem.Allocator,
+    config: Config,
+    results: std.ArrayList(Result) = .{},
+
+    fn deinit(self: *Bench) void {
+        for (self.results.items) |result| self.allocator.free(result.name);
+        self.results.deinit(self.allocator);
+    }
+
+    fn selected(self: *const Bench, name: []const u8) bool {
+        const filter = self.config.filter orelse return true;
+        return std.mem.indexOf(u8, name, filter) != null;
+    }
+
+    /// `selected` for the macro case `label` at `size`
+    fn selectedSized(self: *const Bench, label: []const u8, size: u64) !bool {
+        var buf: [64]u8 = undefined;
+        return self.selected(try sizedName(&buf, label, size));
+    }
+
+    fn record(self: *Bench, group: []const u8, name: []const u8, bytes: u64, sampler: *const Sampler) !void {
+        const owned = try self.allocator.dupe(u8, name);
+        errdefer self.allocator.free(owned);
+
+        try self.results.append(self.allocator, .{
+            .name = owned,
+            .group = group,
+            .bytes = bytes,
+            .iterations = sampler.iterations,
+            .total_ns = sampler.total_ns,
+            .min_ns = sampler.min_ns,
+        });
+
+        const mean = sampler.total_ns / sampler.iterations;
+        std.debug.print("{s:<36} {d:>12} ns/op", .{ name, mean });
+        if (bytes > 0) std.debug.print("  {d:>10.1} MB/s", .{throughput(bytes, mean)});
+        std.debug.print("\n", .{});
+    }
+
+    /// Time `case.run()` until the sampler is satisfied
+    fn micro(self: *Bench, name: []const u8, bytes: u64, case: anytype) !void {
+        if (!self.selected(name)) return;
+
+        try case.run(); // Warm up caches and lazy state
+
+        var sampler = try Sampler.init(&self.config, 10);
+        while (!sampler.done()) {
+            sampler.start();
+            try case.run();
+            sampler.stop();
+        }
+        try self.record("micro", name, bytes, &sampler);
+    }
+};
+
+fn throughput(bytes: u64, ns: u64) f64 {
+    if (ns == 0) return 0;
+    return @as(f64, @floatFromInt(bytes)) * 1000.0 / @as(f64, @floatFromInt(ns));
+}
+
+// ============================================================================
+// Micro benchmarks
+// ============================================================================
+
+fn runMicro(bench: *Bench) !void {
+    const allocator = bench.allocator;
+    var name_buf: [64]u8 = undefined;
+
+    // ML-DSA-65 over a signed 1 KiB block, as on the add path
+    const identity = try zault.Identity.fromSeed([_]u8{0x5A} ** 32);
+    const signing_key = try identity.signingKey();
+    const public_key = try crypto.MLDSA65.PublicKey.fromBytes(identity.public_key);
+
+    var payload: [1024]u8 = undefined;
+    crypto.random.bytes(&payload);
+
+    var block = Block{
+        .version = 0x01,
+        .block_type = .content,
+        .timestamp = 0,
+        .author = identity.public_key,
+        .data = &payload,
+        .nonce = [_]u8{0} ** crypto.ChaCha20Poly1305.nonce_length,
+        .signature = undefined,
+        .prev_hash = [_]u8{0} ** 32,
+        .hash = undefined,
+    };
+    try block.signWith(&signing_key);
+    block.hash = block.computeHash();
+
+    var sign = struct {
+        block: *Block,
+        key: *const crypto.MLDSA65.SecretKey,
+        fn run(self: *@This()) !void {
+            try self.block.signWith(self.key);
+        }
+    }{ .block = &block, .key = &signing_key };
+    try bench.micro("mldsa65/sign", 0, &sign);
+
+    var verify = struct {
+        block: *const Block,
+        key: crypto.MLDSA65.PublicKey,
+        fn run(self: *@This()) !void {
+            try self.block.verifyWith(self.key);
+        }
+    }{ .block = &block, .key = public_key };
+    try bench.micro("mldsa65/verify", 0, &verify);
+
+    // ML-KEM-768, as on the share path
+    const kem_pair = try crypto.MLKem768.KeyPair.generateDeterministic([_]u8{0x4B} ** 64);
+    const encapsulated = kem_pair.public_key.encaps(null);
+
+    var encaps = struct {
+        key: *const crypto.MLKem768.PublicKey,
+        fn run(self: *@This()) !void {
+            std.mem.doNotOptimizeAway(self.key.encaps(null));
+        }
+    }{ .key = &kem_pair.public_key };
+    try bench.micro("mlkem768/encaps", 0, &encaps);
+
+    var decaps = struct {
+        key: *const crypto.MLKem768.SecretKey,
+        ciphertext: *const [crypto.MLKem768.ciphertext_length]u8,
+        fn run(self: *@This()) !void {
+            std.mem.doNotOptimizeAway(try self.key.decaps(self.ciphertext));
+        }
+    }{ .key = &kem_pair.secret_key, .ciphertext = &encapsulated.ciphertext };
+    try bench.micro("mlkem768/decaps", 0, &decaps);
+
+    // Symmetric primitives at several message sizes
+    const input = try allocator.alloc(u8, message_sizes[message_sizes.len - 1]);
+    defer allocator.free(input);
+    crypto.random.bytes(input);
+
+    const sealed = try allocator.alloc(u8, input.len + crypto.ChaCha20Poly1305.tag_length);
+    defer allocator.free(sealed);
+
+    for (message_sizes) |size| {
+        var encrypt = struct {
+            out: []u8,
+            in: []const u8,
+            fn run(self: *@This()) !void {
+                zault.block.encryptDataInto(self.out, self.in, [_]u8{1} ** 32, [_]u8{2} ** 12);
+            }
+        }{ .out = sealed[0 .. size + crypto.ChaCha20Poly1305.tag_length], .in = input[0..size] };
+        try bench.micro(try sizedName(&name_buf, "chacha20poly1305/encrypt", size), size, &encrypt);
+
+        var decrypt = struct {
+            out: []u8,
+            in: []const u8,
+            fn run(self: *@This()) !void {
+                try zault.block.decryptDataInto(self.out, self.in, [_]u8{1} ** 32, [_]u8{2} ** 12);
+            }
+        }{ .out = input[0..size], .in = sealed[0 .. size + crypto.ChaCha20Poly1305.tag_length] };
+        try encrypt.run(); // `decrypt` needs a valid tag in `sealed`
+        try bench.micro(try sizedName(&name_buf, "chacha20poly1305/decrypt", size), size, &decrypt);
+
+        var hash = struct {
+            in: []const u8,
+            fn run(self: *@This()) !void {
+                var digest: [32]u8 = undefined;
+                crypto.Sha3_256.hash(self.in, &digest, .{});
+                std.mem.doNotOptimizeAway(digest);
+            }
+        }{ .in = input[0..size] };
+        try bench.micro(try sizedName(&name_buf, "sha3-256", size), size, &hash);
+    }
+
+    // Block encoding at a small payload and a full default chunk
+    for ([_]usize{ 1024, zault.manifest.default_chunk_size }) |size| {
+        var sized = block;
+        sized.data = input[0..size];
+        const bytes = try sized.serialize(allocator);
+        defer allocator.free(bytes);
+        const length = bytes.len;
+
+        var serialize = struct {
+            allocator: std.mem.Allocator,
+            block: *const Block,
+            fn run(self: *@This()) !void {
+                const out = try self.block.serialize(self.allocator);
+                self.allocator.free(out);
+            }
+        }{ .allocator = allocator, .block = &sized };
+        try bench.micro(try sizedName(&name_buf, "block/serialize", size), length, &serialize);
+
+        var deserialize = struct {
+            allocator: std.mem.Allocator,
+            bytes: []const u8,
+            fn run(self: *@This()) !void {
+                const out = try Block.deserialize(self.bytes, self.allocator);
+                self.allocator.free(out.data);
+            }
+        }{ .allocator = allocator, .bytes = bytes };
+        try bench.micro(try sizedName(&name_buf, "block/deserialize", size), length, &deserialize);
+
+        var parse = struct {
+            bytes: []const u8,
+            fn run(self: *@This()) !void {
+                std.mem.doNotOptimizeAway(try BlockView.parse(self.bytes));
+            }
+        }{ .bytes = bytes };
+        try bench.micro(try sizedName(&name_buf, "block/parse", size), length, &parse);
+    }
+}
+
+// ============================================================================
+// Macro benchmarks
+// ============================================================================
+
+fn runMacro(bench: *Bench) !void {
+    const allocator = bench.allocator;
+    const dir = bench.config.dir;
+
+    std.fs.cwd().deleteTree(dir) catch {};
+    try std.fs.cwd().makePath(dir);
+    defer std.fs.cwd().deleteTree(dir) catch {};
+
+    for (bench.config.sizes) |size| try runMacroSize(bench, size);
+
+    // Listing a vault with many small files
+    var name_buf: [64]u8 = undefined;
+    const list_name = try std.fmt.bufPrint(&name_buf, "listFiles/{d}-files", .{bench.config.list_files});
+    if (!bench.selected(list_name)) return;
+
+    const vault_path = try std.fmt.allocPrint(allocator, "{s}/vault-list", .{dir});
+    defer allocator.free(vault_path);
+    const input_path = try std.fmt.allocPrint(allocator, "{s}/small.bin", .{dir});
+    defer allocator.free(input_path);
+
+    try writeRandomFile(input_path, 64);
+
+    var vault = try Vault.init(allocator, vault_path);
+    defer vault.deinit();
+    for (0..bench.config.list_files) |_| _ = try vault.addFile(input_path);
+
+    try timeListFiles(bench, &vault, list_name);
+}
+
+fn runMacroSize(bench: *Bench, size: u64) !void {
+    const allocator = bench.allocator;
+    const dir = bench.config.dir;
+    var name_buf: [64]u8 = undefined;
+
+    // Phases that are filtered out still run once, untimed, when a later
+    // phase needs what they leave behind
+    const wants_import = try bench.selectedSized("importBlocks", size);
+    const wants_export = wants_import or try bench.selectedSized("exportBlocks", size);
+    const wants_get = try bench.selectedSized("getFile/verify-always", size) or
+        try bench.selectedSized("getFile/verify-memo", size) or
+        try bench.selectedSized("getFile/cached", size);
+    const wants_file = wants_export or wants_get or
+        try bench.selectedSized("listFiles", size) or
+        try bench.selectedSized("addFile", size);
+    const wants_batch = try bench.selectedSized("addFile/batch-signed", size);
+    if (!wants_file and !wants_batch) return;
+
+    const input_path = try std.fmt.allocPrint(allocator, "{s}/input.bin", .{dir});
+    defer allocator.free(input_path);
+    const output_path = try std.fmt.allocPrint(allocator, "{s}/output.bin", .{dir});
+    defer allocator.free(output_path);
+    const export_path = try std.fmt.allocPrint(allocator, "{s}/export.zault", .{dir});
+    defer allocator.free(export_path);
+    const vault_path = try std.fmt.allocPrint(allocator, "{s}/vault", .{dir});
+    defer allocator.free(vault_path);
+    const batch_path = try std.fmt.allocPrint(allocator, "{s}/vault-batch", .{dir});
+    defer allocator.free(batch_path);
+    const import_path = try std.fmt.allocPrint(allocator, "{s}/vault-import", .{dir});
+    defer allocator.free(import_path);
+
+    defer {
+        std.fs.cwd().deleteFile(input_path) catch {};
+        std.fs.cwd().deleteFile(output_path) catch {};
+        std.fs.cwd().deleteFile(export_path) catch {};
+        std.fs.cwd().deleteTree(vault_path) catch {};
+    }
+
+    std.debug.print("-- {d} byte files\n", .{size});
+    try writeRandomFile(input_path, size);
+
+    // addFile with one signature per batch of chunks, in its own vault so
+    // its copy of the file is gone before the phases below
+    if (wants_batch) {
+        defer std.fs.cwd().deleteTree(batch_path) catch {};
+        var batch_vault = try Vault.init(allocator, batch_path);
+        defer batch_vault.deinit();
+        batch_vault.signature_batch = zault.batch.default_leaves;
+
+        var sampler = try Sampler.init(&bench.config, 1);
+        while (!sampler.done()) {
+            sampler.start();
+            _ = try batch_vault.addFile(input_path);
+            sampler.stop();
+        }
+        try bench.record("macro", try sizedName(&name_buf, "addFile/batch-signed", size), size, &sampler);
+    }
+    if (!wants_file) return;
+
+    var vault = try Vault.init(allocator, vault_path);
+    defer vault.deinit();
+
+    // addFile; every add stores new blocks (fresh content key per file)
+    var hash: BlockHash = undefined;
+    {
+        const name = try sizedName(&name_buf, "addFile", size);
+        if (bench.selected(name)) {
+            var sampler = try Sampler.init(&bench.config, 1);
+            while (!sampler.done()) {
+                sampler.start();
+                hash = try vault.addFile(input_path);
+                sampler.stop();
+            }
+            try bench.record("macro", name, size, &sampler);
+        } else {
+            hash = try vault.addFile(input_path);
+        }
+    }
+    std.fs.cwd().deleteFile(input_path) catch {};
+
+    // getFile: full verification, verified-block memo, memo and cache
+    const saved_limits = vault.cache.limits;
+    const variants = [_]struct { suffix: []const u8, mode: Vault.VerifyMode, cached: bool }{
+        .{ .suffix = "verify-always", .mode = .always, .cached = false },
+        .{ .suffix = "verify-memo", .mode = .memo, .cached = false },
+        .{ .suffix = "cached", .mode = .memo, .cached = true },
+    };
+    for (variants) |variant| {
+        var label_buf: [48]u8 = undefined;
+        const label = try std.fmt.bufPrint(&label_buf, "getFile/{s}", .{variant.suffix});
+        const name = try sizedName(&name_buf, label, size);
+        if (!bench.selected(name)) continue;
+
+        vault.verify_mode = variant.mode;
+        vault.setCacheLimits(if (variant.cached) .{
+            .metadata_bytes = saved_limits.metadata_bytes,
+            // Room for the whole file plus block overhead, within reason
+            .content_bytes = @intCast(@min(size * 2 + 64 * 1024 * 1024, 4 * 1024 * 1024 * 1024)),
+        } else .{ .metadata_bytes = 0, .content_bytes = 0 });
+        try vault.getFile(hash, output_path); // Populate the memo and the cache
+
+        var sampler = try Sampler.init(&bench.config, 1);
+        while (!sampler.done()) {
+            sampler.start();
+            try vault.getFile(hash, output_path);
+            sampler.stop();
+        }
+        try bench.record("macro", name, size, &sampler);
+    }
+    vault.verify_mode = .memo;
+    vault.setCacheLimits(saved_limits);
+    std.fs.cwd().deleteFile(output_path) catch {};
+
+    try timeListFiles(bench, &vault, try sizedName(&name_buf, "listFiles", size));
+
+    // exportBlocks: the file and every block it depends on
+    if (wants_export) {
+        const name = try sizedName(&name_buf, "exportBlocks", size);
+        if (bench.selected(name)) {
+            var sampler = try Sampler.init(&bench.config, 1);
+            while (!sampler.done()) {
+                sampler.start();
+                try vault.exportBlocks(&[_]BlockHash{hash}, export_path, allocator);
+                sampler.stop();
+            }
+            try bench.record("macro", name, size, &sampler);
+        } else {
+            try vault.exportBlocks(&[_]BlockHash{hash}, export_path, allocator);
+        }
+    }
+
+    // importBlocks into an empty vault each time; opening it is not timed
+    if (wants_import) {
+        const name = try sizedName(&name_buf, "importBlocks", size);
+        var sampler = try Sampler.init(&bench.config, 1);
+        while (!sampler.done()) {
+            std.fs.cwd().deleteTree(import_path) catch {};
+            var target = try Vault.init(allocator, import_path);
+            defer target.deinit();
+
+            sampler.start();
+            var imported = try target.importBlocks(export_path, allocator);
+            sampler.stop();
+            imported.deinit(allocator);
+        }
+        try bench.record("macro", name, size, &sampler);
+        std.fs.cwd().deleteTree(import_path) catch {};
+    }
+}
+
+fn timeListFiles(bench: *Bench, vault: *Vault, name: []const u8) !void {
+    if (!bench.selected(name)) return;
+
+    var sampler = try Sampler.init(&bench.config, 10);
+    while (!sampler.done()) {
+        sampler.start();
+        var files = try vault.listFiles();
+        sampler.stop();
+
+        for (files.items) |file| {
+            bench.allocator.free(file.filename);
+            bench.allocator.free(file.mime_type);
+        }
+        files.deinit(bench.allocator);
+    }
+    try bench.record("macro", name, 0, &sampler);
+}
+
+/// Write `size` random bytes, one MiB at a time
+fn writeRandomFile(path: []const u8, size: u64) !void {
+    const file = try std.fs.cwd().createFile(path, .{});
+    defer file.close();
+
+    var buffer: [1024 * 1024]u8 = undefined;
+    var remaining = size;
+    while (remaining > 0) {
+        const n: usize = @intCast(@min(remaining, buffer.len));
+        crypto.random.bytes(buffer[0..n]);
+        try file.writeAll(buffer[0..n]);
+        remaining -= n;
+    }
+}
+
+// ============================================================================
+// Names, arguments and output
+// ============================================================================
+
+/// "name/1KiB", "name/64MiB", "name/1000B"
+fn sizedName(buf: []u8, name: []const u8, size: u64) ![]const u8 {
+    const units = [_][]const u8{ "B", "KiB", "MiB", "GiB", "TiB" };
+    var value = size;
+    var unit: usize = 0;
+    while (unit + 1 < units.len and value >= 1024 and value % 1024 == 0) : (unit += 1) value /= 1024;
+    return std.fmt.bufPrint(buf, "{s}/{d}{s}", .{ name, value, units[unit] });
+}
+
+/// "4096", "1K", "64M", "10G" (binary multiples)
+fn parseSize(text: []const u8) !u64 {
+    if (text.len == 0) return error.InvalidSize;
+    const shift: u6 = switch (std.ascii.toUpper(text[text.len - 1])) {
+        'K' => 10,
+        'M' => 20,
+        'G' => 30,
+        'T' => 40,
+        else => 0,
+    };
+    const digits = if (shift == 0) text else text[0 .. text.len - 1];
+    const value = std.fmt.parseInt(u64, digits, 10) catch return error.InvalidSize;
+    return std.math.shlExact(u64, value, shift) catch error.InvalidSize;
+}
+
+fn parseSizes(allocator: std.mem.Allocator, list: []const u8) ![]u64 {
+    var sizes = std.ArrayList(u64){};
+    errdefer sizes.deinit(allocator);
+
+    var it = std.mem.tokenizeScalar(u8, list, ',');
+    while (it.next()) |item| try sizes.append(allocator, try parseSize(item));
+    return sizes.toOwnedSlice(allocator);
+}
+
+const usage =
+    \\Usage: zig build bench -- [options]
+    \\
+    \\  --sizes LIST     Macro file sizes, e.g. 1K,1M,1G,10G (default 1K,1M,64M)
+    \\  --files N        Files in the listFiles vault (default 256)
+    \\  --time-ms N      Minimum time per case (default 500)
+    \\  --filter TEXT    Only run cases whose name contains TEXT
+    \\  --dir PATH       Scratch directory (default zig-cache/bench)
+    \\  --out PATH       Write JSON here instead of stdout
+    \\  --micro          Micro benchmarks only
+    \\  --macro          Macro benchmarks only
+    \\
+;
+
+fn writeJson(bench: *const Bench, out: *std.ArrayList(u8)) !void {
+    const allocator = bench.allocator;
+
+    try out.print(allocator,
+        \\{{"zig":"{s}","mode":"{s}","arch":"{s}","os":"{s}","cpus":{d},"timestamp":{d},"results":[
+    , .{
+        builtin.zig_version_string,
+        @tagName(builtin.mode),
+        @tagName(builtin.cpu.arch),
+        @tagName(builtin.os.tag),
+        std.Thread.getCpuCount() catch 1,
+        std.time.timestamp(),
+    });
+
+    // Names are ASCII built above; nothing needs escaping
+    for (bench.results.items, 0..) |result, i| {
+        const mean = result.total_ns / result.iterations;
+        if (i > 0) try out.append(allocator, ',');
+        try out.print(allocator,
+            \\
+            \\{{"name":"{s}","group":"{s}","bytes":{d},"iterations":{d},"ns_per_op":{d},"min_ns":{d},"ops_per_s":{d:.1},"mb_per_s":{d:.1}}}
+        , .{
+            result.name,
+            result.group,
+            result.bytes,
+            result.iterations,
+            mean,
+            result.min_ns,
+            if (mean > 0) 1e9 / @as(f64, @floatFromInt(mean)) else 0,
+            throughput(result.bytes, mean),
+        });
+    }
+    try out.appendSlice(allocator, "\n]}\n");
+}
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    var config = Config{};
+    var owned_sizes: ?[]u64 = null;
+    defer if (owned_sizes) |sizes| allocator.free(sizes);
+    var run_micro = true;
+    var run_macro = true;
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+        if (std.mem.eql(u8, arg, "--micro")) {
+            run_macro = false;
+            continue;
+        }
+        if (std.mem.eql(u8, arg, "--macro")) {
+            run_micro = false;
+            continue;
+        }
+        if (std.mem.eql(u8, arg, "-h") or std.mem.eql(u8, arg, "--help")) {
+            std.debug.print(usage, .{});
+            return;
+        }
+
+        if (i + 1 >= args.len) {
+            std.debug.print("Error: {s} needs a value\n\n" ++ usage, .{arg});
+            return error.InvalidArgument;
+        }
+        i += 1;
+        const value = args[i];
+
+        if (std.mem.eql(u8, arg, "--sizes")) {
+            if (owned_sizes) |sizes| allocator.free(sizes);
+            owned_sizes = try parseSizes(allocator, value);
+            config.sizes = owned_sizes.?;
+        } else if (std.mem.eql(u8, arg, "--files")) {
+            config.list_files = try std.fmt.parseInt(usize, value, 10);
+        } else if (std.mem.eql(u8, arg, "--time-ms")) {
+            config.time_ns = try std.fmt.parseInt(u64, value, 10) * std.time.ns_per_ms;
+        } else if (std.mem.eql(u8, arg, "--filter")) {
+            config.filter = value;
+        } else if (std.mem.eql(u8, arg, "--dir")) {
+            config.dir = value;
+        } else if (std.mem.eql(u8, arg, "--out")) {
+            config.out = value;
+        } else {
+            std.debug.print("Error: unknown option {s}\n\n" ++ usage, .{arg});
+            return error.InvalidArgument;
+        }
+    }
+
+    if (builtin.mode == .Debug) {
+        std.debug.print("Warning: Debug build; numbers are not representative\n", .{});
+    }
+
+    var bench = Bench{ .allocator = allocator, .config = config };
+    defer bench.deinit();
+
+    if (run_micro) try runMicro(&bench);
+    if (run_macro) try runMacro(&bench);
+
+    var json = std.ArrayList(u8){};
+    defer json.deinit(allocator);
+    try writeJson(&bench, &json);
+
+    if (config.out) |path| {
+        const file = try std.fs.cwd().createFile(path, .{});
+        defer file.close();
+        try file.writeAll(json.items);
+        std.debug.print("Results written to {s}\n", .{path});
+    } else {
+        try std.fs.File.stdout().writeAll(json.items);
+    }
+}
+
+test "bench sizes parse and print" {
+    var buf: [64]u8 = undefined;
+
+    try std.testing.expectEqual(@as(u64, 4096), try parseSize("4096"));
+    try std.testing.expectEqual(@as(u64, 1024), try parseSize("1K"));
+    try std.testing.expectEqual(@as(u64, 10) << 30, try parseSize("10g"));
+    try std.testing.expectError(error.InvalidSize, parseSize("M"));
+    try std.testing.expectError(error.InvalidSize, parseSize("99999999999999T"));
+
+    try std.testing.expectEqualStrings("addFile/1KiB", try sizedName(&buf, "addFile", 1024));
+    try std.testing.expectEqualStrings("addFile/10GiB", try sizedName(&buf, "addFile", 10 << 30));
+    try std.testing.expectEqualStrings("sha3-256/64B", try sizedName(&buf, "sha3-256", 64));
+}
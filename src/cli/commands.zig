@@ -2,8 +2,11 @@
 
 const std = @import("std");
 const clap = @import("clap");
-const Vault = @import("../core/vault.zig").Vault;
-const BlockHash = @import("../core/store.zig").BlockHash;
+const zault = @import("zault");
+const Vault = zault.Vault;
+const BlockHash = zault.BlockHash;
+const packstore = zault.packstore;
+const batch = zault.batch;
 
 const version = "0.2.0";
 
@@ -18,6 +21,7 @@ const SubCommand = enum {
     receive,
     import,
     pubkey,
+    migrate,
     help,
     version,
 };
@@ -89,6 +93,7 @@ pub fn run(allocator: std.mem.Allocator) !void {
         .receive => try cmdReceive(allocator, &iter, vault_path),
         .import => try cmdImport(allocator, &iter, vault_path),
         .pubkey => try cmdPubkey(allocator, &iter, vault_path),
+        .migrate => try cmdMigrate(allocator, &iter, vault_path),
         .help => try printMainHelp(),
         .version => try printVersion(),
     }
@@ -111,9 +116,10 @@ fn printMainHelp() !void {
         \\    add <FILE>          Add file to vault (encrypted)
         \\    get <HASH> [OUT]    Retrieve file by hash (decrypted)
         \\    list                 List all files in vault
-        \\    verify <HASH>        Verify block signature
+        \\    verify <HASH>        Verify block signature (--all for every block)
         \\    share <HASH>         Create share token for file (ML-KEM-768)
         \\    receive <TOKEN>      Redeem share token
+        \\    migrate              Move loose blocks into pack files
         \\    help                 Display this help
         \\    version              Display version information
         \\
@@ -123,6 +129,7 @@ fn printMainHelp() !void {
         \\    zault list                           # Show all files
         \\    zault get 8578287e... output.pdf    # Retrieve and decrypt
         \\    zault verify 8578287e...             # Verify signature
+        \\    zault verify --all -j 8              # Verify every block on 8 threads
         \\
         \\For more information, see: https://github.com/mattneel/zault
         \\
@@ -204,12 +211,19 @@ fn cmdInit(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_p
 
 const add_params = clap.parseParamsComptime(
     \\-h, --help    Display help for add command.
+    \\-j, --jobs <NUM>  Threads used to encrypt and sign chunks (0 = all CPUs, default: 0).
+    \\    --dedup      Content-defined chunks, stored once across files.
+    \\    --compact    Name the author by key fingerprint instead of embedding the key in every block.
+    \\-b, --batch <NUM>  Chunks signed together under one Merkle root (0 = sign each chunk, max 256, default: 0).
+    \\-u, --update <HASH>  Store as a new version of this file, re-encrypting only changed chunks.
     \\<FILE>
     \\
 );
 
 const add_parsers = .{
     .FILE = clap.parsers.string,
+    .HASH = clap.parsers.string,
+    .NUM = clap.parsers.int(usize, 10),
 };
 
 fn cmdAdd(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_path: []const u8) !void {
@@ -227,8 +241,13 @@ fn cmdAdd(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_pa
     if (res.args.help != 0) {
         std.debug.print("Add a file to the vault (encrypted)\n\n", .{});
         std.debug.print("USAGE:\n", .{});
-        std.debug.print("    zault add <FILE>\n\n", .{});
+        std.debug.print("    zault add [-j <NUM>] [--dedup] [--compact] [-b <NUM>] [-u <HASH>] <FILE>\n\n", .{});
         std.debug.print("Encrypts the file with ChaCha20-Poly1305 and stores it in the vault.\n", .{});
+        std.debug.print("Chunks are encrypted and signed in parallel (--jobs, default: all CPUs).\n", .{});
+        std.debug.print("With --dedup, chunks already in the vault are not stored again.\n", .{});
+        std.debug.print("With --compact, blocks are ~1.9 KB smaller but unreadable by older zault builds.\n", .{});
+        std.debug.print("With --batch, one signature covers up to NUM chunks instead of one each.\n", .{});
+        std.debug.print("With --update, unchanged chunks of the previous version are reused.\n", .{});
         std.debug.print("Returns metadata block hash.\n", .{});
         return;
     }
@@ -241,10 +260,24 @@ fn cmdAdd(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_pa
 
     var vault = try Vault.init(allocator, vault_path);
     defer vault.deinit();
+    vault.ingest_threads = res.args.jobs orelse 0;
+    if (res.args.dedup != 0) vault.dedup = .{};
+    if (res.args.compact != 0) vault.compact_blocks = true;
+    if (res.args.batch) |leaves| {
+        if (leaves > batch.max_leaves) {
+            std.debug.print("Error: --batch is at most {d}\n", .{batch.max_leaves});
+            return error.InvalidBatchSize;
+        }
+        vault.signature_batch = @intCast(leaves);
+    }
 
     std.debug.print("Adding file: {s}\n", .{file_path});
 
-    const hash = try vault.addFile(file_path);
+    const hash = if (res.args.update) |previous_str| blk: {
+        var previous: BlockHash = undefined;
+        _ = try std.fmt.hexToBytes(&previous, previous_str);
+        break :blk try vault.updateFile(previous, file_path);
+    } else try vault.addFile(file_path);
 
     std.debug.print("✓ File added (encrypted)\n", .{});
     const hex = std.fmt.bytesToHex(&hash, .lower);
@@ -258,6 +291,7 @@ fn cmdAdd(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_pa
 const get_params = clap.parseParamsComptime(
     \\-h, --help       Display help for get command.
     \\-o, --output <STR>  Output file path.
+    \\    --io-depth <DEPTH>  Block reads kept in flight (io_uring; 0 = off, default: 0).
     \\<HASH>
     \\
 );
@@ -265,6 +299,7 @@ const get_params = clap.parseParamsComptime(
 const get_parsers = .{
     .HASH = clap.parsers.string,
     .STR = clap.parsers.string,
+    .DEPTH = clap.parsers.int(u16, 10),
 };
 
 fn cmdGet(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_path: []const u8) !void {
@@ -285,6 +320,7 @@ fn cmdGet(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_pa
         std.debug.print("    zault get <HASH> [-o OUTPUT]\n\n", .{});
         std.debug.print("OPTIONS:\n", .{});
         std.debug.print("    -o, --output <PATH>    Output file path (default: output.bin)\n", .{});
+        std.debug.print("        --io-depth <N>     Chunk reads kept in flight via io_uring (Linux, pack vaults)\n", .{});
         return;
     }
 
@@ -302,6 +338,7 @@ fn cmdGet(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_pa
 
     var vault = try Vault.init(allocator, vault_path);
     defer vault.deinit();
+    try setIoDepth(&vault, res.args.@"io-depth");
 
     std.debug.print("Retrieving block: {s}\n", .{hash_str});
 
@@ -440,12 +477,15 @@ fn fuzzCliParser(_: void, raw: []const u8) !void {
 
 const verify_params = clap.parseParamsComptime(
     \\-h, --help    Display help for verify command.
+    \\-a, --all     Verify every block in the vault.
+    \\-j, --jobs <NUM>  Threads used with --all (0 = all CPUs, default: 0).
     \\<HASH>
     \\
 );
 
 const verify_parsers = .{
     .HASH = clap.parsers.string,
+    .NUM = clap.parsers.int(usize, 10),
 };
 
 fn cmdVerify(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_path: []const u8) !void {
@@ -463,8 +503,32 @@ fn cmdVerify(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault
     if (res.args.help != 0) {
         std.debug.print("Verify a block's ML-DSA-65 signature\n\n", .{});
         std.debug.print("USAGE:\n", .{});
-        std.debug.print("    zault verify <HASH>\n\n", .{});
-        std.debug.print("Verifies the cryptographic signature on a block.\n", .{});
+        std.debug.print("    zault verify <HASH>\n", .{});
+        std.debug.print("    zault verify --all [-j NUM]\n\n", .{});
+        std.debug.print("Verifies the cryptographic signature on a block. With --all, checks\n", .{});
+        std.debug.print("the hash and signature of every block, in parallel.\n", .{});
+        return;
+    }
+
+    if (res.args.all != 0) {
+        var vault = try Vault.init(allocator, vault_path);
+        defer vault.deinit();
+
+        std.debug.print("Verifying all blocks...\n", .{});
+
+        var report = try vault.verifyAll(res.args.jobs orelse 0);
+        defer report.deinit(allocator);
+
+        for (report.failures.items) |failure| {
+            const hex = std.fmt.bytesToHex(&failure.hash, .lower);
+            std.debug.print("✗ {s}: {s}\n", .{ hex, @errorName(failure.err) });
+        }
+
+        std.debug.print("✓ {d} blocks valid (ML-DSA-65)\n", .{report.verified});
+        if (!report.ok()) {
+            std.debug.print("✗ {d} blocks failed verification\n", .{report.failures.items.len});
+            return error.VerificationFailed;
+        }
         return;
     }
 
@@ -703,18 +767,59 @@ fn cmdPubkey(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault
     std.debug.print("    zault share <HASH> --to <YOUR_PUBKEY> --expires <TIME>\n", .{});
 }
 
+// ============================================================================
+// Subcommand: migrate
+// ============================================================================
+
+const migrate_params = clap.parseParamsComptime(
+    \\-h, --help    Display help for migrate command.
+    \\
+);
+
+fn cmdMigrate(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_path: []const u8) !void {
+    var diag = clap.Diagnostic{};
+    var res = clap.parseEx(clap.Help, &migrate_params, clap.parsers.default, iter, .{
+        .diagnostic = &diag,
+        .allocator = allocator,
+    }) catch |err| {
+        std.debug.print("Error: {}\n", .{err});
+        return err;
+    };
+    defer res.deinit();
+
+    if (res.args.help != 0) {
+        std.debug.print("Move loose blocks into pack files\n\n", .{});
+        std.debug.print("USAGE:\n", .{});
+        std.debug.print("    zault migrate\n\n", .{});
+        std.debug.print("Copies every blocks/XX/<hash> file into append-only packs, verifying each\n", .{});
+        std.debug.print("block's hash, then removes the loose copies. Safe to re-run if interrupted.\n", .{});
+        return;
+    }
+
+    std.debug.print("Migrating vault: {s}\n", .{vault_path});
+
+    const stats = try packstore.migrate(allocator, vault_path);
+
+    std.debug.print("✓ {d} blocks moved into packs\n", .{stats.migrated});
+    if (stats.skipped > 0) {
+        std.debug.print("⚠️  {d} blocks failed verification and were left in blocks/\n", .{stats.skipped});
+    }
+}
+
 // ============================================================================
 // Subcommand: import
 // ============================================================================
 
 const import_params = clap.parseParamsComptime(
     \\-h, --help    Display help for import command.
+    \\    --io-depth <DEPTH>  Block writes kept in flight (io_uring; 0 = off, default: 0).
     \\<FILE>
     \\
 );
 
 const import_parsers = .{
     .FILE = clap.parsers.string,
+    .DEPTH = clap.parsers.int(u16, 10),
 };
 
 fn cmdImport(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault_path: []const u8) !void {
@@ -731,8 +836,9 @@ fn cmdImport(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault
     if (res.args.help != 0) {
         std.debug.print("Import blocks from a file\n\n", .{});
         std.debug.print("USAGE:\n", .{});
-        std.debug.print("    zault import <FILE>\n\n", .{});
+        std.debug.print("    zault import [--io-depth <N>] <FILE>\n\n", .{});
         std.debug.print("Imports blocks from an exported .zault file.\n", .{});
+        std.debug.print("--io-depth keeps N block writes in flight via io_uring (Linux, pack vaults).\n", .{});
         return;
     }
 
@@ -744,6 +850,7 @@ fn cmdImport(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault
 
     var vault = try Vault.init(allocator, vault_path);
     defer vault.deinit();
+    try setIoDepth(&vault, res.args.@"io-depth");
 
     std.debug.print("Importing blocks from: {s}\n", .{import_path});
 
@@ -758,3 +865,11 @@ fn cmdImport(allocator: std.mem.Allocator, iter: *std.process.ArgIterator, vault
         std.debug.print("  - {s}\n", .{hex[0..16]});
     }
 }
+
+/// Apply an `--io-depth` option, noting when io_uring is unavailable
+fn setIoDepth(vault: *Vault, depth: ?u16) !void {
+    const queue_depth = depth orelse return;
+    if (!try vault.setIoQueueDepth(queue_depth) and queue_depth > 0) {
+        std.debug.print("Note: io_uring unavailable, using synchronous I/O\n", .{});
+    }
+}
@@ -0,0 +1,320 @@
+//! Merkle-batched block signatures
+//!
+//! An ML-DSA-65 signature costs 3309 bytes and about 2 ms per block. In
+//! batch mode, blocks are written as `block.batched_version` and left
+//! unsigned: the hashes of up to `max_leaves` of them become the leaves
+//! of a SHA3-256 Merkle tree, and one ordinary signed **batch root** block
+//! holds the tree root. Each block carries its inclusion proof where the
+//! signature would be, so signing costs one signature per batch.
+//!
+//! Every block stays individually verifiable: hash it, walk its proof up
+//! to a root, and compare that with the signed root block it names. A
+//! block's hash leaves its proof out, so the same content has the same
+//! address whichever batch sealed it and convergent chunks still
+//! deduplicate.
+//!
+//! ## Tree
+//!
+//! ```
+//! leaf = SHA3-256(0x00 || block hash)
+//! node = SHA3-256(0x01 || left || right)
+//! ```
+//!
+//! A level with an odd number of nodes promotes its last node unchanged.
+//! The root block's payload is the tree root followed by the leaf count
+//! (u32). A proof is the root block's hash, the leaf index, the leaf
+//! count and the sibling hashes from leaf to root, skipping promoted
+//! levels; unused sibling slots are zero.
+//!
+//! ## Example
+//!
+//! ```zig
+//! var signer = batch.Signer{};
+//! const root = try signer.sign(&identity.public_key, &signing_key, compact_version, hashes, proofs);
+//! try store.putBytes(root.hash, root.bytes);
+//!
+//! // Later, with the root block read and its signature checked
+//! try batch.verifyInclusion(&view, try batch.Root.parse(&root_view));
+//! ```
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+const block = @import("block.zig");
+const BlockBuilder = block.BlockBuilder;
+const BlockView = block.BlockView;
+const KeyId = block.KeyId;
+
+const Hash = [crypto.Sha3_256.digest_length]u8;
+
+pub const max_depth = block.max_batch_depth;
+pub const max_leaves = block.max_batch_leaves;
+pub const proof_length = block.batch_proof_length;
+
+/// Blocks per batch when batch signing is turned on without a size
+pub const default_leaves = 16;
+
+/// Payload of a batch root block: tree root, then leaf count
+pub const root_data_length = crypto.Sha3_256.digest_length + 4;
+
+fn leafHash(block_hash: *const Hash) Hash {
+    var out: Hash = undefined;
+    var hasher = crypto.Sha3_256.init(.{});
+    hasher.update(&[_]u8{0x00});
+    hasher.update(block_hash);
+    hasher.final(&out);
+    return out;
+}
+
+fn nodeHash(left: *const Hash, right: *const Hash) Hash {
+    var out: Hash = undefined;
+    var hasher = crypto.Sha3_256.init(.{});
+    hasher.update(&[_]u8{0x01});
+    hasher.update(left);
+    hasher.update(right);
+    hasher.final(&out);
+    return out;
+}
+
+/// Inclusion proof of one batch-signed block
+pub const Proof = struct {
+    /// Hash of the signed batch root block
+    root_block: Hash,
+    index: u32,
+    count: u32,
+    /// Siblings from leaf to root; promoted levels take no slot
+    siblings: [max_depth]Hash,
+
+    pub fn encode(self: *const Proof, out: *[proof_length]u8) void {
+        out[0..32].* = self.root_block;
+        std.mem.writeInt(u32, out[32..36], self.index, .little);
+        std.mem.writeInt(u32, out[36..40], self.count, .little);
+        for (&self.siblings, 0..) |*sibling, level| out[40 + level * 32 ..][0..32].* = sibling.*;
+    }
+
+    pub fn decode(bytes: *const [proof_length]u8) !Proof {
+        var proof = Proof{
+            .root_block = bytes[0..32].*,
+            .index = std.mem.readInt(u32, bytes[32..36], .little),
+            .count = std.mem.readInt(u32, bytes[36..40], .little),
+            .siblings = undefined,
+        };
+        if (proof.count == 0 or proof.count > max_leaves or proof.index >= proof.count) {
+            return error.InvalidProof;
+        }
+        for (&proof.siblings, 0..) |*sibling, level| sibling.* = bytes[40 + level * 32 ..][0..32].*;
+        return proof;
+    }
+
+    /// Tree root the proof leads to from a block hashing to `block_hash`
+    pub fn rootFor(self: *const Proof, block_hash: *const Hash) Hash {
+        var node = leafHash(block_hash);
+        var index = self.index;
+        var width = self.count;
+        var used: usize = 0;
+
+        while (width > 1) : ({
+            index /= 2;
+            width = (width + 1) / 2;
+        }) {
+            // The last node of an odd level has no sibling
+            if ((index ^ 1) >= width) continue;
+
+            const sibling = &self.siblings[used];
+            node = if (index & 1 == 0) nodeHash(&node, sibling) else nodeHash(sibling, &node);
+            used += 1;
+        }
+        return node;
+    }
+};
+
+/// What a batch root block commits to
+pub const Root = struct {
+    tree_root: Hash,
+    count: u32,
+    /// Fingerprint of the key that signed the batch
+    author: KeyId,
+
+    /// Read a batch root block. Its signature is not checked here.
+    pub fn parse(view: *const BlockView) !Root {
+        if (view.block_type != .batch or view.data.len != root_data_length) return error.InvalidBlock;
+        return Root{
+            .tree_root = view.data[0..32].*,
+            .count = std.mem.readInt(u32, view.data[32..36], .little),
+            .author = view.author.fingerprint(),
+        };
+    }
+};
+
+/// Hash of the root block a batch-signed block's proof names
+pub fn rootBlockOf(view: *const BlockView) !Hash {
+    const proof = view.proof orelse return error.InvalidBlock;
+    return proof[0..32].*;
+}
+
+/// Check that the batch-signed block `view` is covered by `root`, read
+/// from `rootBlockOf(view)` with its signature already checked
+pub fn verifyInclusion(view: *const BlockView, root: Root) !void {
+    const proof = try Proof.decode(view.proof orelse return error.InvalidBlock);
+
+    // The root's signer must be the author the block names
+    if (proof.count != root.count or !std.mem.eql(u8, &view.author.fingerprint(), &root.author)) {
+        return error.InvalidProof;
+    }
+
+    const computed = view.computeHash();
+    const tree_root = proof.rootFor(&computed);
+    if (!std.mem.eql(u8, &tree_root, &root.tree_root)) return error.InvalidProof;
+}
+
+/// Builds batch trees and signs their roots; reusable across batches
+pub const Signer = struct {
+    /// Every tree level, leaves first
+    nodes: [2 * max_leaves + max_depth]Hash = undefined,
+    /// Root block of the last `sign`, sized for any block version
+    image: [block.serializedLength(root_data_length)]u8 = undefined,
+
+    /// A signed root block, valid until the next `sign`
+    pub const Sealed = struct {
+        hash: Hash,
+        bytes: []const u8,
+    };
+
+    /// Commit to `hashes` (batch-signed blocks, at most `max_leaves`),
+    /// sign the root as a `version` block and write each block's proof
+    /// to the matching entry of `proofs`
+    pub fn sign(
+        self: *Signer,
+        author: *const [crypto.MLDSA65.PublicKey.encoded_length]u8,
+        signing_key: *const crypto.MLDSA65.SecretKey,
+        version: u8,
+        hashes: []const Hash,
+        proofs: []const *[proof_length]u8,
+    ) !Sealed {
+        std.debug.assert(hashes.len > 0 and hashes.len <= max_leaves and proofs.len == hashes.len);
+
+        // Build the tree level by level
+        var starts: [max_depth + 1]usize = undefined;
+        var widths: [max_depth + 1]usize = undefined;
+        var levels: usize = 0;
+        starts[0] = 0;
+        widths[0] = hashes.len;
+        for (hashes, 0..) |*hash, i| self.nodes[i] = leafHash(hash);
+
+        while (widths[levels] > 1) : (levels += 1) {
+            const start = starts[levels];
+            const width = widths[levels];
+            const next = start + width;
+            const next_width = (width + 1) / 2;
+
+            for (0..next_width) |i| {
+                const left = start + 2 * i;
+                self.nodes[next + i] = if (2 * i + 1 < width)
+                    nodeHash(&self.nodes[left], &self.nodes[left + 1])
+                else
+                    self.nodes[left];
+            }
+            starts[levels + 1] = next;
+            widths[levels + 1] = next_width;
+        }
+
+        // Sign the root
+        var data: [root_data_length]u8 = undefined;
+        data[0..32].* = self.nodes[starts[levels]];
+        std.mem.writeInt(u32, data[32..36], @intCast(hashes.len), .little);
+
+        const bytes = self.image[0..block.serializedLengthFor(version, root_data_length)];
+        var builder = BlockBuilder.init(bytes, .{
+            .version = version,
+            .block_type = .batch,
+            .author = author,
+            .nonce = [_]u8{0} ** crypto.ChaCha20Poly1305.nonce_length,
+        });
+        @memcpy(builder.payload(), &data);
+        const root_hash = try builder.seal(signing_key);
+
+        // One proof per leaf
+        for (proofs, 0..) |out, leaf| {
+            var proof = Proof{
+                .root_block = root_hash,
+                .index = @intCast(leaf),
+                .count = @intCast(hashes.len),
+                .siblings = [_]Hash{[_]u8{0} ** 32} ** max_depth,
+            };
+
+            var index = leaf;
+            var used: usize = 0;
+            for (0..levels) |level| {
+                const sibling = index ^ 1;
+                if (sibling < widths[level]) {
+                    proof.siblings[used] = self.nodes[starts[level] + sibling];
+                    used += 1;
+                }
+                index /= 2;
+            }
+            proof.encode(out);
+        }
+
+        return Sealed{ .hash = root_hash, .bytes = bytes };
+    }
+};
+
+test "batch proofs cover every leaf and reject tampering" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+    const image_length = block.serializedLengthFor(block.batched_version, 8);
+
+    const signer = try allocator.create(Signer);
+    defer allocator.destroy(signer);
+    signer.* = .{};
+
+    for ([_]usize{ 1, 2, 5, 16 }) |count| {
+        const images = try allocator.alloc([image_length]u8, count);
+        defer allocator.free(images);
+        var hashes: [16]Hash = undefined;
+        var proofs: [16]*[proof_length]u8 = undefined;
+
+        for (images, 0..) |*image, i| {
+            var builder = BlockBuilder.init(image, .{
+                .version = block.batched_version,
+                .block_type = .content,
+                .author = &identity.public_key,
+                .nonce = [_]u8{@intCast(i)} ** 12,
+            });
+            @memset(builder.payload(), @intCast(i));
+            hashes[i] = builder.digest();
+            proofs[i] = block.batchProof(image);
+        }
+
+        const sealed = try signer.sign(&identity.public_key, &signing_key, block.compact_version, hashes[0..count], proofs[0..count]);
+        const root_view = try BlockView.parse(sealed.bytes);
+        try root_view.verifyWith(try crypto.MLDSA65.PublicKey.fromBytes(identity.public_key));
+        const root = try Root.parse(&root_view);
+
+        for (images, 0..) |*image, i| {
+            const view = try BlockView.parse(image);
+            const computed = view.computeHash();
+            try std.testing.expectEqualSlices(u8, &hashes[i], &computed);
+            const root_block = try rootBlockOf(&view);
+            try std.testing.expectEqualSlices(u8, &sealed.hash, &root_block);
+            try verifyInclusion(&view, root);
+            try std.testing.expectError(error.BatchSigned, view.verify(allocator));
+        }
+
+        // A changed payload no longer hashes to its leaf
+        images[count - 1][block.compact_header_length] ^= 0x01;
+        const changed = try BlockView.parse(&images[count - 1]);
+        try std.testing.expectError(error.InvalidProof, verifyInclusion(&changed, root));
+
+        // Neither does a leaf moved to another index
+        if (count > 1) {
+            const view = try BlockView.parse(&images[0]);
+            var proof = try Proof.decode(view.proof.?);
+            proof.index = 1;
+            proof.encode(block.batchProof(&images[0]));
+            try std.testing.expectError(error.InvalidProof, verifyInclusion(&view, root));
+        }
+    }
+}
@@ -5,12 +5,28 @@
 //!
 //! ## Block Types
 //!
-//! - **content** - Encrypted file data
+//! - **content** - Encrypted file data (one chunk per block)
 //! - **metadata** - Encrypted file metadata (filename, size, keys)
+//! - **manifest** - Encrypted list of a file's chunk blocks
 //! - **index** - Directory indexes (not yet implemented)
 //! - **tombstone** - Deletion markers (not yet implemented)
 //! - **share** - Share tokens (not yet implemented)
 //!
+//! ## Compact blocks
+//!
+//! Version 1 blocks embed the author's 1952-byte ML-DSA-65 public key.
+//! Compact blocks (`compact_version`) carry only its 32-byte SHA3-256
+//! fingerprint (`keyId`), and readers resolve the key through a key
+//! registry (see `keys.zig`). Everything else is laid out the same; the
+//! fingerprint takes the key's place in the signed and hashed fields.
+//!
+//! ## Batch-signed blocks
+//!
+//! Blocks of `batched_version` are laid out like compact blocks but carry
+//! a Merkle inclusion proof (`batch_proof_length` bytes) where the
+//! signature would be. One signed batch root block covers many of them;
+//! see `batch.zig`. Their hash leaves the proof out.
+//!
 //! ## Example
 //!
 //! ```zig
@@ -39,6 +55,7 @@
 
 const std = @import("std");
 const crypto = @import("crypto.zig");
+const metrics = @import("metrics.zig");
 
 /// Block type enumeration
 pub const BlockType = enum(u8) {
@@ -47,6 +64,69 @@ pub const BlockType = enum(u8) {
     index = 0x03, // Directory index
     tombstone = 0x04, // Deletion marker
     share = 0x05, // Share token
+    manifest = 0x06, // Chunk manifest
+    batch = 0x07, // Merkle root of batch-signed blocks
+
+    /// Decode a serialized type byte; null for unknown types
+    pub fn fromInt(value: u8) ?BlockType {
+        inline for (@typeInfo(BlockType).@"enum".fields) |field| {
+            if (field.value == value) return @enumFromInt(value);
+        }
+        return null;
+    }
+};
+
+/// Block version that names the author by key fingerprint
+pub const compact_version: u8 = 0x02;
+
+/// Block version covered by a batch signature instead of its own
+pub const batched_version: u8 = 0x03;
+
+/// Leaves of the largest batch tree, and its depth
+pub const max_batch_depth = 8;
+pub const max_batch_leaves = 1 << max_batch_depth;
+
+/// Inclusion proof in place of a signature: root block hash, leaf index,
+/// leaf count and one sibling hash per tree level
+pub const batch_proof_length = crypto.Sha3_256.digest_length + 4 + 4 +
+    max_batch_depth * crypto.Sha3_256.digest_length;
+
+/// Whether blocks of `version` name their author by key fingerprint
+pub fn hasKeyId(version: u8) bool {
+    return version == compact_version or version == batched_version;
+}
+
+/// Fingerprint of an author key, as stored in compact blocks
+pub const KeyId = [crypto.Sha3_256.digest_length]u8;
+
+/// SHA3-256 fingerprint of an encoded ML-DSA-65 public key
+pub fn keyId(key: *const [crypto.MLDSA65.PublicKey.encoded_length]u8) KeyId {
+    var id: KeyId = undefined;
+    crypto.Sha3_256.hash(key, &id, .{});
+    return id;
+}
+
+/// A block's author, as serialized: the whole key (version 1) or its
+/// fingerprint (compact blocks)
+pub const Author = union(enum) {
+    key: *const [crypto.MLDSA65.PublicKey.encoded_length]u8,
+    id: *const KeyId,
+
+    /// Fingerprint of the author key, whichever form the block carries
+    pub fn fingerprint(self: Author) KeyId {
+        return switch (self) {
+            .key => |key| keyId(key),
+            .id => |id| id.*,
+        };
+    }
+
+    /// The serialized author field
+    fn bytes(self: Author) []const u8 {
+        return switch (self) {
+            .key => |key| key,
+            .id => |id| id,
+        };
+    }
 };
 
 /// A Zault block
@@ -57,14 +137,18 @@ pub const Block = struct {
     block_type: BlockType,
     /// Creation timestamp
     timestamp: i64,
-    /// Author's public key
+    /// Author's public key; unused (zero) in compact blocks
     author: [crypto.MLDSA65.PublicKey.encoded_length]u8,
+    /// Fingerprint of the author key; set for compact blocks only
+    author_id: ?KeyId = null,
     /// Encrypted data payload
     data: []const u8,
     /// ChaCha20-Poly1305 nonce
     nonce: [crypto.ChaCha20Poly1305.nonce_length]u8,
-    /// ML-DSA signature
+    /// ML-DSA signature; unused (zero) in batch-signed blocks
     signature: [crypto.MLDSA65.Signature.encoded_length]u8,
+    /// Inclusion proof; set for batch-signed blocks only
+    proof: ?[batch_proof_length]u8 = null,
     /// Previous block hash (for versioning)
     prev_hash: [crypto.Sha3_256.digest_length]u8,
     /// This block's hash (computed)
@@ -72,85 +156,52 @@ pub const Block = struct {
 
     /// Compute the hash of this block
     pub fn computeHash(self: *const Block) [crypto.Sha3_256.digest_length]u8 {
-        var hasher = crypto.Sha3_256.init(.{});
-
-        // Hash all fields except the hash itself
-        hasher.update(&[_]u8{self.version});
-        hasher.update(&[_]u8{@intFromEnum(self.block_type)});
-
-        var timestamp_bytes: [8]u8 = undefined;
-        std.mem.writeInt(i64, &timestamp_bytes, self.timestamp, .little);
-        hasher.update(&timestamp_bytes);
-
-        hasher.update(&self.author);
-        hasher.update(self.data);
-        hasher.update(&self.nonce);
-        hasher.update(&self.signature);
-        hasher.update(&self.prev_hash);
-
-        var result: [crypto.Sha3_256.digest_length]u8 = undefined;
-        hasher.final(&result);
-        return result;
-    }
-
-    /// Helper: serialize block data for signing (everything except signature)
-    fn serializeForSigning(self: *const Block, allocator: std.mem.Allocator) ![]u8 {
-        var list = std.ArrayList(u8){};
-
-        // Add all fields except signature
-        try list.append(allocator, self.version);
-        try list.append(allocator, @intFromEnum(self.block_type));
-
-        var timestamp_bytes: [8]u8 = undefined;
-        std.mem.writeInt(i64, &timestamp_bytes, self.timestamp, .little);
-        try list.appendSlice(allocator, &timestamp_bytes);
-
-        try list.appendSlice(allocator, &self.author);
-        try list.appendSlice(allocator, &self.nonce);
-
-        // Data length + data
-        var len_bytes: [4]u8 = undefined;
-        std.mem.writeInt(u32, &len_bytes, @intCast(self.data.len), .little);
-        try list.appendSlice(allocator, &len_bytes);
-        try list.appendSlice(allocator, self.data);
-
-        try list.appendSlice(allocator, &self.prev_hash);
-
-        return try list.toOwnedSlice(allocator);
+        return self.fields().computeHash();
     }
 
     /// Sign this block with a secret key
+    ///
+    /// `allocator` is no longer used: the signed fields are streamed into
+    /// the signer. Kept for API compatibility; see `signWith`.
     pub fn sign(self: *Block, secret_key_bytes: *const [crypto.MLDSA65.SecretKey.encoded_length]u8, allocator: std.mem.Allocator) !void {
+        _ = allocator;
+
         // Reconstruct SecretKey from bytes
         const secret_key = try crypto.MLDSA65.SecretKey.fromBytes(secret_key_bytes.*);
 
-        // Serialize block data for signing
-        const data_to_sign = try self.serializeForSigning(allocator);
-        defer allocator.free(data_to_sign);
-
-        // Create signer and sign
-        var signer = try secret_key.signer(null); // null = deterministic signing
-        signer.update(data_to_sign);
-        const signature = signer.finalize();
+        return self.signWith(&secret_key);
+    }
 
-        // Store signature bytes
-        self.signature = signature.toBytes();
+    /// Sign this block with an already decoded secret key
+    /// (e.g. `Identity.signingKey()`). Does not allocate.
+    pub fn signWith(self: *Block, secret_key: *const crypto.MLDSA65.SecretKey) !void {
+        self.signature = try self.fields().sign(secret_key);
     }
 
     /// Verify the signature on this block
+    ///
+    /// `allocator` is no longer used; kept for API compatibility.
     pub fn verify(self: *const Block, allocator: std.mem.Allocator) !void {
-        // Reconstruct PublicKey from bytes
-        const public_key = try crypto.MLDSA65.PublicKey.fromBytes(self.author);
-
-        // Reconstruct Signature from bytes
-        const signature = try crypto.MLDSA65.Signature.fromBytes(self.signature);
+        _ = allocator;
+        return self.fields().verify();
+    }
 
-        // Serialize block data for verification
-        const data_to_verify = try self.serializeForSigning(allocator);
-        defer allocator.free(data_to_verify);
+    /// Verify against an already parsed author key. Does not allocate.
+    pub fn verifyWith(self: *const Block, public_key: crypto.MLDSA65.PublicKey) !void {
+        return self.fields().verifyWith(public_key);
+    }
 
-        // Verify signature
-        try signature.verify(data_to_verify, public_key);
+    fn fields(self: *const Block) Fields {
+        return .{
+            .version = self.version,
+            .block_type = self.block_type,
+            .timestamp = self.timestamp,
+            .author = if (self.author_id) |*id| .{ .id = id } else .{ .key = &self.author },
+            .nonce = &self.nonce,
+            .data = self.data,
+            .prev_hash = &self.prev_hash,
+            .signature = if (self.proof == null) &self.signature else null,
+        };
     }
 
     /// Serialize block to bytes for storage
@@ -168,8 +219,13 @@ pub const Block = struct {
         std.mem.writeInt(i64, &ts_bytes, self.timestamp, .little);
         try list.appendSlice(allocator, &ts_bytes);
 
-        // Author (1952 bytes)
-        try list.appendSlice(allocator, &self.author);
+        // Author (1952 bytes, or a 32-byte fingerprint in compact blocks)
+        if (self.author_id) |*id| {
+            std.debug.assert(hasKeyId(self.version));
+            try list.appendSlice(allocator, id);
+        } else {
+            try list.appendSlice(allocator, &self.author);
+        }
 
         // Nonce (12 bytes)
         try list.appendSlice(allocator, &self.nonce);
@@ -185,8 +241,13 @@ pub const Block = struct {
         // Prev hash (32 bytes)
         try list.appendSlice(allocator, &self.prev_hash);
 
-        // Signature (3309 bytes)
-        try list.appendSlice(allocator, &self.signature);
+        // Signature (3309 bytes), or the inclusion proof of a batch-signed block
+        if (self.proof) |*proof| {
+            std.debug.assert(self.version == batched_version);
+            try list.appendSlice(allocator, proof);
+        } else {
+            try list.appendSlice(allocator, &self.signature);
+        }
 
         // Hash (32 bytes)
         try list.appendSlice(allocator, &self.hash);
@@ -195,7 +256,277 @@ pub const Block = struct {
     }
 
     /// Deserialize block from bytes
+    ///
+    /// The payload is copied; free `data` with `allocator`. Use
+    /// `BlockView.parse` to read a block without copying.
     pub fn deserialize(bytes: []const u8, allocator: std.mem.Allocator) !Block {
+        const view = try BlockView.parse(bytes);
+
+        var block = view.toBlock();
+        block.data = try allocator.dupe(u8, view.data);
+        return block;
+    }
+};
+
+/// Bytes before a block's payload: version, type, timestamp, author,
+/// nonce and data length. Also the most any block's header can take.
+pub const header_length = 1 + 1 + 8 + crypto.MLDSA65.PublicKey.encoded_length +
+    crypto.ChaCha20Poly1305.nonce_length + 4;
+
+/// Header length of compact blocks, with a key fingerprint as author
+pub const compact_header_length = 1 + 1 + 8 + @sizeOf(KeyId) +
+    crypto.ChaCha20Poly1305.nonce_length + 4;
+
+/// Header length for a block `version`
+pub fn headerLength(version: u8) usize {
+    return if (hasKeyId(version)) compact_header_length else header_length;
+}
+
+/// Bytes after a block's payload: prev_hash, signature and hash
+const trailer_length = crypto.Sha3_256.digest_length + crypto.MLDSA65.Signature.encoded_length +
+    crypto.Sha3_256.digest_length;
+
+/// Trailer length for a block `version`; batch-signed blocks carry a
+/// proof instead of a signature
+fn trailerLength(version: u8) usize {
+    if (version != batched_version) return trailer_length;
+    return crypto.Sha3_256.digest_length + batch_proof_length + crypto.Sha3_256.digest_length;
+}
+
+/// Inclusion proof field of a serialized batch-signed block
+pub fn batchProof(bytes: []u8) *[batch_proof_length]u8 {
+    return bytes[bytes.len - crypto.Sha3_256.digest_length - batch_proof_length ..][0..batch_proof_length];
+}
+
+/// Size of a serialized version 1 block carrying `data_len` payload bytes
+pub fn serializedLength(data_len: usize) usize {
+    return header_length + data_len + trailer_length;
+}
+
+/// Size of a serialized block of `version` carrying `data_len` payload bytes
+pub fn serializedLengthFor(version: u8, data_len: usize) usize {
+    return headerLength(version) + data_len + trailerLength(version);
+}
+
+/// Fixed-size prefix of a serialized block
+///
+/// Enough to classify a block and find its payload without reading the
+/// payload itself; see `BlockStore.readHeader`.
+pub const BlockHeader = struct {
+    version: u8,
+    block_type: BlockType,
+    timestamp: i64,
+    /// Author's public key; zero in compact blocks
+    author: [crypto.MLDSA65.PublicKey.encoded_length]u8,
+    /// Fingerprint of the author key; set for compact blocks only
+    author_id: ?KeyId = null,
+    nonce: [crypto.ChaCha20Poly1305.nonce_length]u8,
+    /// Payload length in bytes
+    data_len: u32,
+
+    /// Parse the header at the start of a serialized block: the first
+    /// `header_length` bytes, or `compact_header_length` for compact blocks
+    pub fn parse(bytes: []const u8) !BlockHeader {
+        if (bytes.len < compact_header_length) return error.InvalidBlock;
+
+        var header = BlockHeader{
+            .version = bytes[0],
+            .block_type = BlockType.fromInt(bytes[1]) orelse return error.InvalidBlock,
+            .timestamp = std.mem.readInt(i64, bytes[2..10], .little),
+            .author = [_]u8{0} ** 1952,
+            .nonce = undefined,
+            .data_len = undefined,
+        };
+
+        const length = headerLength(header.version);
+        if (bytes.len < length) return error.InvalidBlock;
+
+        if (hasKeyId(header.version)) {
+            header.author_id = bytes[10..][0..32].*;
+        } else {
+            header.author = bytes[10..][0..1952].*;
+        }
+        header.nonce = bytes[length - 16 ..][0..12].*;
+        header.data_len = std.mem.readInt(u32, bytes[length - 4 ..][0..4], .little);
+        return header;
+    }
+
+    /// Size of the whole serialized block
+    pub fn blockLength(self: *const BlockHeader) usize {
+        return serializedLengthFor(self.version, self.data_len);
+    }
+};
+
+/// Builds a serialized block in place
+///
+/// The caller provides an output buffer of `serializedLength(data_len)`
+/// bytes (`serializedLengthFor(compact_version, data_len)` for a compact
+/// block) and fills `payload()` directly (e.g. by encrypting into it).
+/// `seal` then signs and hashes in a single pass over the payload, feeding
+/// each tile to the signer and the hasher while it is still in cache, and
+/// writes the signature and hash into the trailer. The result is the exact
+/// byte image `Block.serialize` would produce, ready for
+/// `BlockStore.putBytes`, with no intermediate copies.
+///
+/// Batch-signed blocks (`batched_version`) are finished with `digest`
+/// instead, and their proof is written later by `batch.Signer`.
+///
+/// ```zig
+/// const out = try allocator.alloc(u8, serializedLength(plaintext.len + tag_length));
+/// var builder = BlockBuilder.init(out, .{ .block_type = .content, .author = &pk, .nonce = nonce });
+/// encryptDataInto(builder.payload(), plaintext, key, nonce);
+/// const hash = try builder.seal(&signing_key);
+/// try store.putBytes(hash, out);
+/// ```
+pub const BlockBuilder = struct {
+    /// The whole serialized block
+    bytes: []u8,
+    /// Header and trailer lengths for the block's version
+    header_len: usize,
+    trailer_len: usize,
+
+    /// Payload bytes hashed and signed per step of `seal`
+    const tile_length = 16 * 1024;
+
+    pub const Options = struct {
+        /// `compact_version` and `batched_version` write `keyId(author)`
+        /// instead of the key
+        version: u8 = 0x01,
+        block_type: BlockType,
+        timestamp: i64 = 0,
+        author: *const [crypto.MLDSA65.PublicKey.encoded_length]u8,
+        nonce: [crypto.ChaCha20Poly1305.nonce_length]u8,
+        prev_hash: [crypto.Sha3_256.digest_length]u8 = [_]u8{0} ** 32,
+    };
+
+    /// Write the header and prev_hash into `out`; the payload length is
+    /// implied by `out.len`
+    pub fn init(out: []u8, options: Options) BlockBuilder {
+        const header_len = headerLength(options.version);
+        const trailer_len = trailerLength(options.version);
+        std.debug.assert(out.len >= header_len + trailer_len);
+        const data_len = out.len - header_len - trailer_len;
+
+        out[0] = options.version;
+        out[1] = @intFromEnum(options.block_type);
+        std.mem.writeInt(i64, out[2..10], options.timestamp, .little);
+        if (hasKeyId(options.version)) {
+            out[10..][0..32].* = keyId(options.author);
+        } else {
+            @memcpy(out[10..][0..1952], options.author);
+        }
+        @memcpy(out[header_len - 16 ..][0..12], &options.nonce);
+        std.mem.writeInt(u32, out[header_len - 4 ..][0..4], @intCast(data_len), .little);
+        @memcpy(out[header_len + data_len ..][0..32], &options.prev_hash);
+
+        return BlockBuilder{ .bytes = out, .header_len = header_len, .trailer_len = trailer_len };
+    }
+
+    /// Payload region, to be filled before `seal`
+    pub fn payload(self: *const BlockBuilder) []u8 {
+        return self.bytes[self.header_len .. self.bytes.len - self.trailer_len];
+    }
+
+    /// Sign and hash the block, fill in the trailer and return the hash
+    pub fn seal(self: *BlockBuilder, secret_key: *const crypto.MLDSA65.SecretKey) ![crypto.Sha3_256.digest_length]u8 {
+        std.debug.assert(self.bytes[0] != batched_version);
+
+        const bytes = self.bytes;
+        const header_len = self.header_len;
+        const data = self.payload();
+        const trailer = bytes[header_len + data.len ..];
+        const prev_hash = trailer[0..32];
+        const signature = trailer[32..][0..crypto.MLDSA65.Signature.encoded_length];
+        const hash = trailer[32 + signature.len ..][0..32];
+
+        // Signed:  version type timestamp author nonce len data prev_hash
+        // Hashed:  version type timestamp author data nonce signature prev_hash
+        // Both passes share one walk over the payload; counted as signing
+        const span = metrics.start(.sign);
+        defer span.end(data.len);
+
+        var signer = try secret_key.signer(null); // null = deterministic signing
+        var hasher = crypto.Sha3_256.init(.{});
+
+        // The author field ends where the nonce starts
+        signer.update(bytes[0..header_len]);
+        hasher.update(bytes[0 .. header_len - 16]);
+
+        var pos: usize = 0;
+        while (pos < data.len) {
+            const tile = data[pos..@min(pos + tile_length, data.len)];
+            signer.update(tile);
+            hasher.update(tile);
+            pos += tile.len;
+        }
+
+        signer.update(prev_hash);
+        signature.* = signer.finalize().toBytes();
+
+        hasher.update(bytes[header_len - 16 ..][0..12]);
+        hasher.update(signature);
+        hasher.update(prev_hash);
+        hasher.final(hash);
+
+        return hash.*;
+    }
+
+    /// Hash a batch-signed block without signing it, write the hash into
+    /// the trailer and return it. The proof is left for `batch.Signer`;
+    /// the hash does not cover it.
+    pub fn digest(self: *BlockBuilder) [crypto.Sha3_256.digest_length]u8 {
+        std.debug.assert(self.bytes[0] == batched_version);
+
+        const bytes = self.bytes;
+        const header_len = self.header_len;
+        const data = self.payload();
+        const trailer = bytes[header_len + data.len ..];
+        const prev_hash = trailer[0..32];
+        const hash = trailer[trailer.len - 32 ..][0..32];
+
+        // Hashed:  version type timestamp author data nonce prev_hash
+        const span = metrics.start(.sha3);
+        defer span.end(data.len);
+
+        var hasher = crypto.Sha3_256.init(.{});
+        hasher.update(bytes[0 .. header_len - 16]);
+        hasher.update(data);
+        hasher.update(bytes[header_len - 16 ..][0..12]);
+        hasher.update(prev_hash);
+        hasher.final(hash);
+
+        return hash.*;
+    }
+
+    /// View of the sealed block
+    pub fn view(self: *const BlockBuilder) BlockView {
+        return BlockView.parse(self.bytes) catch unreachable;
+    }
+};
+
+/// Borrowed, zero-copy view of a serialized block
+///
+/// Every field points into the buffer passed to `parse`, so reading a
+/// block costs only bounds checks. The view is valid for as long as that
+/// buffer is.
+pub const BlockView = struct {
+    version: u8,
+    block_type: BlockType,
+    timestamp: i64,
+    /// Author key, or its fingerprint in compact blocks
+    author: Author,
+    nonce: *const [crypto.ChaCha20Poly1305.nonce_length]u8,
+    data: []const u8,
+    prev_hash: *const [crypto.Sha3_256.digest_length]u8,
+    /// Null for batch-signed blocks, which carry `proof` instead
+    signature: ?*const [crypto.MLDSA65.Signature.encoded_length]u8,
+    proof: ?*const [batch_proof_length]u8 = null,
+    hash: *const [crypto.Sha3_256.digest_length]u8,
+    /// The complete serialized block
+    bytes: []const u8,
+
+    /// Parse a serialized block without copying
+    pub fn parse(bytes: []const u8) !BlockView {
         var pos: usize = 0;
 
         // Read version
@@ -205,7 +536,7 @@ pub const Block = struct {
 
         // Read block type
         if (pos + 1 > bytes.len) return error.InvalidBlock;
-        const block_type: BlockType = @enumFromInt(bytes[pos]);
+        const block_type = BlockType.fromInt(bytes[pos]) orelse return error.InvalidBlock;
         pos += 1;
 
         // Read timestamp
@@ -213,16 +544,21 @@ pub const Block = struct {
         const timestamp = std.mem.readInt(i64, bytes[pos..][0..8], .little);
         pos += 8;
 
-        // Read author
-        if (pos + 1952 > bytes.len) return error.InvalidBlock;
-        var author: [1952]u8 = undefined;
-        @memcpy(&author, bytes[pos..][0..1952]);
-        pos += 1952;
+        // Read author: the key, or its fingerprint in compact blocks
+        var author: Author = undefined;
+        if (hasKeyId(version)) {
+            if (pos + 32 > bytes.len) return error.InvalidBlock;
+            author = .{ .id = bytes[pos..][0..32] };
+            pos += 32;
+        } else {
+            if (pos + 1952 > bytes.len) return error.InvalidBlock;
+            author = .{ .key = bytes[pos..][0..1952] };
+            pos += 1952;
+        }
 
         // Read nonce
         if (pos + 12 > bytes.len) return error.InvalidBlock;
-        var nonce: [12]u8 = undefined;
-        @memcpy(&nonce, bytes[pos..][0..12]);
+        const nonce = bytes[pos..][0..12];
         pos += 12;
 
         // Read data length
@@ -231,42 +567,206 @@ pub const Block = struct {
         pos += 4;
 
         // Read data
-        if (pos + data_len > bytes.len) return error.InvalidBlock;
-        const data = try allocator.dupe(u8, bytes[pos..][0..data_len]);
+        if (data_len > bytes.len - pos) return error.InvalidBlock;
+        const data = bytes[pos..][0..data_len];
         pos += data_len;
 
         // Read prev_hash
         if (pos + 32 > bytes.len) return error.InvalidBlock;
-        var prev_hash: [32]u8 = undefined;
-        @memcpy(&prev_hash, bytes[pos..][0..32]);
+        const prev_hash = bytes[pos..][0..32];
         pos += 32;
 
-        // Read signature
-        if (pos + 3309 > bytes.len) return error.InvalidBlock;
-        var signature: [3309]u8 = undefined;
-        @memcpy(&signature, bytes[pos..][0..3309]);
-        pos += 3309;
+        // Read signature, or the inclusion proof of a batch-signed block
+        var signature: ?*const [3309]u8 = null;
+        var proof: ?*const [batch_proof_length]u8 = null;
+        if (version == batched_version) {
+            if (pos + batch_proof_length > bytes.len) return error.InvalidBlock;
+            proof = bytes[pos..][0..batch_proof_length];
+            pos += batch_proof_length;
+        } else {
+            if (pos + 3309 > bytes.len) return error.InvalidBlock;
+            signature = bytes[pos..][0..3309];
+            pos += 3309;
+        }
 
         // Read hash
         if (pos + 32 > bytes.len) return error.InvalidBlock;
-        var hash: [32]u8 = undefined;
-        @memcpy(&hash, bytes[pos..][0..32]);
+        const hash = bytes[pos..][0..32];
         pos += 32;
 
-        return Block{
+        return BlockView{
             .version = version,
             .block_type = block_type,
             .timestamp = timestamp,
             .author = author,
-            .data = data,
             .nonce = nonce,
-            .signature = signature,
+            .data = data,
             .prev_hash = prev_hash,
+            .signature = signature,
+            .proof = proof,
             .hash = hash,
+            .bytes = bytes[0..pos],
+        };
+    }
+
+    /// Compute the hash of the viewed block
+    pub fn computeHash(self: *const BlockView) [crypto.Sha3_256.digest_length]u8 {
+        return self.fields().computeHash();
+    }
+
+    /// Verify the signature on the viewed block
+    ///
+    /// Compact blocks do not carry the key: this fails with
+    /// `error.UnknownAuthor`, use `verifyWith` or `KeyRegistry.verify`.
+    /// Batch-signed blocks fail with `error.BatchSigned`; check them
+    /// against their root with `batch.verifyInclusion`.
+    /// `allocator` is no longer used; kept for API compatibility.
+    pub fn verify(self: *const BlockView, allocator: std.mem.Allocator) !void {
+        _ = allocator;
+        return self.fields().verify();
+    }
+
+    /// Verify against an already parsed author key, e.g. one cached across
+    /// many blocks by the same author, or resolved from a compact block's
+    /// fingerprint. Does not allocate.
+    pub fn verifyWith(self: *const BlockView, public_key: crypto.MLDSA65.PublicKey) !void {
+        return self.fields().verifyWith(public_key);
+    }
+
+    /// Copy the fixed-size fields into a `Block`. The returned block's
+    /// `data` still borrows from the viewed buffer.
+    pub fn toBlock(self: *const BlockView) Block {
+        return Block{
+            .version = self.version,
+            .block_type = self.block_type,
+            .timestamp = self.timestamp,
+            .author = switch (self.author) {
+                .key => |key| key.*,
+                .id => [_]u8{0} ** 1952,
+            },
+            .author_id = switch (self.author) {
+                .key => null,
+                .id => |id| id.*,
+            },
+            .data = self.data,
+            .nonce = self.nonce.*,
+            .signature = if (self.signature) |signature| signature.* else [_]u8{0} ** 3309,
+            .proof = if (self.proof) |proof| proof.* else null,
+            .prev_hash = self.prev_hash.*,
+            .hash = self.hash.*,
+        };
+    }
+
+    fn fields(self: *const BlockView) Fields {
+        return .{
+            .version = self.version,
+            .block_type = self.block_type,
+            .timestamp = self.timestamp,
+            .author = self.author,
+            .nonce = self.nonce,
+            .data = self.data,
+            .prev_hash = self.prev_hash,
+            .signature = self.signature,
         };
     }
 };
 
+/// Signed and hashed fields of a block, by reference.
+/// Shared by `Block` and `BlockView` so both hash and verify identically.
+const Fields = struct {
+    version: u8,
+    block_type: BlockType,
+    timestamp: i64,
+    author: Author,
+    nonce: *const [crypto.ChaCha20Poly1305.nonce_length]u8,
+    data: []const u8,
+    prev_hash: *const [crypto.Sha3_256.digest_length]u8,
+    /// Null for batch-signed blocks; their hash leaves the proof out
+    signature: ?*const [crypto.MLDSA65.Signature.encoded_length]u8,
+
+    fn computeHash(self: Fields) [crypto.Sha3_256.digest_length]u8 {
+        const span = metrics.start(.sha3);
+        defer span.end(self.data.len);
+
+        var hasher = crypto.Sha3_256.init(.{});
+
+        // Hash all fields except the hash itself
+        hasher.update(&[_]u8{self.version});
+        hasher.update(&[_]u8{@intFromEnum(self.block_type)});
+
+        var timestamp_bytes: [8]u8 = undefined;
+        std.mem.writeInt(i64, &timestamp_bytes, self.timestamp, .little);
+        hasher.update(&timestamp_bytes);
+
+        hasher.update(self.author.bytes());
+        hasher.update(self.data);
+        hasher.update(self.nonce);
+        if (self.signature) |signature| hasher.update(signature);
+        hasher.update(self.prev_hash);
+
+        var result: [crypto.Sha3_256.digest_length]u8 = undefined;
+        hasher.final(&result);
+        return result;
+    }
+
+    /// Stream the signed message (every field except the signature) into
+    /// a signer or verifier, so the payload is never copied
+    fn feedSigned(self: Fields, state: anytype) void {
+        state.update(&[_]u8{ self.version, @intFromEnum(self.block_type) });
+
+        var timestamp_bytes: [8]u8 = undefined;
+        std.mem.writeInt(i64, &timestamp_bytes, self.timestamp, .little);
+        state.update(&timestamp_bytes);
+
+        state.update(self.author.bytes());
+        state.update(self.nonce);
+
+        // Data length + data
+        var len_bytes: [4]u8 = undefined;
+        std.mem.writeInt(u32, &len_bytes, @intCast(self.data.len), .little);
+        state.update(&len_bytes);
+        state.update(self.data);
+
+        state.update(self.prev_hash);
+    }
+
+    fn sign(self: Fields, secret_key: *const crypto.MLDSA65.SecretKey) ![crypto.MLDSA65.Signature.encoded_length]u8 {
+        const span = metrics.start(.sign);
+        defer span.end(self.data.len);
+
+        var signer = try secret_key.signer(null); // null = deterministic signing
+        self.feedSigned(&signer);
+        return signer.finalize().toBytes();
+    }
+
+    fn verify(self: Fields) !void {
+        if (self.signature == null) return error.BatchSigned;
+
+        const author = switch (self.author) {
+            .key => |key| key,
+            .id => return error.UnknownAuthor,
+        };
+
+        // Reconstruct PublicKey from bytes
+        const public_key = try crypto.MLDSA65.PublicKey.fromBytes(author.*);
+
+        return self.verifyWith(public_key);
+    }
+
+    fn verifyWith(self: Fields, public_key: crypto.MLDSA65.PublicKey) !void {
+        const span = metrics.start(.verify);
+        defer span.end(self.data.len);
+
+        // Reconstruct Signature from bytes
+        const encoded = self.signature orelse return error.BatchSigned;
+        const signature = try crypto.MLDSA65.Signature.fromBytes(encoded.*);
+
+        var verifier = try signature.verifier(public_key);
+        self.feedSigned(&verifier);
+        try verifier.verify();
+    }
+};
+
 /// Encrypt plaintext data using ChaCha20-Poly1305
 /// Returns ciphertext || tag (16-byte tag appended)
 pub fn encryptData(
@@ -279,23 +779,33 @@ pub fn encryptData(
     const ciphertext_with_tag = try allocator.alloc(u8, plaintext.len + crypto.ChaCha20Poly1305.tag_length);
     errdefer allocator.free(ciphertext_with_tag);
 
-    const ciphertext = ciphertext_with_tag[0..plaintext.len];
-    var tag: [crypto.ChaCha20Poly1305.tag_length]u8 = undefined;
+    encryptDataInto(ciphertext_with_tag, plaintext, key, nonce);
+
+    return ciphertext_with_tag;
+}
+
+/// Encrypt plaintext into a caller-provided buffer
+/// `out` must be exactly plaintext.len + tag_length bytes (ciphertext || tag)
+pub fn encryptDataInto(
+    out: []u8,
+    plaintext: []const u8,
+    key: [32]u8,
+    nonce: [12]u8,
+) void {
+    std.debug.assert(out.len == plaintext.len + crypto.ChaCha20Poly1305.tag_length);
+
+    const span = metrics.start(.aead_seal);
+    defer span.end(plaintext.len);
 
-    // Encrypt (no additional data)
+    // Encrypt (no additional data), tag written straight after the ciphertext
     crypto.ChaCha20Poly1305.encrypt(
-        ciphertext,
-        &tag,
+        out[0..plaintext.len],
+        out[plaintext.len..][0..crypto.ChaCha20Poly1305.tag_length],
         plaintext,
         &[_]u8{}, // no additional authenticated data
         nonce,
         key,
     );
-
-    // Append tag
-    @memcpy(ciphertext_with_tag[plaintext.len..], &tag);
-
-    return ciphertext_with_tag;
 }
 
 /// Decrypt ciphertext data using ChaCha20-Poly1305
@@ -310,27 +820,46 @@ pub fn decryptData(
         return error.InvalidCiphertext;
     }
 
+    // Allocate space for plaintext
+    const plaintext = try allocator.alloc(u8, ciphertext_with_tag.len - crypto.ChaCha20Poly1305.tag_length);
+    errdefer allocator.free(plaintext);
+
+    try decryptDataInto(plaintext, ciphertext_with_tag, key, nonce);
+
+    return plaintext;
+}
+
+/// Decrypt ciphertext || tag into a caller-provided buffer
+/// `out` must be exactly ciphertext_with_tag.len - tag_length bytes
+pub fn decryptDataInto(
+    out: []u8,
+    ciphertext_with_tag: []const u8,
+    key: [32]u8,
+    nonce: [12]u8,
+) !void {
+    if (ciphertext_with_tag.len < crypto.ChaCha20Poly1305.tag_length) {
+        return error.InvalidCiphertext;
+    }
+
     const tag_start = ciphertext_with_tag.len - crypto.ChaCha20Poly1305.tag_length;
+    if (out.len != tag_start) return error.InvalidCiphertext;
+
     const ciphertext = ciphertext_with_tag[0..tag_start];
-    const tag_slice = ciphertext_with_tag[tag_start..];
     var tag: [crypto.ChaCha20Poly1305.tag_length]u8 = undefined;
-    @memcpy(&tag, tag_slice);
+    @memcpy(&tag, ciphertext_with_tag[tag_start..]);
 
-    // Allocate space for plaintext
-    const plaintext = try allocator.alloc(u8, ciphertext.len);
-    errdefer allocator.free(plaintext);
+    const span = metrics.start(.aead_open);
+    defer span.end(out.len);
 
     // Decrypt and verify
     try crypto.ChaCha20Poly1305.decrypt(
-        plaintext,
+        out,
         ciphertext,
         tag,
         &[_]u8{}, // no additional authenticated data
         nonce,
         key,
     );
-
-    return plaintext;
 }
 
 test "block structure compiles" {
@@ -429,6 +958,122 @@ test "block signing and verification" {
 
     // Verification should succeed again
     try block.verify(allocator);
+
+    // Streaming variants never allocate and produce the same signature
+    const signature = block.signature;
+    const signing_key = try identity.signingKey();
+    try block.signWith(&signing_key);
+    try std.testing.expectEqualSlices(u8, &signature, &block.signature);
+    try block.verify(std.testing.failing_allocator);
+    try block.verifyWith(try crypto.MLDSA65.PublicKey.fromBytes(identity.public_key));
+}
+
+test "block builder matches sign, hash and serialize" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+
+    // Large enough to span several tiles
+    const data = try allocator.alloc(u8, 40 * 1024 + 7);
+    defer allocator.free(data);
+    for (data, 0..) |*b, i| b.* = @truncate(i);
+
+    var block = Block{
+        .version = 0x01,
+        .block_type = .manifest,
+        .timestamp = 42,
+        .author = identity.public_key,
+        .data = data,
+        .nonce = [_]u8{9} ** crypto.ChaCha20Poly1305.nonce_length,
+        .signature = undefined,
+        .prev_hash = [_]u8{7} ** crypto.Sha3_256.digest_length,
+        .hash = undefined,
+    };
+    try block.signWith(&signing_key);
+    block.hash = block.computeHash();
+
+    const expected = try block.serialize(allocator);
+    defer allocator.free(expected);
+
+    const out = try allocator.alloc(u8, serializedLength(data.len));
+    defer allocator.free(out);
+
+    var builder = BlockBuilder.init(out, .{
+        .block_type = .manifest,
+        .timestamp = 42,
+        .author = &identity.public_key,
+        .nonce = block.nonce,
+        .prev_hash = block.prev_hash,
+    });
+    @memcpy(builder.payload(), data);
+    const hash = try builder.seal(&signing_key);
+
+    try std.testing.expectEqualSlices(u8, &block.hash, &hash);
+    try std.testing.expectEqualSlices(u8, expected, out);
+    try builder.view().verify(allocator);
+}
+
+test "compact blocks carry the author fingerprint" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+    const data = "small metadata payload";
+
+    const out = try allocator.alloc(u8, serializedLengthFor(compact_version, data.len));
+    defer allocator.free(out);
+    try std.testing.expectEqual(serializedLength(data.len) - 1920, out.len);
+
+    var builder = BlockBuilder.init(out, .{
+        .version = compact_version,
+        .block_type = .metadata,
+        .author = &identity.public_key,
+        .nonce = [_]u8{5} ** crypto.ChaCha20Poly1305.nonce_length,
+    });
+    @memcpy(builder.payload(), data);
+    const hash = try builder.seal(&signing_key);
+
+    // Same image and hash as signing a compact `Block`
+    var block = Block{
+        .version = compact_version,
+        .block_type = .metadata,
+        .timestamp = 0,
+        .author = [_]u8{0} ** 1952,
+        .author_id = keyId(&identity.public_key),
+        .data = data,
+        .nonce = [_]u8{5} ** crypto.ChaCha20Poly1305.nonce_length,
+        .signature = undefined,
+        .prev_hash = [_]u8{0} ** 32,
+        .hash = undefined,
+    };
+    try block.signWith(&signing_key);
+    block.hash = block.computeHash();
+    try std.testing.expectEqualSlices(u8, &block.hash, &hash);
+
+    const expected = try block.serialize(allocator);
+    defer allocator.free(expected);
+    try std.testing.expectEqualSlices(u8, expected, out);
+
+    // The key has to come from elsewhere
+    const view = try BlockView.parse(out);
+    try std.testing.expectEqualSlices(u8, &keyId(&identity.public_key), &view.author.fingerprint());
+    try std.testing.expectEqualSlices(u8, data, view.data);
+    try std.testing.expectError(error.UnknownAuthor, view.verify(allocator));
+    try view.verifyWith(try crypto.MLDSA65.PublicKey.fromBytes(identity.public_key));
+    try std.testing.expectError(error.SignatureVerificationFailed, view.verifyWith(try crypto.MLDSA65.PublicKey.fromBytes(Identity.generate().public_key)));
+
+    const header = try BlockHeader.parse(out);
+    try std.testing.expectEqual(BlockType.metadata, header.block_type);
+    try std.testing.expectEqual(@as(u32, data.len), header.data_len);
+    try std.testing.expectEqual(out.len, header.blockLength());
+
+    // Owned blocks keep the fingerprint through a round trip
+    const copy = try Block.deserialize(expected, allocator);
+    defer allocator.free(copy.data);
+    try std.testing.expectEqualSlices(u8, &block.author_id.?, &copy.author_id.?);
 }
 
 test "data encryption and decryption" {
@@ -498,6 +1143,26 @@ test "block serialization round-trip" {
     try std.testing.expectEqualSlices(u8, &block.signature, &deserialized.signature);
     try std.testing.expectEqualSlices(u8, &block.prev_hash, &deserialized.prev_hash);
     try std.testing.expectEqualSlices(u8, &block.hash, &deserialized.hash);
+
+    // A view borrows the same fields without copying
+    const view = try BlockView.parse(bytes);
+    try std.testing.expectEqual(bytes.ptr + 1 + 1 + 8 + 1952 + 12 + 4, view.data.ptr);
+    try std.testing.expectEqualSlices(u8, block.data, view.data);
+    try std.testing.expectEqualSlices(u8, &block.signature, view.signature.?);
+    try std.testing.expectEqualSlices(u8, &block.computeHash(), &view.computeHash());
+    try std.testing.expectEqual(bytes.len, view.bytes.len);
+
+    // The header alone is enough to classify the block
+    const header = try BlockHeader.parse(bytes[0..header_length]);
+    try std.testing.expectEqual(BlockType.content, header.block_type);
+    try std.testing.expectEqual(@as(u32, test_data.len), header.data_len);
+    try std.testing.expectEqualSlices(u8, &block.nonce, &header.nonce);
+    try std.testing.expectEqual(bytes.len, header.blockLength());
+    try std.testing.expectError(error.InvalidBlock, BlockHeader.parse(bytes[0 .. header_length - 1]));
+
+    // Unknown block types are rejected
+    bytes[1] = 0xFF;
+    try std.testing.expectError(error.InvalidBlock, BlockView.parse(bytes));
 }
 
 const max_fuzz_block_len = 4096;
@@ -0,0 +1,353 @@
+//! Sharded LRU cache of verified blocks
+//!
+//! Keeps recently read blocks in memory after their signature has been
+//! checked, so repeated gets and share redemptions skip both the store
+//! read and the ML-DSA verification. Blocks are sharded by the first byte
+//! of their hash, each shard with its own lock, so lookups from many
+//! threads rarely contend.
+//!
+//! Metadata-like blocks (metadata, manifests, everything but content) and
+//! content chunks have separate byte budgets and LRU lists, so streaming a
+//! large file cannot push the small, hot metadata blocks out. Content is
+//! not cached by default.
+//!
+//! Hits are returned as `StoredBlock`s pinned in the cache: an evicted
+//! block stays valid until its last reader calls `deinit`.
+//!
+//! ## Example
+//!
+//! ```zig
+//! const cache = try BlockCache.create(allocator, .{});
+//! defer cache.destroy();
+//!
+//! var stored = cache.get(hash, .metadata) orelse blk: {
+//!     var fresh = try store.read(hash);
+//!     try fresh.view.verify(allocator);
+//!     cache.insert(&fresh.view);
+//!     break :blk fresh;
+//! };
+//! defer stored.deinit();
+//! ```
+
+const std = @import("std");
+const BlockView = @import("block.zig").BlockView;
+const BlockType = @import("block.zig").BlockType;
+const store = @import("store.zig");
+const BlockHash = store.BlockHash;
+const StoredBlock = store.StoredBlock;
+
+const shard_count = 16;
+
+/// Default metadata budget (16 MiB)
+pub const default_metadata_bytes: usize = 16 * 1024 * 1024;
+
+/// Default content budget; content is not cached unless enabled
+pub const default_content_bytes: usize = 0;
+
+/// Which budget a block counts against
+pub const Kind = enum(u1) {
+    metadata,
+    content,
+
+    pub fn of(block_type: BlockType) Kind {
+        return if (block_type == .content) .content else .metadata;
+    }
+};
+
+/// Byte budgets, split evenly across shards
+pub const Limits = struct {
+    metadata_bytes: usize = default_metadata_bytes,
+    content_bytes: usize = default_content_bytes,
+
+    fn perShard(self: Limits, kind: Kind) usize {
+        return switch (kind) {
+            .metadata => self.metadata_bytes,
+            .content => self.content_bytes,
+        } / shard_count;
+    }
+};
+
+/// Counters since the cache was created
+pub const Stats = struct {
+    metadata_hits: u64 = 0,
+    metadata_misses: u64 = 0,
+    content_hits: u64 = 0,
+    content_misses: u64 = 0,
+    evictions: u64 = 0,
+    /// Bytes currently held, including per-entry overhead
+    metadata_bytes: usize = 0,
+    content_bytes: usize = 0,
+};
+
+/// A cached block; handed out through `StoredBlock.Backing.cached`
+pub const Entry = struct {
+    shard: *Shard,
+    kind: Kind,
+    /// Owned copy of the serialized block
+    bytes: []u8,
+    view: BlockView,
+    /// Readers holding the entry; guarded by the shard lock
+    pins: u32 = 0,
+    /// Still reachable from the shard map
+    linked: bool = true,
+    prev: ?*Entry = null,
+    next: ?*Entry = null,
+
+    fn cost(self: *const Entry) usize {
+        return self.bytes.len + @sizeOf(Entry);
+    }
+
+    /// Drop a reader's pin, freeing the entry if it was evicted meanwhile
+    pub fn release(self: *Entry) void {
+        const shard = self.shard;
+        shard.mutex.lock();
+        defer shard.mutex.unlock();
+
+        self.pins -= 1;
+        if (self.pins == 0 and !self.linked) shard.free(self);
+    }
+};
+
+/// Intrusive LRU list; head is the most recently used
+const Lru = struct {
+    head: ?*Entry = null,
+    tail: ?*Entry = null,
+    bytes: usize = 0,
+
+    fn pushFront(self: *Lru, entry: *Entry) void {
+        entry.prev = null;
+        entry.next = self.head;
+        if (self.head) |head| head.prev = entry else self.tail = entry;
+        self.head = entry;
+        self.bytes += entry.cost();
+    }
+
+    fn remove(self: *Lru, entry: *Entry) void {
+        if (entry.prev) |prev| prev.next = entry.next else self.head = entry.next;
+        if (entry.next) |next| next.prev = entry.prev else self.tail = entry.prev;
+        entry.prev = null;
+        entry.next = null;
+        self.bytes -= entry.cost();
+    }
+};
+
+const Shard = struct {
+    allocator: std.mem.Allocator,
+    mutex: std.Thread.Mutex = .{},
+    map: std.AutoHashMapUnmanaged(BlockHash, *Entry) = .{},
+    lru: [2]Lru = .{ .{}, .{} },
+    hits: [2]u64 = .{ 0, 0 },
+    misses: [2]u64 = .{ 0, 0 },
+    evictions: u64 = 0,
+
+    /// Evict least recently used entries of `kind` down to `budget`
+    fn trim(self: *Shard, kind: Kind, budget: usize) void {
+        const lru = &self.lru[@intFromEnum(kind)];
+        while (lru.bytes > budget) {
+            const victim = lru.tail.?;
+            lru.remove(victim);
+            _ = self.map.remove(victim.view.hash.*);
+            victim.linked = false;
+            self.evictions += 1;
+            if (victim.pins == 0) self.free(victim);
+        }
+    }
+
+    fn free(self: *Shard, entry: *Entry) void {
+        self.allocator.free(entry.bytes);
+        self.allocator.destroy(entry);
+    }
+};
+
+pub const BlockCache = struct {
+    allocator: std.mem.Allocator,
+    limits: Limits,
+    shards: [shard_count]Shard,
+
+    /// Create an empty cache
+    ///
+    /// Heap allocated because cached entries point back at their shard.
+    pub fn create(allocator: std.mem.Allocator, limits: Limits) !*BlockCache {
+        const self = try allocator.create(BlockCache);
+        self.* = .{ .allocator = allocator, .limits = limits, .shards = undefined };
+        for (&self.shards) |*shard| shard.* = .{ .allocator = allocator };
+        return self;
+    }
+
+    /// Free every entry and the cache. No block may still be pinned.
+    pub fn destroy(self: *BlockCache) void {
+        for (&self.shards) |*shard| {
+            for (&shard.lru) |*lru| {
+                while (lru.head) |entry| {
+                    std.debug.assert(entry.pins == 0);
+                    lru.remove(entry);
+                    shard.free(entry);
+                }
+            }
+            shard.map.deinit(self.allocator);
+        }
+        self.allocator.destroy(self);
+    }
+
+    fn shardFor(self: *BlockCache, hash: BlockHash) *Shard {
+        return &self.shards[hash[0] % shard_count];
+    }
+
+    /// Look up a verified block, counting a hit or a miss against `kind`
+    ///
+    /// Returns null without locking when `kind` has no budget.
+    pub fn get(self: *BlockCache, hash: BlockHash, kind: Kind) ?StoredBlock {
+        if (self.limits.perShard(kind) == 0) return null;
+
+        const shard = self.shardFor(hash);
+        shard.mutex.lock();
+        defer shard.mutex.unlock();
+
+        const entry = shard.map.get(hash) orelse {
+            shard.misses[@intFromEnum(kind)] += 1;
+            return null;
+        };
+        shard.hits[@intFromEnum(entry.kind)] += 1;
+
+        const lru = &shard.lru[@intFromEnum(entry.kind)];
+        lru.remove(entry);
+        lru.pushFront(entry);
+        entry.pins += 1;
+
+        return StoredBlock{ .view = entry.view, .backing = .{ .cached = entry } };
+    }
+
+    /// Copy a block whose signature has been verified into the cache
+    ///
+    /// Best effort: blocks over the shard budget, already cached, or that
+    /// cannot be allocated are simply not cached.
+    pub fn insert(self: *BlockCache, view: *const BlockView) void {
+        const kind = Kind.of(view.block_type);
+        const budget = self.limits.perShard(kind);
+        if (view.bytes.len + @sizeOf(Entry) > budget) return;
+
+        const shard = self.shardFor(view.hash.*);
+
+        // Copy outside the lock
+        const entry = self.allocator.create(Entry) catch return;
+        const bytes = self.allocator.dupe(u8, view.bytes) catch {
+            self.allocator.destroy(entry);
+            return;
+        };
+        entry.* = .{
+            .shard = shard,
+            .kind = kind,
+            .bytes = bytes,
+            .view = BlockView.parse(bytes) catch unreachable, // Parsed before
+        };
+
+        shard.mutex.lock();
+        defer shard.mutex.unlock();
+
+        const slot = shard.map.getOrPut(self.allocator, view.hash.*) catch {
+            shard.free(entry);
+            return;
+        };
+        if (slot.found_existing) {
+            shard.free(entry);
+            return;
+        }
+        slot.value_ptr.* = entry;
+
+        shard.lru[@intFromEnum(kind)].pushFront(entry);
+        shard.trim(kind, budget);
+    }
+
+    /// Change the budgets, evicting down to them at once
+    ///
+    /// Not safe while other threads use the cache.
+    pub fn setLimits(self: *BlockCache, limits: Limits) void {
+        self.limits = limits;
+        for (&self.shards) |*shard| {
+            shard.mutex.lock();
+            defer shard.mutex.unlock();
+            shard.trim(.metadata, limits.perShard(.metadata));
+            shard.trim(.content, limits.perShard(.content));
+        }
+    }
+
+    /// Sum the counters of every shard
+    pub fn stats(self: *BlockCache) Stats {
+        var total = Stats{};
+        for (&self.shards) |*shard| {
+            shard.mutex.lock();
+            defer shard.mutex.unlock();
+
+            total.metadata_hits += shard.hits[@intFromEnum(Kind.metadata)];
+            total.metadata_misses += shard.misses[@intFromEnum(Kind.metadata)];
+            total.content_hits += shard.hits[@intFromEnum(Kind.content)];
+            total.content_misses += shard.misses[@intFromEnum(Kind.content)];
+            total.evictions += shard.evictions;
+            total.metadata_bytes += shard.lru[@intFromEnum(Kind.metadata)].bytes;
+            total.content_bytes += shard.lru[@intFromEnum(Kind.content)].bytes;
+        }
+        return total;
+    }
+};
+
+test "block cache hits, evicts and keeps pinned blocks alive" {
+    const allocator = std.testing.allocator;
+    const crypto = @import("crypto.zig");
+    const Block = @import("block.zig").Block;
+    const Identity = @import("identity.zig").Identity;
+
+    const identity = Identity.generate();
+
+    // Three metadata blocks landing in the same shard
+    var serialized: [3][]u8 = undefined;
+    var hashes: [3]BlockHash = undefined;
+    for (&serialized, &hashes, 0..) |*bytes, *hash, i| {
+        var block = Block{
+            .version = 0x01,
+            .block_type = .metadata,
+            .timestamp = @intCast(i),
+            .author = identity.public_key,
+            .data = "cached",
+            .nonce = [_]u8{1} ** crypto.ChaCha20Poly1305.nonce_length,
+            .signature = undefined,
+            .prev_hash = [_]u8{0} ** 32,
+            .hash = undefined,
+        };
+        try block.sign(&identity.secret_key, allocator);
+        // The cache keys on the hash field; force one shard
+        block.hash = block.computeHash();
+        block.hash[0] = 0;
+        hash.* = block.hash;
+        bytes.* = try block.serialize(allocator);
+    }
+    defer for (serialized) |bytes| allocator.free(bytes);
+
+    // Room for two entries per shard
+    const entry_cost = serialized[0].len + @sizeOf(Entry);
+    const cache = try BlockCache.create(allocator, .{ .metadata_bytes = 2 * entry_cost * shard_count });
+    defer cache.destroy();
+
+    try std.testing.expect(cache.get(hashes[0], .metadata) == null);
+    for (serialized[0..2]) |bytes| cache.insert(&try BlockView.parse(bytes));
+
+    var pinned = cache.get(hashes[0], .metadata).?;
+    try std.testing.expectEqualSlices(u8, serialized[0], pinned.view.bytes);
+
+    // Inserting a third evicts the least recently used (hashes[1])
+    cache.insert(&try BlockView.parse(serialized[2]));
+    try std.testing.expect(cache.get(hashes[1], .metadata) == null);
+
+    // Content has no budget: never cached, never counted
+    try std.testing.expect(cache.get(hashes[2], .content) == null);
+
+    // Shrinking evicts the pinned block too, but it stays readable
+    cache.setLimits(.{ .metadata_bytes = 0 });
+    try std.testing.expectEqualSlices(u8, serialized[0], pinned.view.bytes);
+    pinned.deinit();
+
+    const stats = cache.stats();
+    try std.testing.expectEqual(@as(u64, 1), stats.metadata_hits);
+    try std.testing.expectEqual(@as(u64, 2), stats.metadata_misses);
+    try std.testing.expectEqual(@as(u64, 3), stats.evictions);
+    try std.testing.expectEqual(@as(usize, 0), stats.metadata_bytes);
+}
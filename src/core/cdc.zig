@@ -0,0 +1,242 @@
+//! Content-defined chunking (FastCDC)
+//!
+//! Splits a stream where its content says to, not every N bytes, so an
+//! insertion near the start of a file only changes the chunks around it
+//! and the rest still deduplicate against the previous version.
+//!
+//! A gear hash rolls over the bytes after `min_size`; a chunk ends where
+//! the top bits of the hash are zero. Before `avg_size` the test uses
+//! more bits (cuts are rarer), after it fewer, which pulls chunk sizes
+//! towards the average ("normalized chunking"). Nothing is cut after
+//! `max_size`.
+//!
+//! The gear table is derived from a key, so chunk boundaries (and with
+//! them chunk sizes) reveal nothing to whoever does not hold the key. The
+//! same key always gives the same boundaries, which is what makes chunks
+//! repeat across files.
+//!
+//! ## Example
+//!
+//! ```zig
+//! const gear = Gear.fromKey(key);
+//! var chunker = try Chunker.init(allocator, file, &gear, .{});
+//! defer chunker.deinit();
+//!
+//! const buffer = try allocator.alloc(u8, chunker.params.max_size);
+//! while (true) {
+//!     const n = try chunker.next(buffer);
+//!     if (n == 0) break;
+//!     process(buffer[0..n]);
+//! }
+//! ```
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+
+/// Chunk size bounds; sizes in bytes
+pub const Params = struct {
+    min_size: u32 = 64 * 1024,
+    avg_size: u32 = 256 * 1024,
+    max_size: u32 = 1024 * 1024,
+
+    pub fn validate(self: Params) !void {
+        if (self.min_size == 0 or self.min_size >= self.avg_size or self.avg_size >= self.max_size) {
+            return error.InvalidChunkParams;
+        }
+        if (!std.math.isPowerOfTwo(self.avg_size) or self.avg_size < 256) return error.InvalidChunkParams;
+    }
+
+    /// Stricter mask, used before `avg_size`
+    fn maskSmall(self: Params) u64 {
+        return topBits(std.math.log2_int(u32, self.avg_size) + 2);
+    }
+
+    /// Looser mask, used from `avg_size` on
+    fn maskLarge(self: Params) u64 {
+        return topBits(std.math.log2_int(u32, self.avg_size) - 2);
+    }
+
+    fn topBits(bits: u32) u64 {
+        return ~@as(u64, 0) << @intCast(64 - bits);
+    }
+};
+
+/// Per-byte random values mixed into the rolling hash
+pub const Gear = struct {
+    table: [256]u64,
+
+    /// Expand `key` into a gear table
+    pub fn fromKey(key: [32]u8) Gear {
+        const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &key);
+
+        var bytes: [256 * 8]u8 = undefined;
+        crypto.HkdfSha3_256.expand(&bytes, "zault-cdc-gear-v1", prk);
+
+        var gear: Gear = undefined;
+        for (&gear.table, 0..) |*value, i| {
+            value.* = std.mem.readInt(u64, bytes[i * 8 ..][0..8], .little);
+        }
+        return gear;
+    }
+};
+
+/// Length of the first chunk of `data`: `data.len` if it is no longer
+/// than `min_size`, never more than `max_size`. Only the end of input
+/// makes a chunk shorter than `min_size`.
+pub fn cut(gear: *const Gear, params: Params, data: []const u8) usize {
+    if (data.len <= params.min_size) return data.len;
+
+    const end = @min(data.len, params.max_size);
+    const normal = @min(end, params.avg_size);
+    const mask_small = params.maskSmall();
+    const mask_large = params.maskLarge();
+
+    var fingerprint: u64 = 0;
+    var i: usize = params.min_size;
+    while (i < normal) : (i += 1) {
+        fingerprint = (fingerprint << 1) +% gear.table[data[i]];
+        if (fingerprint & mask_small == 0) return i + 1;
+    }
+    while (i < end) : (i += 1) {
+        fingerprint = (fingerprint << 1) +% gear.table[data[i]];
+        if (fingerprint & mask_large == 0) return i + 1;
+    }
+    return end;
+}
+
+/// Reads a file and hands it out one content-defined chunk at a time
+pub const Chunker = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    gear: *const Gear,
+    params: Params,
+    /// Read-ahead of at least one maximal chunk
+    buffer: []u8,
+    start: usize = 0,
+    end: usize = 0,
+    eof: bool = false,
+
+    pub fn init(allocator: std.mem.Allocator, file: std.fs.File, gear: *const Gear, params: Params) !Chunker {
+        try params.validate();
+
+        // Twice the largest chunk, so refills are large reads
+        return Chunker{
+            .allocator = allocator,
+            .file = file,
+            .gear = gear,
+            .params = params,
+            .buffer = try allocator.alloc(u8, 2 * @as(usize, params.max_size)),
+        };
+    }
+
+    pub fn deinit(self: *Chunker) void {
+        self.allocator.free(self.buffer);
+    }
+
+    /// Copy the next chunk into `out` (at least `max_size` bytes) and
+    /// return its length; 0 once the file is exhausted
+    pub fn next(self: *Chunker, out: []u8) !usize {
+        std.debug.assert(out.len >= self.params.max_size);
+
+        if (self.end - self.start < self.params.max_size and !self.eof) try self.refill();
+
+        const chunk = self.buffer[self.start..self.end];
+        const n = cut(self.gear, self.params, chunk);
+        @memcpy(out[0..n], chunk[0..n]);
+        self.start += n;
+        return n;
+    }
+
+    /// Move the unread tail to the front and read until the buffer is
+    /// full or the file ends
+    fn refill(self: *Chunker) !void {
+        const pending = self.end - self.start;
+        std.mem.copyForwards(u8, self.buffer[0..pending], self.buffer[self.start..self.end]);
+        self.start = 0;
+        self.end = pending;
+
+        const n = try self.file.readAll(self.buffer[self.end..]);
+        self.end += n;
+        if (self.end < self.buffer.len) self.eof = true;
+    }
+};
+
+test "cdc boundaries survive an insertion" {
+    const allocator = std.testing.allocator;
+
+    const params = Params{ .min_size = 1024, .avg_size = 4096, .max_size = 16384 };
+    try params.validate();
+    const gear = Gear.fromKey([_]u8{0x11} ** 32);
+
+    const original = try allocator.alloc(u8, 256 * 1024);
+    defer allocator.free(original);
+    var prng = std.Random.DefaultPrng.init(7);
+    prng.random().bytes(original);
+
+    // Same data with 100 bytes inserted near the front
+    const edited = try allocator.alloc(u8, original.len + 100);
+    defer allocator.free(edited);
+    @memcpy(edited[0..5000], original[0..5000]);
+    @memset(edited[5000..5100], 0xEE);
+    @memcpy(edited[5100..], original[5000..]);
+
+    const Collect = struct {
+        fn chunks(out: *std.AutoHashMap([32]u8, void), g: *const Gear, p: Params, data: []const u8) !usize {
+            var count: usize = 0;
+            var pos: usize = 0;
+            while (pos < data.len) {
+                const n = cut(g, p, data[pos..]);
+                try std.testing.expect(n <= p.max_size);
+                try std.testing.expect(n >= p.min_size or pos + n == data.len);
+
+                var digest: [32]u8 = undefined;
+                crypto.Sha3_256.hash(data[pos..][0..n], &digest, .{});
+                try out.put(digest, {});
+                pos += n;
+                count += 1;
+            }
+            return count;
+        }
+    };
+
+    var before = std.AutoHashMap([32]u8, void).init(allocator);
+    defer before.deinit();
+    const count = try Collect.chunks(&before, &gear, params, original);
+
+    var after = std.AutoHashMap([32]u8, void).init(allocator);
+    defer after.deinit();
+    _ = try Collect.chunks(&after, &gear, params, edited);
+
+    // Only the chunks around the edit change
+    var shared: usize = 0;
+    var it = after.keyIterator();
+    while (it.next()) |digest| {
+        if (before.contains(digest.*)) shared += 1;
+    }
+    try std.testing.expect(shared + 3 >= count);
+
+    // The streaming chunker cuts exactly where `cut` does
+    const path = "zig-cache/test-cdc.bin";
+    {
+        const file = try std.fs.cwd().createFile(path, .{});
+        defer file.close();
+        try file.writeAll(original);
+    }
+    defer std.fs.cwd().deleteFile(path) catch {};
+
+    const file = try std.fs.cwd().openFile(path, .{});
+    defer file.close();
+    var chunker = try Chunker.init(allocator, file, &gear, params);
+    defer chunker.deinit();
+
+    var buffer: [16384]u8 = undefined;
+    var pos: usize = 0;
+    while (true) {
+        const n = try chunker.next(&buffer);
+        if (n == 0) break;
+        try std.testing.expectEqual(cut(&gear, params, original[pos..]), n);
+        try std.testing.expectEqualSlices(u8, original[pos..][0..n], buffer[0..n]);
+        pos += n;
+    }
+    try std.testing.expectEqual(original.len, pos);
+}
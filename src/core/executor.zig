@@ -0,0 +1,261 @@
+//! Worker pool with a completion queue
+//!
+//! Runs submitted tasks on a fixed set of threads and queues each one as
+//! it finishes, so a caller can keep thousands of operations outstanding
+//! without parking a thread per operation. Finished tasks are collected
+//! with `poll` (non-blocking) or `wait`.
+//!
+//! On Linux an eventfd is readable exactly while completions are queued,
+//! so the executor plugs into epoll/poll based event loops.
+//!
+//! Tasks are intrusive: embed a `Task` in the operation's own struct and
+//! recover it with `@fieldParentPtr` in `runFn`.
+//!
+//! ## Example
+//!
+//! ```zig
+//! const executor = try Executor.create(allocator, 8);
+//! defer executor.destroy();
+//!
+//! const id = executor.submit(&request.task);
+//!
+//! var done: [16]*Task = undefined;
+//! for (executor.wait(&done, null)) |task| handle(task);
+//! ```
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+/// One unit of work; embed it in the operation it runs
+pub const Task = struct {
+    /// Assigned by `submit`, starting at 1
+    id: u64 = 0,
+    /// Runs on a worker thread
+    runFn: *const fn (task: *Task) void,
+    next: ?*Task = null,
+};
+
+/// Intrusive FIFO of tasks
+const Queue = struct {
+    head: ?*Task = null,
+    tail: ?*Task = null,
+
+    fn push(self: *Queue, task: *Task) void {
+        task.next = null;
+        if (self.tail) |tail| tail.next = task else self.head = task;
+        self.tail = task;
+    }
+
+    fn pop(self: *Queue) ?*Task {
+        const task = self.head orelse return null;
+        self.head = task.next;
+        if (self.head == null) self.tail = null;
+        task.next = null;
+        return task;
+    }
+};
+
+pub const Executor = struct {
+    allocator: std.mem.Allocator,
+    threads: []std.Thread,
+
+    mutex: std.Thread.Mutex = .{},
+    /// Signalled when work is queued or the pool stops
+    work_cond: std.Thread.Condition = .{},
+    /// Signalled when a task completes
+    done_cond: std.Thread.Condition = .{},
+    pending: Queue = .{},
+    completed: Queue = .{},
+    /// Submitted tasks not yet completed
+    outstanding: usize = 0,
+    next_id: u64 = 1,
+    stopping: bool = false,
+    /// Readable while `completed` is non-empty (Linux only)
+    event_fd: ?std.posix.fd_t = null,
+
+    /// Start `thread_count` workers (0 = one per CPU)
+    ///
+    /// The executor is heap allocated because the workers point at it.
+    pub fn create(allocator: std.mem.Allocator, thread_count: usize) !*Executor {
+        const count = if (thread_count != 0) thread_count else std.Thread.getCpuCount() catch 1;
+
+        const self = try allocator.create(Executor);
+        errdefer allocator.destroy(self);
+
+        self.* = .{ .allocator = allocator, .threads = try allocator.alloc(std.Thread, count) };
+        errdefer allocator.free(self.threads);
+
+        if (comptime builtin.os.tag == .linux) {
+            const linux = std.os.linux;
+            self.event_fd = std.posix.eventfd(0, linux.EFD.CLOEXEC | linux.EFD.NONBLOCK) catch null;
+        }
+        errdefer if (self.event_fd) |fd| std.posix.close(fd);
+
+        var spawned: usize = 0;
+        errdefer {
+            self.stop();
+            for (self.threads[0..spawned]) |thread| thread.join();
+        }
+        while (spawned < count) : (spawned += 1) {
+            self.threads[spawned] = try std.Thread.spawn(.{}, workerLoop, .{self});
+        }
+
+        return self;
+    }
+
+    /// Wait for every submitted task, stop the workers and free the
+    /// executor. Completed tasks still queued are not touched; collect
+    /// them with `poll` first if they own memory (see `shutdown`).
+    pub fn destroy(self: *Executor) void {
+        self.shutdown();
+        if (self.event_fd) |fd| std.posix.close(fd);
+        self.allocator.free(self.threads);
+        self.allocator.destroy(self);
+    }
+
+    /// Run every submitted task to completion and stop the workers.
+    /// Afterwards `poll` returns the remaining completions.
+    pub fn shutdown(self: *Executor) void {
+        if (self.threads.len == 0) return;
+
+        self.stop();
+        for (self.threads) |thread| thread.join();
+        self.allocator.free(self.threads);
+        self.threads = &.{};
+    }
+
+    fn stop(self: *Executor) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        self.stopping = true;
+        self.work_cond.broadcast();
+    }
+
+    /// Queue a task and return its id
+    pub fn submit(self: *Executor, task: *Task) u64 {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        std.debug.assert(!self.stopping);
+        task.id = self.next_id;
+        self.next_id += 1;
+        self.outstanding += 1;
+        self.pending.push(task);
+        self.work_cond.signal();
+        return task.id;
+    }
+
+    /// Move up to `out.len` completed tasks into `out` without blocking
+    pub fn poll(self: *Executor, out: []*Task) []*Task {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        return self.takeCompleted(out);
+    }
+
+    /// Like `poll`, but block until at least one task has completed,
+    /// nothing is outstanding, or `timeout_ns` elapses (null = no limit)
+    pub fn wait(self: *Executor, out: []*Task, timeout_ns: ?u64) []*Task {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        var timer = std.time.Timer.start() catch null;
+        while (self.completed.head == null and self.outstanding > 0) {
+            const limit = timeout_ns orelse {
+                self.done_cond.wait(&self.mutex);
+                continue;
+            };
+            const elapsed = if (timer) |*t| t.read() else limit;
+            if (elapsed >= limit) break;
+            self.done_cond.timedWait(&self.mutex, limit - elapsed) catch {};
+        }
+
+        return self.takeCompleted(out);
+    }
+
+    /// File descriptor that is readable while completions are queued,
+    /// or null where eventfd is unavailable
+    pub fn fd(self: *const Executor) ?std.posix.fd_t {
+        return self.event_fd;
+    }
+
+    fn takeCompleted(self: *Executor, out: []*Task) []*Task {
+        var count: usize = 0;
+        while (count < out.len) : (count += 1) {
+            out[count] = self.completed.pop() orelse break;
+        }
+
+        // Drain the eventfd once the queue is empty
+        if (count > 0 and self.completed.head == null) {
+            if (self.event_fd) |event_fd| {
+                var value: u64 = undefined;
+                _ = std.posix.read(event_fd, std.mem.asBytes(&value)) catch {};
+            }
+        }
+        return out[0..count];
+    }
+
+    fn workerLoop(self: *Executor) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        while (true) {
+            const task = self.pending.pop() orelse {
+                if (self.stopping) return;
+                self.work_cond.wait(&self.mutex);
+                continue;
+            };
+
+            self.mutex.unlock();
+            task.runFn(task);
+            self.mutex.lock();
+
+            const was_empty = self.completed.head == null;
+            self.completed.push(task);
+            self.outstanding -= 1;
+            if (was_empty) {
+                if (self.event_fd) |event_fd| {
+                    _ = std.posix.write(event_fd, std.mem.asBytes(&@as(u64, 1))) catch {};
+                }
+            }
+            self.done_cond.broadcast();
+        }
+    }
+};
+
+test "executor runs tasks and queues completions" {
+    const allocator = std.testing.allocator;
+
+    const Job = struct {
+        task: Task = .{ .runFn = run },
+        input: u64,
+        output: u64 = 0,
+
+        fn run(task: *Task) void {
+            const job: *@This() = @fieldParentPtr("task", task);
+            job.output = job.input * 2;
+        }
+    };
+
+    const executor = try Executor.create(allocator, 3);
+    defer executor.destroy();
+
+    var jobs: [20]Job = undefined;
+    for (&jobs, 0..) |*job, i| {
+        job.* = .{ .input = i };
+        try std.testing.expectEqual(@as(u64, i + 1), executor.submit(&job.task));
+    }
+
+    var seen: usize = 0;
+    var done: [8]*Task = undefined;
+    while (seen < jobs.len) {
+        for (executor.wait(&done, null)) |task| {
+            const job: *Job = @fieldParentPtr("task", task);
+            try std.testing.expectEqual(job.input * 2, job.output);
+            seen += 1;
+        }
+    }
+
+    // Nothing outstanding: wait returns at once
+    try std.testing.expectEqual(@as(usize, 0), executor.wait(&done, null).len);
+    try std.testing.expectEqual(@as(usize, 0), executor.poll(&done).len);
+}
@@ -10,6 +10,10 @@
 //! - **Created timestamp** - Unix timestamp
 //! - **Version** - Protocol version (0x01)
 //!
+//! The secret keys are also kept decoded (`signing_key`, `kem_key`) once
+//! an identity is generated or loaded, so signing and decapsulation don't
+//! re-parse them on every operation.
+//!
 //! ## Example
 //!
 //! ```zig
@@ -44,6 +48,10 @@ pub const Identity = struct {
     created_at: i64,
     /// Protocol version
     version: u8,
+    /// Decoded ML-DSA-65 secret key; null until `expandKeys`
+    signing_key: ?crypto.MLDSA65.SecretKey = null,
+    /// Decoded ML-KEM-768 secret key; null until `expandKeys`
+    kem_key: ?crypto.MLKem768.SecretKey = null,
 
     /// Generate a new random identity with both ML-DSA and ML-KEM keys
     pub fn generate() Identity {
@@ -57,6 +65,8 @@ pub const Identity = struct {
             .kem_secret_key = kem_keypair.secret_key.toBytes(),
             .created_at = 0, // TODO: Use std.time.Instant when we add time support
             .version = 0x01,
+            .signing_key = dsa_keypair.secret_key,
+            .kem_key = kem_keypair.secret_key,
         };
     }
 
@@ -79,9 +89,39 @@ pub const Identity = struct {
             .kem_secret_key = kem_keypair.secret_key.toBytes(),
             .created_at = 0, // TODO: Use std.time.Instant when we add time support
             .version = 0x01,
+            .signing_key = dsa_keypair.secret_key,
+            .kem_key = kem_keypair.secret_key,
         };
     }
 
+    /// Decode both secret keys and keep them for later operations
+    pub fn expandKeys(self: *Identity) !void {
+        self.signing_key = try crypto.MLDSA65.SecretKey.fromBytes(self.secret_key);
+        self.kem_key = try crypto.MLKem768.SecretKey.fromBytes(&self.kem_secret_key);
+    }
+
+    /// ML-DSA-65 secret key for signing, decoded only if not cached
+    pub fn signingKey(self: *const Identity) !crypto.MLDSA65.SecretKey {
+        if (self.signing_key) |key| return key;
+        return crypto.MLDSA65.SecretKey.fromBytes(self.secret_key);
+    }
+
+    /// ML-KEM-768 secret key for decapsulation, decoded only if not cached
+    pub fn kemSecretKey(self: *const Identity) !crypto.MLKem768.SecretKey {
+        if (self.kem_key) |key| return key;
+        return crypto.MLKem768.SecretKey.fromBytes(&self.kem_secret_key);
+    }
+
+    /// Zero both secret keys, encoded and decoded
+    pub fn wipe(self: *Identity) void {
+        std.crypto.secureZero(u8, &self.secret_key);
+        std.crypto.secureZero(u8, &self.kem_secret_key);
+        if (self.signing_key) |*key| std.crypto.secureZero(u8, std.mem.asBytes(key));
+        if (self.kem_key) |*key| std.crypto.secureZero(u8, std.mem.asBytes(key));
+        self.signing_key = null;
+        self.kem_key = null;
+    }
+
     /// Save identity to file
     pub fn save(self: *const Identity, path: []const u8) !void {
         const file = try std.fs.cwd().createFile(path, .{});
@@ -128,6 +168,11 @@ pub const Identity = struct {
         _ = try file.read(&ts_bytes);
         identity.created_at = std.mem.readInt(i64, &ts_bytes, .little);
 
+        // Decode once up front; a malformed key still fails at first use
+        identity.signing_key = null;
+        identity.kem_key = null;
+        identity.expandKeys() catch {};
+
         return identity;
     }
 };
@@ -169,6 +214,10 @@ test "identity save and load" {
     try std.testing.expectEqualSlices(u8, &identity.secret_key, &loaded.secret_key);
     try std.testing.expectEqual(identity.created_at, loaded.created_at);
 
+    // Loaded identities come with decoded keys that match the stored bytes
+    try std.testing.expect(loaded.signing_key != null and loaded.kem_key != null);
+    try std.testing.expectEqualSlices(u8, &identity.secret_key, &(try loaded.signingKey()).toBytes());
+
     _ = allocator;
 }
 
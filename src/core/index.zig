@@ -0,0 +1,354 @@
+//! Encrypted file index for Zault
+//!
+//! Caches the listing fields of every file's metadata block in
+//! `<vault>/index.db`, so listing a vault reads one small file instead of
+//! decrypting every block in the store.
+//!
+//! ## Format
+//!
+//! ```
+//! "ZAULTIX1"
+//! record*   len(4) nonce(12) ciphertext(len)
+//! ```
+//!
+//! Each record is encrypted on its own with a key derived from the vault
+//! master key, so appends never rewrite earlier records. Plaintext:
+//!
+//! ```
+//! op(1) hash(32)                                          op = remove
+//! op(1) hash(32) size(8) created(8) name_len(4) name
+//!       mime_len(4) mime                                  op = add
+//! ```
+//!
+//! ## Recovery
+//!
+//! The index is a cache of data already held in metadata blocks. A torn
+//! trailing record is truncated on open; anything else that fails to
+//! decrypt or parse (corruption, a different identity) marks the index for
+//! a rebuild from the block store.
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+const encryptData = @import("block.zig").encryptData;
+const decryptData = @import("block.zig").decryptData;
+
+/// Hash type for metadata block addresses
+pub const BlockHash = [crypto.Sha3_256.digest_length]u8;
+
+const index_magic = "ZAULTIX1";
+const nonce_length = crypto.ChaCha20Poly1305.nonce_length;
+const record_header_length = 4 + nonce_length;
+
+const Op = enum(u8) {
+    add = 0x01,
+    remove = 0x02,
+};
+
+/// Listing fields for one file
+pub const Entry = struct {
+    /// Metadata block hash
+    hash: BlockHash,
+    filename: []const u8,
+    size: u64,
+    mime_type: []const u8,
+    created: i64,
+};
+
+/// In-memory view of `index.db`, appended to as files are added
+pub const FileIndex = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    key: [32]u8,
+    /// Entries in insertion order; strings are owned
+    entries: std.ArrayList(Entry),
+    /// Position of each hash in `entries`
+    positions: std.AutoHashMap(BlockHash, usize),
+    /// Set when the file was missing or unreadable and is now empty
+    needs_rebuild: bool = false,
+
+    /// Open or create the index under `vault_path`
+    pub fn open(allocator: std.mem.Allocator, vault_path: []const u8, master_key: [32]u8) !FileIndex {
+        const path = try std.fmt.allocPrint(allocator, "{s}/index.db", .{vault_path});
+        defer allocator.free(path);
+
+        var created = false;
+        const file = std.fs.cwd().openFile(path, .{ .mode = .read_write }) catch |err| switch (err) {
+            error.FileNotFound => blk: {
+                created = true;
+                break :blk try std.fs.cwd().createFile(path, .{ .read = true, .exclusive = true });
+            },
+            else => return err,
+        };
+        errdefer file.close();
+
+        var self = FileIndex{
+            .allocator = allocator,
+            .file = file,
+            .key = deriveIndexKey(master_key),
+            .entries = std.ArrayList(Entry){},
+            .positions = std.AutoHashMap(BlockHash, usize).init(allocator),
+        };
+        errdefer self.clearEntries();
+
+        if (created) {
+            try self.reset();
+        } else {
+            self.load() catch |err| switch (err) {
+                error.InvalidIndex => try self.reset(),
+                else => return err,
+            };
+        }
+
+        return self;
+    }
+
+    /// Close the file and free all entries
+    pub fn deinit(self: *FileIndex) void {
+        self.clearEntries();
+        self.file.close();
+        std.crypto.secureZero(u8, &self.key);
+    }
+
+    fn clearEntries(self: *FileIndex) void {
+        for (self.entries.items) |entry| freeEntry(self.allocator, entry);
+        self.entries.deinit(self.allocator);
+        self.positions.deinit();
+    }
+
+    /// Index key, separate from the metadata key
+    fn deriveIndexKey(master_key: [32]u8) [32]u8 {
+        const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &master_key);
+
+        var key: [32]u8 = undefined;
+        crypto.HkdfSha3_256.expand(&key, "zault-file-index-v1", prk);
+        return key;
+    }
+
+    /// Drop every entry and truncate the file to its header.
+    /// Sets `needs_rebuild` until the caller repopulates the index.
+    pub fn reset(self: *FileIndex) !void {
+        for (self.entries.items) |entry| freeEntry(self.allocator, entry);
+        self.entries.clearRetainingCapacity();
+        self.positions.clearRetainingCapacity();
+
+        try self.file.setEndPos(0);
+        try self.file.pwriteAll(index_magic, 0);
+        try self.file.seekTo(index_magic.len);
+        self.needs_rebuild = true;
+    }
+
+    /// Replay every record into memory
+    fn load(self: *FileIndex) !void {
+        const size = (try self.file.stat()).size;
+        if (size < index_magic.len) return error.InvalidIndex;
+
+        const bytes = try self.allocator.alloc(u8, size);
+        defer self.allocator.free(bytes);
+        if (try self.file.preadAll(bytes, 0) != size) return error.InvalidIndex;
+
+        if (!std.mem.eql(u8, bytes[0..index_magic.len], index_magic)) return error.InvalidIndex;
+
+        var pos: usize = index_magic.len;
+        while (bytes.len - pos >= record_header_length) {
+            const len = std.mem.readInt(u32, bytes[pos..][0..4], .little);
+            const nonce = bytes[pos + 4 ..][0..nonce_length].*;
+            const body_start = pos + record_header_length;
+            if (bytes.len - body_start < len) break; // Torn tail
+
+            const plaintext = decryptData(bytes[body_start..][0..len], self.key, nonce, self.allocator) catch
+                return error.InvalidIndex;
+            defer self.allocator.free(plaintext);
+
+            try self.apply(plaintext);
+            pos = body_start + len;
+        }
+
+        // Truncate a partial record so the next append starts cleanly
+        if (pos != size) try self.file.setEndPos(pos);
+        try self.file.seekTo(pos);
+    }
+
+    /// Apply one decrypted record to the in-memory entries
+    fn apply(self: *FileIndex, record: []const u8) !void {
+        if (record.len < 1 + 32) return error.InvalidIndex;
+        const hash = record[1..33].*;
+
+        switch (record[0]) {
+            @intFromEnum(Op.remove) => self.forget(hash),
+            @intFromEnum(Op.add) => {
+                var pos: usize = 33;
+                if (record.len - pos < 8 + 8 + 4) return error.InvalidIndex;
+                const size = std.mem.readInt(u64, record[pos..][0..8], .little);
+                pos += 8;
+                const created = std.mem.readInt(i64, record[pos..][0..8], .little);
+                pos += 8;
+
+                const name_len = std.mem.readInt(u32, record[pos..][0..4], .little);
+                pos += 4;
+                if (record.len - pos < @as(usize, name_len) + 4) return error.InvalidIndex;
+                const filename = record[pos..][0..name_len];
+                pos += name_len;
+
+                const mime_len = std.mem.readInt(u32, record[pos..][0..4], .little);
+                pos += 4;
+                if (record.len - pos != mime_len) return error.InvalidIndex;
+                const mime_type = record[pos..][0..mime_len];
+
+                try self.remember(.{
+                    .hash = hash,
+                    .filename = filename,
+                    .size = size,
+                    .mime_type = mime_type,
+                    .created = created,
+                });
+            },
+            else => return error.InvalidIndex,
+        }
+    }
+
+    /// Record a file. Hashes already in the index are skipped.
+    pub fn put(self: *FileIndex, entry: Entry) !void {
+        if (self.positions.contains(entry.hash)) return;
+
+        var record = std.ArrayList(u8){};
+        defer record.deinit(self.allocator);
+
+        try record.append(self.allocator, @intFromEnum(Op.add));
+        try record.appendSlice(self.allocator, &entry.hash);
+
+        var u64_bytes: [8]u8 = undefined;
+        std.mem.writeInt(u64, &u64_bytes, entry.size, .little);
+        try record.appendSlice(self.allocator, &u64_bytes);
+        std.mem.writeInt(i64, &u64_bytes, entry.created, .little);
+        try record.appendSlice(self.allocator, &u64_bytes);
+
+        var len_bytes: [4]u8 = undefined;
+        std.mem.writeInt(u32, &len_bytes, @intCast(entry.filename.len), .little);
+        try record.appendSlice(self.allocator, &len_bytes);
+        try record.appendSlice(self.allocator, entry.filename);
+        std.mem.writeInt(u32, &len_bytes, @intCast(entry.mime_type.len), .little);
+        try record.appendSlice(self.allocator, &len_bytes);
+        try record.appendSlice(self.allocator, entry.mime_type);
+
+        try self.appendRecord(record.items);
+        try self.remember(entry);
+    }
+
+    /// Drop a file from the index
+    pub fn remove(self: *FileIndex, hash: BlockHash) !void {
+        if (!self.positions.contains(hash)) return;
+
+        var record: [1 + 32]u8 = undefined;
+        record[0] = @intFromEnum(Op.remove);
+        @memcpy(record[1..], &hash);
+
+        try self.appendRecord(&record);
+        self.forget(hash);
+    }
+
+    /// Encrypt and append one record
+    fn appendRecord(self: *FileIndex, plaintext: []const u8) !void {
+        var nonce: [nonce_length]u8 = undefined;
+        crypto.random.bytes(&nonce);
+
+        const ciphertext = try encryptData(plaintext, self.key, nonce, self.allocator);
+        defer self.allocator.free(ciphertext);
+
+        var header: [record_header_length]u8 = undefined;
+        std.mem.writeInt(u32, header[0..4], @intCast(ciphertext.len), .little);
+        @memcpy(header[4..], &nonce);
+
+        try self.file.writeAll(&header);
+        try self.file.writeAll(ciphertext);
+    }
+
+    /// Add an entry in memory, copying its strings
+    fn remember(self: *FileIndex, entry: Entry) !void {
+        const slot = try self.positions.getOrPut(entry.hash);
+        if (slot.found_existing) return;
+        errdefer self.positions.removeByPtr(slot.key_ptr);
+
+        const filename = try self.allocator.dupe(u8, entry.filename);
+        errdefer self.allocator.free(filename);
+        const mime_type = try self.allocator.dupe(u8, entry.mime_type);
+        errdefer self.allocator.free(mime_type);
+
+        slot.value_ptr.* = self.entries.items.len;
+        try self.entries.append(self.allocator, .{
+            .hash = entry.hash,
+            .filename = filename,
+            .size = entry.size,
+            .mime_type = mime_type,
+            .created = entry.created,
+        });
+    }
+
+    /// Remove an entry from memory
+    fn forget(self: *FileIndex, hash: BlockHash) void {
+        const removed = self.positions.fetchRemove(hash) orelse return;
+        const position = removed.value;
+
+        freeEntry(self.allocator, self.entries.items[position]);
+        _ = self.entries.swapRemove(position);
+        if (position < self.entries.items.len) {
+            self.positions.getPtr(self.entries.items[position].hash).?.* = position;
+        }
+    }
+
+    fn freeEntry(allocator: std.mem.Allocator, entry: Entry) void {
+        allocator.free(entry.filename);
+        allocator.free(entry.mime_type);
+    }
+};
+
+test "file index persists across reopen" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-file-index";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    try std.fs.cwd().makePath(test_dir);
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const master_key = [_]u8{0x42} ** 32;
+
+    {
+        var index = try FileIndex.open(allocator, test_dir, master_key);
+        defer index.deinit();
+        try std.testing.expect(index.needs_rebuild);
+
+        try index.put(.{ .hash = [_]u8{1} ** 32, .filename = "a.txt", .size = 10, .mime_type = "text/plain", .created = 0 });
+        try index.put(.{ .hash = [_]u8{2} ** 32, .filename = "b.pdf", .size = 20, .mime_type = "application/pdf", .created = 0 });
+        try index.put(.{ .hash = [_]u8{3} ** 32, .filename = "c.bin", .size = 30, .mime_type = "application/octet-stream", .created = 0 });
+        try index.put(.{ .hash = [_]u8{1} ** 32, .filename = "dup", .size = 0, .mime_type = "", .created = 0 });
+        try index.remove([_]u8{1} ** 32);
+    }
+
+    {
+        var index = try FileIndex.open(allocator, test_dir, master_key);
+        defer index.deinit();
+        try std.testing.expect(!index.needs_rebuild);
+
+        try std.testing.expectEqual(@as(usize, 2), index.entries.items.len);
+        const position = index.positions.get([_]u8{2} ** 32).?;
+        try std.testing.expectEqualStrings("b.pdf", index.entries.items[position].filename);
+        try std.testing.expectEqual(@as(u64, 20), index.entries.items[position].size);
+
+        // Simulate a crash halfway through an append
+        try index.file.writeAll(&[_]u8{ 0xFF, 0x00, 0x00 });
+    }
+
+    {
+        var index = try FileIndex.open(allocator, test_dir, master_key);
+        defer index.deinit();
+        try std.testing.expect(!index.needs_rebuild);
+        try std.testing.expectEqual(@as(usize, 2), index.entries.items.len);
+    }
+
+    // A different key cannot read the index and starts over
+    {
+        var index = try FileIndex.open(allocator, test_dir, [_]u8{0x43} ** 32);
+        defer index.deinit();
+        try std.testing.expect(index.needs_rebuild);
+        try std.testing.expectEqual(@as(usize, 0), index.entries.items.len);
+    }
+}
@@ -0,0 +1,843 @@
+//! Chunk ingest pipeline for Zault
+//!
+//! Turns a stream of plaintext into signed, encrypted content blocks.
+//! Each chunk is encrypted (ChaCha20-Poly1305), signed (ML-DSA-65) and
+//! hashed (SHA3-256) independently, so with more than one thread the work
+//! runs as a three-stage pipeline:
+//!
+//! ```
+//! reader (caller thread) ──▶ N sealing workers ──▶ writer (in chunk order)
+//! ```
+//!
+//! Chunks move through a fixed ring of slots, so memory use is bounded by
+//! `2 * threads` chunk buffers no matter how large the input is. The
+//! writer is the only stage that touches the block store.
+//!
+//! ## Dedup mode
+//!
+//! With `Job.chunking` the reader cuts content-defined chunks (see
+//! `cdc.zig`) instead of fixed-size ones, and with `Job.convergence_key`
+//! each chunk is encrypted under a key derived from its own plaintext.
+//! Signing is deterministic, so a chunk seen before seals to the same
+//! block, and the writer skips blocks the store already holds.
+//!
+//! `Job.reuse` maps the chunk keys of an earlier version of the file to
+//! their blocks. A chunk whose key is already there is neither encrypted,
+//! signed nor written, so updating a file only costs a read and a hash of
+//! the unchanged parts.
+//!
+//! ## Batch signing
+//!
+//! With `Job.signature_batch`, workers only encrypt and hash; chunks are
+//! written as batch-signed blocks (see `batch.zig`) and the writer signs
+//! one batch root per `signature_batch` chunks. The ring then holds a
+//! full batch on top of two slots per worker, and a serial ingest keeps
+//! a batch of chunks in memory before storing them.
+//!
+//! ## Example
+//!
+//! ```zig
+//! var out = ingest.Output{};
+//! defer out.deinit(allocator);
+//!
+//! const size = try ingest.run(allocator, file, &store, .{
+//!     .content_key = key,
+//!     .content_nonce = nonce,
+//!     .author = &identity.public_key,
+//!     .signing_key = &signing_key,
+//!     .chunk_size = manifest.default_chunk_size,
+//! }, 8, &out);
+//! ```
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+const cdc = @import("cdc.zig");
+const batch = @import("batch.zig");
+const BlockBuilder = @import("block.zig").BlockBuilder;
+const batched_version = @import("block.zig").batched_version;
+const batchProof = @import("block.zig").batchProof;
+const serializedLength = @import("block.zig").serializedLength;
+const serializedLengthFor = @import("block.zig").serializedLengthFor;
+const encryptDataInto = @import("block.zig").encryptDataInto;
+const BlockStore = @import("store.zig").BlockStore;
+const BlockHash = @import("store.zig").BlockHash;
+const manifest = @import("manifest.zig");
+const ChunkKey = manifest.ChunkKey;
+
+const tag_length = crypto.ChaCha20Poly1305.tag_length;
+
+/// Everything needed to seal the chunks of one file
+pub const Job = struct {
+    content_key: [32]u8,
+    /// Base nonce; chunk `i` uses `manifest.chunkNonce(content_nonce, i)`
+    content_nonce: [12]u8,
+    author: *const [crypto.MLDSA65.PublicKey.encoded_length]u8,
+    /// Decoded once and shared read-only by every worker
+    signing_key: *const crypto.MLDSA65.SecretKey,
+    /// Block format; `block.compact_version` names the author by fingerprint
+    block_version: u8 = 0x01,
+    /// Plaintext bytes per chunk, at least 1; with `chunking`, at least
+    /// its `max_size`
+    chunk_size: usize,
+    /// Cut content-defined chunks instead of `chunk_size` pieces
+    chunking: ?Chunking = null,
+    /// Encrypt each chunk under `convergentKey(convergence_key, chunk)`
+    /// instead of `content_key`, and skip chunks already stored
+    convergence_key: ?[32]u8 = null,
+    /// Blocks of a previous version by chunk key, with `convergence_key`;
+    /// matching chunks reuse the block instead of being sealed again
+    reuse: ?*const std.AutoHashMap(ChunkKey, BlockHash) = null,
+    /// Chunks signed together under one batch root, at most
+    /// `batch.max_leaves`; 0 signs every chunk
+    signature_batch: u16 = 0,
+};
+
+/// Content-defined chunking settings
+pub const Chunking = struct {
+    gear: *const cdc.Gear,
+    params: cdc.Params,
+};
+
+/// Chunks sealed by `run`
+pub const Output = struct {
+    /// Content block hashes, in file order
+    chunks: std.ArrayList(BlockHash) = .{},
+    /// Key of each chunk, only with `Job.convergence_key`
+    keys: std.ArrayList(ChunkKey) = .{},
+    /// Chunks that were already stored (or repeated earlier in the same
+    /// file) and not written again, and their serialized size
+    duplicate_chunks: u64 = 0,
+    duplicate_bytes: u64 = 0,
+    /// Chunks taken unchanged from `Job.reuse`, without sealing them
+    reused_chunks: u64 = 0,
+    /// Batch root blocks written, one signature each
+    batch_roots: u64 = 0,
+
+    pub fn deinit(self: *Output, allocator: std.mem.Allocator) void {
+        self.chunks.deinit(allocator);
+        self.keys.deinit(allocator);
+    }
+};
+
+/// Key for a chunk in dedup mode: identical plaintext under the same
+/// vault always gets the same key, and nothing else can derive it
+pub fn convergentKey(convergence_key: [32]u8, plaintext: []const u8) ChunkKey {
+    var digest: [crypto.Sha3_256.digest_length]u8 = undefined;
+    crypto.Sha3_256.hash(plaintext, &digest, .{});
+
+    var key: ChunkKey = undefined;
+    crypto.HmacSha3_256.create(&key, &digest, &convergence_key);
+    return key;
+}
+
+/// Resolve a thread-count knob: 0 means one thread per CPU
+pub fn resolveThreads(threads: usize) usize {
+    if (threads != 0) return threads;
+    return std.Thread.getCpuCount() catch 1;
+}
+
+/// Read `reader` to EOF, storing one content block per chunk.
+/// Chunks are appended to `out` in file order.
+/// Returns the total plaintext size.
+///
+/// With `threads > 1`, `allocator` must be thread-safe.
+pub fn run(
+    allocator: std.mem.Allocator,
+    reader: std.fs.File,
+    store: *BlockStore,
+    job: Job,
+    threads: usize,
+    out: *Output,
+) !u64 {
+    if (job.signature_batch > batch.max_leaves) return error.InvalidBatchSize;
+    // Empty reads would never reach EOF
+    if (job.chunk_size == 0) return error.InvalidChunkSize;
+
+    var chunker: ?cdc.Chunker = null;
+    if (job.chunking) |chunking| {
+        std.debug.assert(job.chunk_size >= chunking.params.max_size);
+        chunker = try cdc.Chunker.init(allocator, reader, chunking.gear, chunking.params);
+    }
+    defer if (chunker) |*open_chunker| open_chunker.deinit();
+
+    var source = Source{ .file = reader, .chunker = if (chunker) |*open_chunker| open_chunker else null };
+
+    if (threads <= 1) return runSerial(allocator, &source, store, job, out);
+
+    var pipeline = try Pipeline.init(allocator, store, job, threads, out);
+    defer pipeline.deinit();
+
+    return try pipeline.run(&source);
+}
+
+/// Plaintext of successive chunks: fixed-size reads or content-defined cuts
+const Source = struct {
+    file: std.fs.File,
+    chunker: ?*cdc.Chunker,
+    /// The last chunk has been handed out
+    done: bool = false,
+
+    /// Fill the front of `buffer` with the next chunk; 0 at end of input
+    fn next(self: *Source, buffer: []u8) !usize {
+        if (self.done) return 0;
+        if (self.chunker) |chunker| {
+            const n = try chunker.next(buffer);
+            self.done = n == 0 or (chunker.eof and chunker.start == chunker.end);
+            return n;
+        }
+
+        const n = try self.file.readAll(buffer);
+        if (n < buffer.len) self.done = true;
+        return n;
+    }
+};
+
+/// Single-threaded ingest: read, seal and store one chunk at a time,
+/// or one batch at a time when batch signing
+fn runSerial(
+    allocator: std.mem.Allocator,
+    source: *Source,
+    store: *BlockStore,
+    job: Job,
+    out: *Output,
+) !u64 {
+    const slots = try allocator.alloc(Slot, @max(1, job.signature_batch));
+    defer allocator.free(slots);
+
+    var initialized: usize = 0;
+    defer for (slots[0..initialized]) |*slot| slot.deinit(allocator);
+    while (initialized < slots.len) : (initialized += 1) {
+        slots[initialized] = try Slot.init(allocator, job.chunk_size);
+    }
+
+    var writer = try Writer.init(allocator, &job, slots.len);
+    defer writer.deinit(allocator);
+
+    var total_size: u64 = 0;
+    var count: usize = 0;
+    while (true) {
+        const slot = &slots[count];
+        const n = try source.next(slot.plaintext);
+        if (n > 0) {
+            slot.index = out.chunks.items.len + count;
+            slot.len = n;
+            try slot.seal(&job);
+            count += 1;
+            total_size += n;
+        }
+
+        const last = n == 0 or source.done;
+        if (count == slots.len or (last and count > 0)) {
+            try writer.write(allocator, store, &job, slots, 0, count, out);
+            count = 0;
+        }
+        if (last) break;
+    }
+
+    return total_size;
+}
+
+/// Writer-stage scratch, shared by the serial and pipelined paths
+const Writer = struct {
+    /// One store entry, block image and key per slot
+    entries: []BlockStore.Entry,
+    images: [][]u8,
+    keys: []ChunkKey,
+    /// Signs batch roots, with `Job.signature_batch`
+    signer: ?*batch.Signer = null,
+
+    fn init(allocator: std.mem.Allocator, job: *const Job, capacity: usize) !Writer {
+        const entries = try allocator.alloc(BlockStore.Entry, capacity);
+        errdefer allocator.free(entries);
+        const images = try allocator.alloc([]u8, capacity);
+        errdefer allocator.free(images);
+        const keys = try allocator.alloc(ChunkKey, capacity);
+        errdefer allocator.free(keys);
+
+        var writer = Writer{ .entries = entries, .images = images, .keys = keys };
+        if (job.signature_batch > 0) {
+            const signer = try allocator.create(batch.Signer);
+            signer.* = .{};
+            writer.signer = signer;
+        }
+        return writer;
+    }
+
+    fn deinit(self: *Writer, allocator: std.mem.Allocator) void {
+        allocator.free(self.entries);
+        allocator.free(self.images);
+        allocator.free(self.keys);
+        if (self.signer) |signer| allocator.destroy(signer);
+    }
+
+    /// Store `count` sealed slots of `ring`, starting at sequence number
+    /// `first`, and record them in `out`
+    fn write(
+        self: *Writer,
+        allocator: std.mem.Allocator,
+        store: *BlockStore,
+        job: *const Job,
+        ring: []Slot,
+        first: u64,
+        count: usize,
+        out: *Output,
+    ) !void {
+        const entries = self.entries[0..count];
+        const images = self.images[0..count];
+        const keys = self.keys[0..count];
+        for (entries, images, keys, 0..) |*entry, *image, *key, i| {
+            const slot = &ring[(first + i) % ring.len];
+            entry.* = .{ .hash = slot.hash, .bytes = slot.sealed() };
+            image.* = slot.image[0..slot.sealed_len];
+            key.* = slot.key;
+        }
+
+        try storeChunks(allocator, store, job, entries, images, keys, self.signer, out);
+    }
+};
+
+/// Store sealed chunks and record them in `out`
+///
+/// In dedup mode, chunks the store already holds or repeated earlier in
+/// the batch are counted but not written, and reused chunks (no bytes)
+/// are only recorded. With `signer`, the chunks written are batch-signed
+/// first. `entries` and `images` are reordered.
+fn storeChunks(
+    allocator: std.mem.Allocator,
+    store: *BlockStore,
+    job: *const Job,
+    entries: []BlockStore.Entry,
+    images: [][]u8,
+    keys: []const ChunkKey,
+    signer: ?*batch.Signer,
+    out: *Output,
+) !void {
+    try out.chunks.ensureUnusedCapacity(allocator, entries.len);
+    for (entries) |entry| out.chunks.appendAssumeCapacity(entry.hash);
+
+    var fresh: usize = entries.len;
+    if (job.convergence_key != null) {
+        try out.keys.appendSlice(allocator, keys);
+
+        fresh = 0;
+        for (entries, images) |entry, image| {
+            if (entry.bytes.len == 0) {
+                out.reused_chunks += 1;
+                continue;
+            }
+
+            const repeated = for (entries[0..fresh]) |kept| {
+                if (std.mem.eql(u8, &kept.hash, &entry.hash)) break true;
+            } else false;
+
+            if (repeated or try store.has(entry.hash)) {
+                out.duplicate_chunks += 1;
+                out.duplicate_bytes += entry.bytes.len;
+                continue;
+            }
+            entries[fresh] = entry;
+            images[fresh] = image;
+            fresh += 1;
+        }
+    }
+    if (fresh == 0) return;
+
+    if (signer) |batch_signer| {
+        try signBatch(batch_signer, store, job, entries[0..fresh], images[0..fresh]);
+        out.batch_roots += 1;
+    }
+    try store.putMany(entries[0..fresh]);
+}
+
+/// Sign batch-signed chunks under one root: write each chunk's proof into
+/// its image and store the root block ahead of the chunks
+fn signBatch(
+    signer: *batch.Signer,
+    store: *BlockStore,
+    job: *const Job,
+    entries: []const BlockStore.Entry,
+    images: []const []u8,
+) !void {
+    var hashes: [batch.max_leaves]BlockHash = undefined;
+    var proofs: [batch.max_leaves]*[batch.proof_length]u8 = undefined;
+    for (entries, images, 0..) |entry, image, i| {
+        hashes[i] = entry.hash;
+        proofs[i] = batchProof(image);
+    }
+
+    const root = try signer.sign(job.author, job.signing_key, job.block_version, hashes[0..entries.len], proofs[0..entries.len]);
+    try store.putBytes(root.hash, root.bytes);
+}
+
+/// One chunk in flight
+const Slot = struct {
+    state: State = .free,
+    /// Chunk index within the file
+    index: u64 = 0,
+    /// Plaintext bytes in this chunk
+    len: usize = 0,
+    plaintext: []u8,
+    /// Serialized block, sized for a full chunk
+    image: []u8,
+    /// Hash of the sealed block
+    hash: BlockHash = undefined,
+    /// Bytes of `image` used by the sealed block
+    sealed_len: usize = 0,
+    /// Convergent key, in dedup mode
+    key: ChunkKey = undefined,
+    /// `hash` came from `Job.reuse`; nothing was sealed
+    reused: bool = false,
+
+    const State = enum { free, filled, sealed };
+
+    fn init(allocator: std.mem.Allocator, chunk_size: usize) !Slot {
+        const plaintext = try allocator.alloc(u8, chunk_size);
+        errdefer allocator.free(plaintext);
+
+        // Sized for a version 1 block; compact blocks use less of it
+        const image = try allocator.alloc(u8, serializedLength(chunk_size + tag_length));
+
+        return Slot{ .plaintext = plaintext, .image = image };
+    }
+
+    fn deinit(self: *Slot, allocator: std.mem.Allocator) void {
+        allocator.free(self.plaintext);
+        allocator.free(self.image);
+    }
+
+    /// Serialized bytes of the sealed block; empty when reused
+    fn sealed(self: *const Slot) []const u8 {
+        if (self.reused) return &.{};
+        return self.image[0..self.sealed_len];
+    }
+
+    /// Encrypt the plaintext straight into the block image, then sign and
+    /// hash it in one pass (only hash it when batch signing)
+    fn seal(self: *Slot, job: *const Job) !void {
+        const plaintext = self.plaintext[0..self.len];
+
+        self.reused = false;
+
+        var key = job.content_key;
+        var nonce = manifest.chunkNonce(job.content_nonce, self.index);
+        if (job.convergence_key) |convergence_key| {
+            self.key = convergentKey(convergence_key, plaintext);
+            key = self.key;
+            nonce = manifest.convergent_nonce;
+
+            if (job.reuse) |reuse| {
+                if (reuse.get(self.key)) |hash| {
+                    self.hash = hash;
+                    self.reused = true;
+                    return;
+                }
+            }
+        }
+
+        // Batch-signed chunks are only hashed here; the writer signs
+        const version = if (job.signature_batch > 0) batched_version else job.block_version;
+        self.sealed_len = serializedLengthFor(version, self.len + tag_length);
+        var builder = BlockBuilder.init(self.image[0..self.sealed_len], .{
+            .version = version,
+            .block_type = .content,
+            .author = job.author,
+            .nonce = nonce,
+        });
+        encryptDataInto(builder.payload(), plaintext, key, nonce);
+
+        self.hash = if (job.signature_batch > 0) builder.digest() else try builder.seal(job.signing_key);
+    }
+};
+
+/// Shared state of a multi-threaded ingest
+///
+/// All counters are sequence numbers; chunk `seq` lives in
+/// `slots[seq % slots.len]`. Invariant: next_write <= next_seal <= next_fill.
+const Pipeline = struct {
+    allocator: std.mem.Allocator,
+    store: *BlockStore,
+    job: Job,
+    workers: usize,
+    out: *Output,
+    slots: []Slot,
+    writer: Writer,
+
+    mutex: std.Thread.Mutex = .{},
+    cond: std.Thread.Condition = .{},
+    next_fill: u64 = 0,
+    next_seal: u64 = 0,
+    next_write: u64 = 0,
+    eof: bool = false,
+    failure: ?anyerror = null,
+
+    fn init(
+        allocator: std.mem.Allocator,
+        store: *BlockStore,
+        job: Job,
+        workers: usize,
+        out: *Output,
+    ) !Pipeline {
+        // Two slots per worker keeps workers busy while the writer drains,
+        // plus room for the writer to hold back one signature batch
+        const slots = try allocator.alloc(Slot, workers * 2 + job.signature_batch);
+        errdefer allocator.free(slots);
+
+        var initialized: usize = 0;
+        errdefer for (slots[0..initialized]) |*slot| slot.deinit(allocator);
+        while (initialized < slots.len) : (initialized += 1) {
+            slots[initialized] = try Slot.init(allocator, job.chunk_size);
+        }
+
+        const writer = try Writer.init(allocator, &job, slots.len);
+
+        return Pipeline{
+            .allocator = allocator,
+            .store = store,
+            .job = job,
+            .workers = workers,
+            .out = out,
+            .slots = slots,
+            .writer = writer,
+        };
+    }
+
+    fn deinit(self: *Pipeline) void {
+        for (self.slots) |*slot| slot.deinit(self.allocator);
+        self.allocator.free(self.slots);
+        self.writer.deinit(self.allocator);
+    }
+
+    /// Record the first error and wake every stage so they can exit
+    fn fail(self: *Pipeline, err: anyerror) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        if (self.failure == null) self.failure = err;
+        self.cond.broadcast();
+    }
+
+    fn run(self: *Pipeline, source: *Source) !u64 {
+        const threads = try self.allocator.alloc(std.Thread, self.workers + 1);
+        defer self.allocator.free(threads);
+
+        // Spawn writer and workers; on failure, stop the ones already running
+        var spawned: usize = 0;
+        defer for (threads[0..spawned]) |thread| thread.join();
+
+        threads[0] = std.Thread.spawn(.{}, writerLoop, .{self}) catch |err| {
+            self.fail(err);
+            return err;
+        };
+        spawned = 1;
+        while (spawned < threads.len) : (spawned += 1) {
+            threads[spawned] = std.Thread.spawn(.{}, workerLoop, .{self}) catch |err| {
+                self.fail(err);
+                return err;
+            };
+        }
+
+        const total_size = self.readerLoop(source) catch |err| {
+            self.fail(err);
+            return err;
+        };
+
+        // Wait for the writer to drain, then surface any stage failure
+        for (threads[0..spawned]) |thread| thread.join();
+        spawned = 0;
+
+        if (self.failure) |err| return err;
+        return total_size;
+    }
+
+    /// Stage 1: fill free slots with plaintext, in order
+    fn readerLoop(self: *Pipeline, source: *Source) !u64 {
+        var total_size: u64 = 0;
+
+        while (true) {
+            const slot = blk: {
+                self.mutex.lock();
+                defer self.mutex.unlock();
+
+                const next = &self.slots[self.next_fill % self.slots.len];
+                while (next.state != .free and self.failure == null) self.cond.wait(&self.mutex);
+                if (self.failure != null) return total_size;
+                break :blk next;
+            };
+
+            const n = try source.next(slot.plaintext);
+
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            if (n > 0) {
+                slot.index = self.next_fill;
+                slot.len = n;
+                slot.state = .filled;
+                self.next_fill += 1;
+                total_size += n;
+            }
+            if (source.done) self.eof = true;
+            self.cond.broadcast();
+
+            if (self.eof) return total_size;
+        }
+    }
+
+    /// Stage 2: claim filled slots and seal them
+    fn workerLoop(self: *Pipeline) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        while (self.failure == null) {
+            if (self.next_seal < self.next_fill) {
+                const slot = &self.slots[self.next_seal % self.slots.len];
+                self.next_seal += 1;
+
+                self.mutex.unlock();
+                const result = slot.seal(&self.job);
+                self.mutex.lock();
+
+                result catch |err| {
+                    if (self.failure == null) self.failure = err;
+                };
+                slot.state = .sealed;
+                self.cond.broadcast();
+                continue;
+            }
+
+            if (self.eof) return;
+            self.cond.wait(&self.mutex);
+        }
+    }
+
+    /// Stage 3: store sealed blocks in chunk order and recycle their slots
+    ///
+    /// Every run of consecutive sealed slots goes to the store as one
+    /// `putMany`, so the writer batches naturally when it falls behind.
+    /// When batch signing, it waits for a full batch (or the last chunks).
+    fn writerLoop(self: *Pipeline) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const limit: usize = if (self.job.signature_batch > 0) self.job.signature_batch else self.slots.len;
+
+        while (self.failure == null) {
+            if (self.eof and self.next_write == self.next_fill) return;
+
+            var ready: usize = 0;
+            while (self.next_write + ready < self.next_fill and ready < limit) : (ready += 1) {
+                const slot = &self.slots[(self.next_write + ready) % self.slots.len];
+                if (slot.state != .sealed) break;
+            }
+
+            const complete = ready == limit or (self.eof and self.next_write + ready == self.next_fill);
+            if (ready == 0 or (self.job.signature_batch > 0 and !complete)) {
+                self.cond.wait(&self.mutex);
+                continue;
+            }
+
+            self.mutex.unlock();
+            const result = self.writer.write(self.allocator, self.store, &self.job, self.slots, self.next_write, ready, self.out);
+            self.mutex.lock();
+
+            result catch |err| {
+                if (self.failure == null) self.failure = err;
+            };
+            for (0..ready) |i| self.slots[(self.next_write + i) % self.slots.len].state = .free;
+            self.next_write += ready;
+            self.cond.broadcast();
+        }
+    }
+};
+
+test "parallel ingest matches serial chunk order" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const test_dir = "zig-cache/test-ingest";
+    var store = try BlockStore.init(allocator, test_dir);
+    defer store.deinit();
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+
+    const input_path = "zig-cache/test-ingest-input.bin";
+    var input: [4096 + 300]u8 = undefined;
+    crypto.random.bytes(&input);
+    {
+        const file = try std.fs.cwd().createFile(input_path, .{});
+        defer file.close();
+        try file.writeAll(&input);
+    }
+    defer std.fs.cwd().deleteFile(input_path) catch {};
+
+    const job = Job{
+        .content_key = [_]u8{0x42} ** 32,
+        .content_nonce = [_]u8{0x24} ** 12,
+        .author = &identity.public_key,
+        .signing_key = &signing_key,
+        .chunk_size = 512,
+    };
+
+    var serial = Output{};
+    defer serial.deinit(allocator);
+    {
+        const file = try std.fs.cwd().openFile(input_path, .{});
+        defer file.close();
+        const size = try run(allocator, file, &store, job, 1, &serial);
+        try std.testing.expectEqual(@as(u64, input.len), size);
+    }
+
+    var parallel = Output{};
+    defer parallel.deinit(allocator);
+    {
+        const file = try std.fs.cwd().openFile(input_path, .{});
+        defer file.close();
+        const size = try run(allocator, file, &store, job, 4, &parallel);
+        try std.testing.expectEqual(@as(u64, input.len), size);
+    }
+
+    // Deterministic signing: same job gives the same blocks in the same order
+    try std.testing.expectEqual(@as(usize, 9), parallel.chunks.items.len);
+    for (serial.chunks.items, parallel.chunks.items) |a, b| {
+        try std.testing.expectEqualSlices(u8, &a, &b);
+    }
+
+    // Zero-byte chunks are refused before any thread starts
+    var empty = job;
+    empty.chunk_size = 0;
+    var rejected = Output{};
+    defer rejected.deinit(allocator);
+    for ([_]usize{ 1, 4 }) |threads| {
+        const file = try std.fs.cwd().openFile(input_path, .{});
+        defer file.close();
+        try std.testing.expectError(error.InvalidChunkSize, run(allocator, file, &store, empty, threads, &rejected));
+    }
+}
+
+test "convergent ingest stores repeated chunks once" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+    const MemoryStore = @import("memstore.zig").MemoryStore;
+
+    var memory = MemoryStore.init(allocator);
+    var store = memory.blockStore();
+    defer store.deinit();
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+
+    // The same 64 KiB twice, so the second half repeats the first's chunks
+    const input_path = "zig-cache/test-ingest-dedup.bin";
+    const half = try allocator.alloc(u8, 64 * 1024);
+    defer allocator.free(half);
+    crypto.random.bytes(half);
+    {
+        const file = try std.fs.cwd().createFile(input_path, .{});
+        defer file.close();
+        try file.writeAll(half);
+        try file.writeAll(half);
+    }
+    defer std.fs.cwd().deleteFile(input_path) catch {};
+
+    const gear = cdc.Gear.fromKey([_]u8{0x33} ** 32);
+    const params = cdc.Params{ .min_size = 2048, .avg_size = 8192, .max_size = 32768 };
+
+    for ([_]usize{ 1, 3 }) |threads| {
+        var out = Output{};
+        defer out.deinit(allocator);
+
+        const file = try std.fs.cwd().openFile(input_path, .{});
+        defer file.close();
+        _ = try run(allocator, file, &store, .{
+            .content_key = [_]u8{0x42} ** 32,
+            .content_nonce = [_]u8{0x24} ** 12,
+            .author = &identity.public_key,
+            .signing_key = &signing_key,
+            .chunk_size = params.max_size,
+            .chunking = .{ .gear = &gear, .params = params },
+            .convergence_key = [_]u8{0x77} ** 32,
+        }, threads, &out);
+
+        try std.testing.expectEqual(out.chunks.items.len, out.keys.items.len);
+
+        // Every chunk of the second run (threads = 3) was already stored
+        const written = out.chunks.items.len - out.duplicate_chunks;
+        if (threads == 1) {
+            try std.testing.expect(written < out.chunks.items.len);
+        } else {
+            try std.testing.expectEqual(@as(usize, 0), written);
+        }
+    }
+}
+
+test "batch-signed ingest signs one root per batch" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+    const MemoryStore = @import("memstore.zig").MemoryStore;
+
+    var memory = MemoryStore.init(allocator);
+    var store = memory.blockStore();
+    defer store.deinit();
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+    const public_key = try crypto.MLDSA65.PublicKey.fromBytes(identity.public_key);
+
+    const input_path = "zig-cache/test-ingest-batch.bin";
+    var input: [4096 + 300]u8 = undefined;
+    crypto.random.bytes(&input);
+    {
+        const file = try std.fs.cwd().createFile(input_path, .{});
+        defer file.close();
+        try file.writeAll(&input);
+    }
+    defer std.fs.cwd().deleteFile(input_path) catch {};
+
+    const job = Job{
+        .content_key = [_]u8{0x42} ** 32,
+        .content_nonce = [_]u8{0x24} ** 12,
+        .author = &identity.public_key,
+        .signing_key = &signing_key,
+        .block_version = @import("block.zig").compact_version,
+        .chunk_size = 512,
+        .signature_batch = 4,
+    };
+
+    var serial = Output{};
+    defer serial.deinit(allocator);
+    for ([_]usize{ 1, 3 }) |threads| {
+        var out = Output{};
+        defer out.deinit(allocator);
+
+        const file = try std.fs.cwd().openFile(input_path, .{});
+        defer file.close();
+        _ = try run(allocator, file, &store, job, threads, &out);
+
+        // 9 chunks in batches of 4, 4 and 1
+        try std.testing.expectEqual(@as(usize, 9), out.chunks.items.len);
+        try std.testing.expectEqual(@as(u64, 3), out.batch_roots);
+
+        if (threads == 1) {
+            try serial.chunks.appendSlice(allocator, out.chunks.items);
+            continue;
+        }
+
+        // Unsigned chunks hash the same whichever thread sealed them
+        for (serial.chunks.items, out.chunks.items) |a, b| {
+            try std.testing.expectEqualSlices(u8, &a, &b);
+        }
+    }
+
+    // Every chunk checks out against its signed root; both runs wrote
+    // the same 9 chunks and 3 roots
+    try std.testing.expectEqual(@as(u32, 12), memory.blocks.count());
+    for (serial.chunks.items) |hash| {
+        var stored = try store.read(hash);
+        defer stored.deinit();
+
+        var root = try store.read(try batch.rootBlockOf(&stored.view));
+        defer root.deinit();
+        try root.view.verifyWith(public_key);
+        try batch.verifyInclusion(&stored.view, try batch.Root.parse(&root.view));
+    }
+}
@@ -0,0 +1,223 @@
+//! Registry of author keys, for compact blocks
+//!
+//! Compact blocks name their author by the SHA3-256 fingerprint of its
+//! ML-DSA-65 public key (`block.keyId`) instead of embedding the 1952-byte
+//! key. The registry maps fingerprints back to keys and is kept in
+//! `<vault>/keys.db`.
+//!
+//! ## Format
+//!
+//! ```
+//! "ZAULTKR1"
+//! key*      public key(1952)
+//! ```
+//!
+//! Entries need no MAC: each key is found by its own fingerprint, so a
+//! corrupted entry only stops matching. A torn trailing record is
+//! truncated on open.
+//!
+//! ## Example
+//!
+//! ```zig
+//! var registry = try KeyRegistry.open(allocator, vault_path);
+//! defer registry.deinit();
+//!
+//! _ = try registry.register(&sender_public_key);
+//! try registry.verify(&stored.view);
+//! ```
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+const block = @import("block.zig");
+const BlockView = block.BlockView;
+const Author = block.Author;
+
+pub const KeyId = block.KeyId;
+pub const PublicKeyBytes = [crypto.MLDSA65.PublicKey.encoded_length]u8;
+
+const registry_magic = "ZAULTKR1";
+
+/// Author keys by fingerprint, optionally persisted
+pub const KeyRegistry = struct {
+    allocator: std.mem.Allocator,
+    /// `keys.db`; null for a registry kept only in memory
+    file: ?std.fs.File,
+    keys: std.AutoHashMap(KeyId, PublicKeyBytes),
+    /// Guards `keys` and appends to `file`
+    lock: std.Thread.RwLock = .{},
+
+    /// Registry that is not saved anywhere
+    pub fn init(allocator: std.mem.Allocator) KeyRegistry {
+        return KeyRegistry{
+            .allocator = allocator,
+            .file = null,
+            .keys = std.AutoHashMap(KeyId, PublicKeyBytes).init(allocator),
+        };
+    }
+
+    /// Open or create the registry under `vault_path`
+    pub fn open(allocator: std.mem.Allocator, vault_path: []const u8) !KeyRegistry {
+        const path = try std.fmt.allocPrint(allocator, "{s}/keys.db", .{vault_path});
+        defer allocator.free(path);
+
+        var created = false;
+        const file = std.fs.cwd().openFile(path, .{ .mode = .read_write }) catch |err| switch (err) {
+            error.FileNotFound => blk: {
+                created = true;
+                break :blk try std.fs.cwd().createFile(path, .{ .read = true, .exclusive = true });
+            },
+            else => return err,
+        };
+        errdefer file.close();
+
+        var self = init(allocator);
+        self.file = file;
+        errdefer self.keys.deinit();
+
+        if (created) {
+            try file.writeAll(registry_magic);
+        } else {
+            try self.load();
+        }
+
+        return self;
+    }
+
+    pub fn deinit(self: *KeyRegistry) void {
+        self.keys.deinit();
+        if (self.file) |file| file.close();
+    }
+
+    /// Read every key into memory
+    fn load(self: *KeyRegistry) !void {
+        const file = self.file.?;
+        const size = (try file.stat()).size;
+
+        const bytes = try self.allocator.alloc(u8, size);
+        defer self.allocator.free(bytes);
+        if (try file.preadAll(bytes, 0) != size) return error.InvalidRegistry;
+
+        if (size < registry_magic.len or !std.mem.eql(u8, bytes[0..registry_magic.len], registry_magic)) {
+            return error.InvalidRegistry;
+        }
+
+        const records = bytes[registry_magic.len..];
+        const count = records.len / @sizeOf(PublicKeyBytes);
+        try self.keys.ensureTotalCapacity(@intCast(count));
+
+        for (0..count) |i| {
+            const key = records[i * @sizeOf(PublicKeyBytes) ..][0..@sizeOf(PublicKeyBytes)];
+            self.keys.putAssumeCapacity(block.keyId(key), key.*);
+        }
+
+        // Truncate a partial record so the next append stays aligned
+        const end = registry_magic.len + count * @sizeOf(PublicKeyBytes);
+        if (end != size) try file.setEndPos(end);
+        try file.seekTo(end);
+    }
+
+    /// Add `key` if it is new; returns its fingerprint
+    pub fn register(self: *KeyRegistry, key: *const PublicKeyBytes) !KeyId {
+        const id = block.keyId(key);
+
+        {
+            self.lock.lockShared();
+            defer self.lock.unlockShared();
+            if (self.keys.contains(id)) return id;
+        }
+
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        const entry = try self.keys.getOrPut(id);
+        if (entry.found_existing) return id;
+        entry.value_ptr.* = key.*;
+
+        if (self.file) |file| {
+            errdefer self.keys.removeByPtr(entry.key_ptr);
+
+            // Cut a partial record back off so later keys stay aligned
+            const end = try file.getPos();
+            file.writeAll(key) catch |err| {
+                file.setEndPos(end) catch {};
+                file.seekTo(end) catch {};
+                return err;
+            };
+        }
+        return id;
+    }
+
+    /// Key with fingerprint `id`, if registered
+    pub fn get(self: *KeyRegistry, id: *const KeyId) ?PublicKeyBytes {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+        return self.keys.get(id.*);
+    }
+
+    /// Author key of a block, from the block itself or the registry
+    pub fn resolve(self: *KeyRegistry, author: Author) !PublicKeyBytes {
+        return switch (author) {
+            .key => |key| key.*,
+            .id => |id| self.get(id) orelse error.UnknownAuthor,
+        };
+    }
+
+    /// Verify a block's signature, resolving compact authors here
+    pub fn verify(self: *KeyRegistry, view: *const BlockView) !void {
+        switch (view.author) {
+            .key => try view.verify(self.allocator),
+            .id => |id| {
+                const key = self.get(id) orelse return error.UnknownAuthor;
+                try view.verifyWith(try crypto.MLDSA65.PublicKey.fromBytes(key));
+            },
+        }
+    }
+};
+
+test "key registry resolves compact authors and persists" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const test_dir = "zig-cache/test-key-registry";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    try std.fs.cwd().makePath(test_dir);
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const identity = Identity.generate();
+    const signing_key = try identity.signingKey();
+
+    var image: [block.serializedLengthFor(block.compact_version, 4)]u8 = undefined;
+    var builder = block.BlockBuilder.init(&image, .{
+        .version = block.compact_version,
+        .block_type = .content,
+        .author = &identity.public_key,
+        .nonce = [_]u8{1} ** 12,
+    });
+    @memcpy(builder.payload(), "data");
+    _ = try builder.seal(&signing_key);
+    const view = builder.view();
+
+    {
+        var registry = try KeyRegistry.open(allocator, test_dir);
+        defer registry.deinit();
+
+        try std.testing.expectError(error.UnknownAuthor, registry.verify(&view));
+        const id = try registry.register(&identity.public_key);
+        try std.testing.expectEqualSlices(u8, &id, &view.author.fingerprint());
+        _ = try registry.register(&identity.public_key);
+        try registry.verify(&view);
+    }
+
+    // Reopened, with a torn append: the key is still there, once
+    {
+        const file = try std.fs.cwd().openFile(test_dir ++ "/keys.db", .{ .mode = .read_write });
+        defer file.close();
+        try file.seekFromEnd(0);
+        try file.writeAll(&[_]u8{ 0xAA, 0xBB });
+    }
+    var registry = try KeyRegistry.open(allocator, test_dir);
+    defer registry.deinit();
+    try std.testing.expectEqual(@as(u32, 1), registry.keys.count());
+    try registry.verify(&view);
+    try std.testing.expectEqual(@as(u64, registry_magic.len + 1952), (try registry.file.?.stat()).size);
+}
@@ -0,0 +1,236 @@
+//! Chunk manifests for Zault
+//!
+//! Files are stored as a sequence of fixed-size encrypted chunks, each in
+//! its own content block. The manifest lists the chunk hashes in order and
+//! is itself stored as an encrypted `manifest` block.
+//!
+//! ## Layout
+//!
+//! ```
+//! metadata block ──▶ manifest block ──▶ chunk 0, chunk 1, ... chunk N-1
+//! ```
+//!
+//! ## Keys and Nonces
+//!
+//! All chunks of a file share the per-file `content_key`. The manifest is
+//! encrypted with `content_nonce` and chunk `i` with `chunkNonce(content_nonce, i)`,
+//! so no nonce is ever reused under the same key.
+//!
+//! Version 2 manifests (dedup mode) instead give every chunk its own
+//! convergent key, derived from the vault and the chunk plaintext, and
+//! list it next to the chunk hash. Each such key encrypts exactly one
+//! plaintext, under `convergent_nonce`, so identical chunks become
+//! identical blocks. The manifest itself is still encrypted with the
+//! file key, so a share recipient learns the chunk keys from it.
+//!
+//! ## Example
+//!
+//! ```zig
+//! const manifest = ChunkManifest{
+//!     .version = 0x01,
+//!     .chunk_size = default_chunk_size,
+//!     .total_size = 3 * 1024 * 1024,
+//!     .chunks = chunk_hashes,
+//! };
+//!
+//! const bytes = try manifest.serialize(allocator);
+//! defer allocator.free(bytes);
+//!
+//! var loaded = try ChunkManifest.deserialize(bytes, allocator);
+//! defer loaded.deinit(allocator);
+//! ```
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+
+/// Hash type for chunk block addresses
+pub const BlockHash = [crypto.Sha3_256.digest_length]u8;
+
+/// Default plaintext size of one chunk (1 MiB)
+pub const default_chunk_size: u32 = 1024 * 1024;
+
+/// Nonce for chunks under a convergent key (each key seals one plaintext)
+pub const convergent_nonce = [_]u8{0} ** crypto.ChaCha20Poly1305.nonce_length;
+
+/// Chunk encryption key
+pub const ChunkKey = [32]u8;
+
+/// Chunk manifest structure
+pub const ChunkManifest = struct {
+    version: u8,
+    /// Plaintext bytes per chunk (the last chunk may be shorter); with
+    /// per-chunk keys, the largest chunk
+    chunk_size: u32,
+    /// Total plaintext size of the file
+    total_size: u64,
+    /// Content block hashes, in file order
+    chunks: []const BlockHash,
+    /// Convergent key of each chunk (version 2); null when every chunk
+    /// uses the file key
+    keys: ?[]const ChunkKey = null,
+
+    /// Serialize manifest to bytes
+    pub fn serialize(self: *const ChunkManifest, allocator: std.mem.Allocator) ![]u8 {
+        var list = std.ArrayList(u8){};
+
+        // Version: 2 whenever chunks carry their own keys
+        if (self.keys) |keys| std.debug.assert(keys.len == self.chunks.len);
+        try list.append(allocator, if (self.keys != null) 0x02 else self.version);
+
+        // Chunk size
+        var u32_bytes: [4]u8 = undefined;
+        std.mem.writeInt(u32, &u32_bytes, self.chunk_size, .little);
+        try list.appendSlice(allocator, &u32_bytes);
+
+        // Total size
+        var size_bytes: [8]u8 = undefined;
+        std.mem.writeInt(u64, &size_bytes, self.total_size, .little);
+        try list.appendSlice(allocator, &size_bytes);
+
+        // Chunk count + hashes
+        std.mem.writeInt(u32, &u32_bytes, @intCast(self.chunks.len), .little);
+        try list.appendSlice(allocator, &u32_bytes);
+        for (self.chunks, 0..) |*hash, i| {
+            try list.appendSlice(allocator, hash);
+            if (self.keys) |keys| try list.appendSlice(allocator, &keys[i]);
+        }
+
+        return try list.toOwnedSlice(allocator);
+    }
+
+    /// Deserialize manifest from bytes
+    pub fn deserialize(bytes: []const u8, allocator: std.mem.Allocator) !ChunkManifest {
+        var pos: usize = 0;
+
+        // Version
+        if (pos + 1 > bytes.len) return error.InvalidManifest;
+        const version = bytes[pos];
+        pos += 1;
+
+        // Chunk size
+        if (pos + 4 > bytes.len) return error.InvalidManifest;
+        const chunk_size = std.mem.readInt(u32, bytes[pos..][0..4], .little);
+        pos += 4;
+
+        // Total size
+        if (pos + 8 > bytes.len) return error.InvalidManifest;
+        const total_size = std.mem.readInt(u64, bytes[pos..][0..8], .little);
+        pos += 8;
+
+        // Chunk hashes
+        if (pos + 4 > bytes.len) return error.InvalidManifest;
+        const chunk_count = std.mem.readInt(u32, bytes[pos..][0..4], .little);
+        pos += 4;
+
+        const keyed = version >= 0x02;
+        const entry_length: usize = if (keyed) 64 else 32;
+        if (bytes.len - pos < @as(usize, chunk_count) * entry_length) return error.InvalidManifest;
+
+        const chunks = try allocator.alloc(BlockHash, chunk_count);
+        errdefer allocator.free(chunks);
+        const keys = if (keyed) try allocator.alloc(ChunkKey, chunk_count) else null;
+
+        for (chunks, 0..) |*hash, i| {
+            @memcpy(hash, bytes[pos..][0..32]);
+            pos += 32;
+            if (keys) |chunk_keys| {
+                @memcpy(&chunk_keys[i], bytes[pos..][0..32]);
+                pos += 32;
+            }
+        }
+
+        return ChunkManifest{
+            .version = version,
+            .chunk_size = chunk_size,
+            .total_size = total_size,
+            .chunks = chunks,
+            .keys = keys,
+        };
+    }
+
+    /// Key and nonce for chunk `index`, given the file key and base nonce
+    pub fn chunkCipher(self: *const ChunkManifest, index: usize, content_key: [32]u8, content_nonce: [12]u8) struct { key: [32]u8, nonce: [12]u8 } {
+        if (self.keys) |keys| return .{ .key = keys[index], .nonce = convergent_nonce };
+        return .{ .key = content_key, .nonce = chunkNonce(content_nonce, index) };
+    }
+
+    /// Free allocated resources
+    pub fn deinit(self: *ChunkManifest, allocator: std.mem.Allocator) void {
+        allocator.free(self.chunks);
+        if (self.keys) |keys| allocator.free(keys);
+    }
+};
+
+/// Derive the nonce for chunk `index` from the file's base nonce.
+/// The base nonce itself is reserved for the manifest block.
+pub fn chunkNonce(base: [crypto.ChaCha20Poly1305.nonce_length]u8, index: u64) [crypto.ChaCha20Poly1305.nonce_length]u8 {
+    var nonce = base;
+    const counter = std.mem.readInt(u64, nonce[4..12], .little) ^ (index + 1);
+    std.mem.writeInt(u64, nonce[4..12], counter, .little);
+    return nonce;
+}
+
+test "manifest serialization round-trip" {
+    const allocator = std.testing.allocator;
+
+    const hashes = [_]BlockHash{ [_]u8{0x11} ** 32, [_]u8{0x22} ** 32, [_]u8{0x33} ** 32 };
+    const manifest = ChunkManifest{
+        .version = 0x01,
+        .chunk_size = default_chunk_size,
+        .total_size = 2 * default_chunk_size + 17,
+        .chunks = &hashes,
+    };
+
+    const bytes = try manifest.serialize(allocator);
+    defer allocator.free(bytes);
+
+    var deserialized = try ChunkManifest.deserialize(bytes, allocator);
+    defer deserialized.deinit(allocator);
+
+    try std.testing.expectEqual(manifest.chunk_size, deserialized.chunk_size);
+    try std.testing.expectEqual(manifest.total_size, deserialized.total_size);
+    try std.testing.expectEqual(@as(usize, 3), deserialized.chunks.len);
+    try std.testing.expectEqualSlices(u8, &hashes[2], &deserialized.chunks[2]);
+
+    // Truncated manifests are rejected
+    try std.testing.expectError(error.InvalidManifest, ChunkManifest.deserialize(bytes[0 .. bytes.len - 1], allocator));
+}
+
+test "manifest with per-chunk keys round-trips as version 2" {
+    const allocator = std.testing.allocator;
+
+    const hashes = [_]BlockHash{ [_]u8{0x11} ** 32, [_]u8{0x22} ** 32 };
+    const keys = [_]ChunkKey{ [_]u8{0xA1} ** 32, [_]u8{0xA2} ** 32 };
+    const manifest = ChunkManifest{
+        .version = 0x01,
+        .chunk_size = default_chunk_size,
+        .total_size = 70_000,
+        .chunks = &hashes,
+        .keys = &keys,
+    };
+
+    const bytes = try manifest.serialize(allocator);
+    defer allocator.free(bytes);
+    try std.testing.expectEqual(@as(u8, 0x02), bytes[0]);
+
+    var deserialized = try ChunkManifest.deserialize(bytes, allocator);
+    defer deserialized.deinit(allocator);
+
+    try std.testing.expectEqualSlices(u8, &keys[1], &deserialized.keys.?[1]);
+    const cipher = deserialized.chunkCipher(1, [_]u8{0} ** 32, [_]u8{0} ** 12);
+    try std.testing.expectEqualSlices(u8, &keys[1], &cipher.key);
+    try std.testing.expectEqualSlices(u8, &convergent_nonce, &cipher.nonce);
+
+    try std.testing.expectError(error.InvalidManifest, ChunkManifest.deserialize(bytes[0 .. bytes.len - 1], allocator));
+}
+
+test "chunk nonces are unique" {
+    const base = [_]u8{0x5A} ** 12;
+
+    const n0 = chunkNonce(base, 0);
+    const n1 = chunkNonce(base, 1);
+
+    try std.testing.expect(!std.mem.eql(u8, &base, &n0));
+    try std.testing.expect(!std.mem.eql(u8, &n0, &n1));
+    try std.testing.expectEqualSlices(u8, base[0..4], n0[0..4]);
+}
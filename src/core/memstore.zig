@@ -0,0 +1,161 @@
+//! In-memory block storage for Zault
+//!
+//! Keeps serialized blocks in a hash map. Useful for tests, for staging
+//! imports before they are committed, and as a baseline when comparing
+//! storage backends. Reads return views straight into the stored bytes.
+//!
+//! ## Example
+//!
+//! ```zig
+//! var memory = MemoryStore.init(allocator);
+//! var vault = try Vault.initWithStore(allocator, path, memory.blockStore());
+//! defer vault.deinit(); // Also frees every stored block
+//! ```
+
+const std = @import("std");
+const BlockView = @import("block.zig").BlockView;
+const BlockHeader = @import("block.zig").BlockHeader;
+const store = @import("store.zig");
+const BlockStore = store.BlockStore;
+const BlockHash = store.BlockHash;
+const StoredBlock = store.StoredBlock;
+const Error = store.Error;
+
+/// Hash map backed block store
+pub const MemoryStore = struct {
+    allocator: std.mem.Allocator,
+    /// Owned serialized blocks
+    blocks: std.AutoHashMap(BlockHash, []u8),
+    /// Guards `blocks`; readers share it
+    lock: std.Thread.RwLock = .{},
+
+    /// Create an empty store
+    pub fn init(allocator: std.mem.Allocator) MemoryStore {
+        return MemoryStore{
+            .allocator = allocator,
+            .blocks = std.AutoHashMap(BlockHash, []u8).init(allocator),
+        };
+    }
+
+    /// Free every stored block
+    pub fn deinit(self: *MemoryStore) void {
+        var it = self.blocks.valueIterator();
+        while (it.next()) |bytes| self.allocator.free(bytes.*);
+        self.blocks.deinit();
+    }
+
+    /// Interface handle; the caller keeps ownership of `self`
+    pub fn blockStore(self: *MemoryStore) BlockStore {
+        return BlockStore.implement(MemoryStore, self, self.allocator);
+    }
+
+    /// Store a copy of a serialized block
+    pub fn putBytes(self: *MemoryStore, hash: BlockHash, bytes: []const u8) Error!void {
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        const entry = try self.blocks.getOrPut(hash);
+        if (entry.found_existing) return;
+
+        entry.value_ptr.* = self.allocator.dupe(u8, bytes) catch |err| {
+            self.blocks.removeByPtr(entry.key_ptr);
+            return err;
+        };
+    }
+
+    /// View a stored block in place; valid until it is deleted
+    pub fn read(self: *MemoryStore, hash: BlockHash) Error!StoredBlock {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+
+        const bytes = self.blocks.get(hash) orelse return Error.NotFound;
+
+        return StoredBlock{
+            .view = try BlockView.parse(bytes),
+            .backing = .borrowed,
+        };
+    }
+
+    /// Parse the header of a stored block
+    pub fn readHeader(self: *MemoryStore, hash: BlockHash) Error!BlockHeader {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+
+        const bytes = self.blocks.get(hash) orelse return Error.NotFound;
+        return BlockHeader.parse(bytes);
+    }
+
+    /// Check if a block exists
+    pub fn has(self: *MemoryStore, hash: BlockHash) Error!bool {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+        return self.blocks.contains(hash);
+    }
+
+    /// Remove and free a block
+    pub fn delete(self: *MemoryStore, hash: BlockHash) Error!void {
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        const removed = self.blocks.fetchRemove(hash) orelse return Error.NotFound;
+        self.allocator.free(removed.value);
+    }
+
+    /// Append every stored hash to `out`
+    pub fn list(self: *MemoryStore, allocator: std.mem.Allocator, out: *std.ArrayList(BlockHash)) Error!void {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+
+        try out.ensureUnusedCapacity(allocator, self.blocks.count());
+
+        var it = self.blocks.keyIterator();
+        while (it.next()) |hash| out.appendAssumeCapacity(hash.*);
+    }
+};
+
+test "memory store through the BlockStore interface" {
+    const allocator = std.testing.allocator;
+    const crypto = @import("crypto.zig");
+    const Block = @import("block.zig").Block;
+    const Identity = @import("identity.zig").Identity;
+
+    var memory = MemoryStore.init(allocator);
+    var blocks = memory.blockStore();
+    defer blocks.deinit();
+
+    const identity = Identity.generate();
+
+    var block = Block{
+        .version = 0x01,
+        .block_type = .content,
+        .timestamp = 0,
+        .author = identity.public_key,
+        .data = "in memory",
+        .nonce = [_]u8{3} ** crypto.ChaCha20Poly1305.nonce_length,
+        .signature = undefined,
+        .prev_hash = [_]u8{0} ** 32,
+        .hash = undefined,
+    };
+    try block.sign(&identity.secret_key, allocator);
+    block.hash = block.computeHash();
+
+    try blocks.put(block.hash, &block);
+    try std.testing.expect(try blocks.has(block.hash));
+
+    var stored = try blocks.read(block.hash);
+    defer stored.deinit();
+    try std.testing.expectEqualStrings("in memory", stored.view.data);
+    try stored.view.verify(allocator);
+
+    // Batch read falls back to per-block reads
+    var batch: [1]StoredBlock = undefined;
+    try blocks.readMany(&.{block.hash}, &batch);
+    batch[0].deinit();
+
+    var hashes = try blocks.list(allocator);
+    defer hashes.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 1), hashes.items.len);
+
+    try blocks.delete(block.hash);
+    try std.testing.expect(!try blocks.has(block.hash));
+}
@@ -0,0 +1,176 @@
+//! Hot-path counters and latency histograms
+//!
+//! Compiled in with `zig build -Dmetrics=true`. Each instrumented stage
+//! (signing, verification, KEM, AEAD, hashing, store I/O, fsync) counts
+//! calls, bytes and nanoseconds, and sorts each call into a power-of-two
+//! latency bucket. Everything is a relaxed atomic, so recording costs two
+//! clock reads and a few uncontended atomic adds, and any thread can take
+//! a `snapshot` at any time.
+//!
+//! Without the option, `start` returns an empty span and every call
+//! compiles away.
+//!
+//! ## Example
+//!
+//! ```zig
+//! const span = metrics.start(.sign);
+//! defer span.end(payload.len);
+//!
+//! const totals = metrics.snapshot();
+//! std.debug.print("{d} signatures\n", .{totals.stages[@intFromEnum(Stage.sign)].count});
+//! ```
+
+const std = @import("std");
+const build_options = @import("build_options");
+
+/// Whether metrics are compiled in (`-Dmetrics`)
+pub const enabled = build_options.metrics;
+
+/// Instrumented operations; the order is part of the C ABI
+pub const Stage = enum(u8) {
+    /// ML-DSA-65 signature (block sealing, `zault_sign`)
+    sign,
+    /// ML-DSA-65 verification
+    verify,
+    /// ML-KEM-768 encapsulation (shares, messages)
+    encaps,
+    /// ML-KEM-768 decapsulation
+    decaps,
+    /// ChaCha20-Poly1305 encryption
+    aead_seal,
+    /// ChaCha20-Poly1305 decryption
+    aead_open,
+    /// SHA3-256 of a whole block, or of `zault_sha3_256` input
+    sha3,
+    /// Block reads, single or batched, through `BlockStore`
+    store_read,
+    /// Block writes, single or batched, through `BlockStore`
+    store_write,
+    /// fsync of block data, indexes and directories
+    fsync,
+};
+
+pub const stage_count = @typeInfo(Stage).@"enum".fields.len;
+
+/// Bucket `i` counts calls taking [2^i, 2^(i+1)) ns; bucket 0 also takes
+/// 0 ns, and the last bucket everything from 2^31 ns (about 2 s) up
+pub const bucket_count = 32;
+
+/// Totals for one stage
+pub const StageSnapshot = struct {
+    count: u64 = 0,
+    total_ns: u64 = 0,
+    bytes: u64 = 0,
+    buckets: [bucket_count]u64 = [_]u64{0} ** bucket_count,
+};
+
+/// Totals for every stage, indexed by `Stage`
+pub const Snapshot = struct {
+    stages: [stage_count]StageSnapshot = [_]StageSnapshot{.{}} ** stage_count,
+};
+
+const Counter = std.atomic.Value(u64);
+
+const StageCounters = struct {
+    count: Counter = Counter.init(0),
+    total_ns: Counter = Counter.init(0),
+    bytes: Counter = Counter.init(0),
+    buckets: [bucket_count]Counter = [_]Counter{Counter.init(0)} ** bucket_count,
+};
+
+var counters: [stage_count]StageCounters = [_]StageCounters{.{}} ** stage_count;
+
+/// A timed call in progress; finish it with `end`
+pub const Span = if (enabled) struct {
+    stage: Stage,
+    /// Null where no monotonic clock is available
+    started: ?std.time.Instant,
+
+    /// Record the call, with the bytes it processed
+    pub fn end(self: @This(), bytes: usize) void {
+        const started = self.started orelse return;
+        const now = std.time.Instant.now() catch return;
+        record(self.stage, now.since(started), bytes);
+    }
+} else struct {
+    pub inline fn end(_: @This(), _: usize) void {}
+};
+
+/// Start timing a call of `stage`
+pub inline fn start(stage: Stage) Span {
+    if (comptime !enabled) return .{};
+    return .{ .stage = stage, .started = std.time.Instant.now() catch null };
+}
+
+/// Add one call of `elapsed_ns` to `stage`
+pub fn record(stage: Stage, elapsed_ns: u64, bytes: usize) void {
+    if (comptime !enabled) return;
+
+    const stage_counters = &counters[@intFromEnum(stage)];
+    _ = stage_counters.count.fetchAdd(1, .monotonic);
+    _ = stage_counters.total_ns.fetchAdd(elapsed_ns, .monotonic);
+    _ = stage_counters.bytes.fetchAdd(bytes, .monotonic);
+    _ = stage_counters.buckets[bucketOf(elapsed_ns)].fetchAdd(1, .monotonic);
+}
+
+fn bucketOf(elapsed_ns: u64) usize {
+    if (elapsed_ns == 0) return 0;
+    return @min(std.math.log2_int(u64, elapsed_ns), bucket_count - 1);
+}
+
+/// Read every counter. Counters are read one by one while other threads
+/// may record, so a stage's fields can be a few calls apart.
+pub fn snapshot() Snapshot {
+    var out = Snapshot{};
+    if (comptime !enabled) return out;
+
+    for (&out.stages, &counters) |*stage, *stage_counters| {
+        stage.count = stage_counters.count.load(.monotonic);
+        stage.total_ns = stage_counters.total_ns.load(.monotonic);
+        stage.bytes = stage_counters.bytes.load(.monotonic);
+        for (&stage.buckets, &stage_counters.buckets) |*bucket, *counter| {
+            bucket.* = counter.load(.monotonic);
+        }
+    }
+    return out;
+}
+
+/// Zero every counter
+pub fn reset() void {
+    if (comptime !enabled) return;
+
+    for (&counters) |*stage_counters| {
+        stage_counters.count.store(0, .monotonic);
+        stage_counters.total_ns.store(0, .monotonic);
+        stage_counters.bytes.store(0, .monotonic);
+        for (&stage_counters.buckets) |*counter| counter.store(0, .monotonic);
+    }
+}
+
+test "metrics record into log2 buckets" {
+    try std.testing.expectEqual(@as(usize, 0), bucketOf(0));
+    try std.testing.expectEqual(@as(usize, 0), bucketOf(1));
+    try std.testing.expectEqual(@as(usize, 10), bucketOf(1024));
+    try std.testing.expectEqual(@as(usize, 10), bucketOf(2047));
+    try std.testing.expectEqual(@as(usize, bucket_count - 1), bucketOf(std.math.maxInt(u64)));
+
+    reset();
+    record(.sha3, 1500, 4096);
+    const span = start(.sha3);
+    span.end(10);
+
+    const after = snapshot().stages[@intFromEnum(Stage.sha3)];
+    if (!enabled) {
+        // Compiled out: nothing is ever counted
+        try std.testing.expectEqual(@as(u64, 0), after.count);
+        return;
+    }
+
+    try std.testing.expectEqual(@as(u64, 2), after.count);
+    try std.testing.expectEqual(@as(u64, 4106), after.bytes);
+    try std.testing.expect(after.buckets[10] >= 1);
+    try std.testing.expect(after.total_ns >= 1500);
+
+    reset();
+    try std.testing.expectEqual(@as(u64, 0), snapshot().stages[@intFromEnum(Stage.sha3)].count);
+}
@@ -0,0 +1,877 @@
+//! Pack-file block storage for Zault
+//!
+//! Stores serialized blocks back to back in large append-only pack files
+//! instead of one file per block. An append-only index maps each block
+//! hash to its location and is loaded into memory when the store opens.
+//!
+//! ## Layout
+//!
+//! ```
+//! <base>/packs/pack-000000.pack   serialized blocks, concatenated
+//! <base>/packs/pack-000001.pack   started once the previous one is full
+//! <base>/packs/index              "ZAULTPK1" + 48-byte records
+//! ```
+//!
+//! Index record: hash(32) pack(4) offset(8) len(4), little-endian.
+//! A record with pack = 0xFFFFFFFF is a deletion tombstone; the space it
+//! frees in the pack is not reclaimed.
+//!
+//! ## Crash Safety
+//!
+//! A block is appended to its pack before its index record is written, so
+//! a process that dies mid-put leaves at most unreferenced pack bytes and
+//! a torn trailing index record. Both are ignored when the store is
+//! reopened.
+//!
+//! A power loss is only covered with `durable`, which syncs the packs
+//! before the index. Without it the kernel may write the index first, so
+//! opening the store stops reading the index at the first record whose
+//! block lies past the end of its pack and truncates the rest: the most
+//! recent puts and deletes are lost, but every record left points at
+//! bytes that exist.
+//!
+//! ## Loose Fallback
+//!
+//! If the store root still has a `blocks/` directory from the loose layout,
+//! reads, listing and deletes fall back to it, so a partly migrated store
+//! stays fully readable.
+//!
+//! ## Concurrency
+//!
+//! A store may be shared between threads. Lookups take `lock` shared only
+//! long enough to find a block's pack and offset, so reads proceed in
+//! parallel; appends are serialized by `write_mutex` and take `lock`
+//! exclusively only to publish their index entries once the data is on disk.
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+const Block = @import("block.zig").Block;
+const BlockView = @import("block.zig").BlockView;
+const BlockHeader = @import("block.zig").BlockHeader;
+const header_length = @import("block.zig").header_length;
+const Ring = @import("uring.zig").Ring;
+const store = @import("store.zig");
+const BlockStore = store.BlockStore;
+const LooseStore = store.LooseStore;
+const BlockHash = store.BlockHash;
+const StoredBlock = store.StoredBlock;
+const Error = store.Error;
+const syncFile = store.syncFile;
+
+const index_magic = "ZAULTPK1";
+const index_record_length = 32 + 4 + 8 + 4;
+const tombstone_pack = std.math.maxInt(u32);
+
+/// Packs are closed to new blocks once they reach this size (256 MiB)
+pub const default_max_pack_size: u64 = 256 * 1024 * 1024;
+
+/// Append-only pack store
+pub const PackStore = struct {
+    allocator: std.mem.Allocator,
+    /// Owned path of the packs directory
+    dir_path: []u8,
+    /// Guarded by `lock`
+    index: std.AutoHashMap(BlockHash, Location),
+    /// Open pack files, in pack-number order; the last one takes appends.
+    /// Guarded by `lock`; files stay open until `deinit`.
+    packs: std.ArrayList(std.fs.File),
+    /// Guarded by `write_mutex`
+    index_file: std.fs.File,
+    /// Append offset in the last pack; guarded by `write_mutex`
+    active_size: u64,
+    /// Protects `index` and `packs`
+    lock: std.Thread.RwLock = .{},
+    /// Serializes appends and deletes
+    write_mutex: std.Thread.Mutex = .{},
+    max_pack_size: u64 = default_max_pack_size,
+    /// Map blocks of at least this many bytes on read
+    mmap_threshold: usize = store.default_mmap_threshold,
+    /// Loose blocks not yet migrated, if a `blocks/` directory exists
+    fallback: ?LooseStore = null,
+    /// Sync the active pack and the index after every put
+    durable: bool = false,
+    /// io_uring for batch reads and writes; see `setIoQueueDepth`
+    ring: ?Ring = null,
+    /// Serializes use of `ring`, whose submission queue is not thread safe
+    ring_mutex: std.Thread.Mutex = .{},
+
+    /// Where a block lives
+    pub const Location = struct {
+        pack: u32,
+        offset: u64,
+        len: u32,
+    };
+
+    /// Whether `base_path` already holds a pack store
+    pub fn exists(base_path: []const u8) bool {
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const index_path = std.fmt.bufPrint(&path_buf, "{s}/packs/index", .{base_path}) catch return false;
+        std.fs.cwd().access(index_path, .{}) catch return false;
+        return true;
+    }
+
+    /// Open the pack store under `base_path`, creating it if needed
+    pub fn open(allocator: std.mem.Allocator, base_path: []const u8) Error!PackStore {
+        const dir_path = try std.fmt.allocPrint(allocator, "{s}/packs", .{base_path});
+        errdefer allocator.free(dir_path);
+
+        std.fs.cwd().makePath(dir_path) catch |err| switch (err) {
+            error.PathAlreadyExists => {},
+            else => return Error.StorageFailure,
+        };
+
+        var self = PackStore{
+            .allocator = allocator,
+            .dir_path = dir_path,
+            .index = std.AutoHashMap(BlockHash, Location).init(allocator),
+            .packs = std.ArrayList(std.fs.File){},
+            .index_file = undefined,
+            .active_size = 0,
+        };
+        errdefer {
+            for (self.packs.items) |file| file.close();
+            self.packs.deinit(allocator);
+            self.index.deinit();
+        }
+
+        try self.openPacks();
+        try self.loadIndex();
+
+        if (LooseStore.exists(base_path)) {
+            self.fallback = try LooseStore.init(allocator, base_path);
+        }
+
+        return self;
+    }
+
+    /// Close all files and free the index
+    pub fn deinit(self: *PackStore) void {
+        if (self.ring) |*ring| ring.deinit();
+        if (self.fallback) |*loose| loose.deinit();
+        self.index_file.close();
+        for (self.packs.items) |file| file.close();
+        self.packs.deinit(self.allocator);
+        self.index.deinit();
+        self.allocator.free(self.dir_path);
+    }
+
+    /// Interface handle; the caller keeps ownership of `self`
+    pub fn blockStore(self: *PackStore) BlockStore {
+        return BlockStore.implement(PackStore, self, self.allocator);
+    }
+
+    fn packPath(self: *PackStore, buf: []u8, number: usize) ![]u8 {
+        return std.fmt.bufPrint(buf, "{s}/pack-{d:0>6}.pack", .{ self.dir_path, number }) catch return Error.InvalidPath;
+    }
+
+    /// Open existing packs in order, or create the first one
+    fn openPacks(self: *PackStore) Error!void {
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+
+        while (true) {
+            const path = try self.packPath(&path_buf, self.packs.items.len);
+            const file = std.fs.cwd().openFile(path, .{ .mode = .read_write }) catch |err| switch (err) {
+                error.FileNotFound => break,
+                else => return err,
+            };
+            errdefer file.close();
+            try self.packs.append(self.allocator, file);
+        }
+
+        if (self.packs.items.len == 0) return self.startPack();
+
+        self.active_size = (try self.packs.items[self.packs.items.len - 1].stat()).size;
+    }
+
+    /// Create the next pack file and make it the append target
+    fn startPack(self: *PackStore) Error!void {
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const path = try self.packPath(&path_buf, self.packs.items.len);
+
+        const file = try std.fs.cwd().createFile(path, .{ .read = true, .exclusive = true });
+        errdefer file.close();
+
+        self.lock.lock();
+        defer self.lock.unlock();
+        try self.packs.append(self.allocator, file);
+        self.active_size = 0;
+    }
+
+    /// Load index records into memory, dropping a torn trailing record
+    fn loadIndex(self: *PackStore) Error!void {
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const path = std.fmt.bufPrint(&path_buf, "{s}/index", .{self.dir_path}) catch return Error.InvalidPath;
+
+        self.index_file = std.fs.cwd().openFile(path, .{ .mode = .read_write }) catch |err| switch (err) {
+            error.FileNotFound => blk: {
+                const file = try std.fs.cwd().createFile(path, .{ .read = true, .exclusive = true });
+                try file.writeAll(index_magic);
+                break :blk file;
+            },
+            else => return err,
+        };
+        errdefer self.index_file.close();
+
+        const size = (try self.index_file.stat()).size;
+        var magic: [index_magic.len]u8 = undefined;
+        if (size < magic.len or try self.index_file.preadAll(&magic, 0) != magic.len or
+            !std.mem.eql(u8, &magic, index_magic))
+        {
+            return Error.StorageFailure;
+        }
+
+        const record_count = (size - magic.len) / index_record_length;
+        var end = magic.len + record_count * index_record_length;
+
+        const pack_sizes = try self.allocator.alloc(u64, self.packs.items.len);
+        defer self.allocator.free(pack_sizes);
+        for (self.packs.items, pack_sizes) |pack, *pack_size| pack_size.* = (try pack.stat()).size;
+
+        var record: [index_record_length]u8 = undefined;
+        var pos: u64 = magic.len;
+        while (pos < end) : (pos += index_record_length) {
+            if (try self.index_file.preadAll(&record, pos) != record.len) return Error.StorageFailure;
+
+            const location = Location{
+                .pack = std.mem.readInt(u32, record[32..36], .little),
+                .offset = std.mem.readInt(u64, record[36..44], .little),
+                .len = std.mem.readInt(u32, record[44..48], .little),
+            };
+            if (location.pack == tombstone_pack) {
+                _ = self.index.remove(record[0..32].*);
+                continue;
+            }
+            if (location.pack >= self.packs.items.len) return Error.StorageFailure;
+
+            // The record reached the disk but its block did not; see
+            // Crash Safety. Later records are newer and go with it.
+            const pack_size = pack_sizes[location.pack];
+            if (location.offset > pack_size or pack_size - location.offset < location.len) {
+                end = pos;
+                break;
+            }
+
+            try self.index.put(record[0..32].*, location);
+        }
+
+        // Truncate a partial or lost tail so the next append stays aligned
+        if (end != size) try self.index_file.setEndPos(end);
+        try self.index_file.seekTo(end);
+    }
+
+    /// Append a serialized block. Blocks already present are skipped.
+    pub fn putBytes(self: *PackStore, hash: BlockHash, bytes: []const u8) Error!void {
+        return self.putMany(&.{.{ .hash = hash, .bytes = bytes }});
+    }
+
+    /// Append a batch of serialized blocks
+    ///
+    /// Blocks go to the packs through the io_uring if one is set up, or
+    /// else in vectored writes of consecutive blocks. Their index records
+    /// follow in one write, so a batch costs a few syscalls however many
+    /// blocks it holds. Blocks already present, or repeated within the
+    /// batch, are skipped. Readers see the batch only once it is written.
+    pub fn putMany(self: *PackStore, entries: []const BlockStore.Entry) Error!void {
+        self.write_mutex.lock();
+        defer self.write_mutex.unlock();
+
+        var records = std.ArrayList(u8){};
+        defer records.deinit(self.allocator);
+        try records.ensureTotalCapacity(self.allocator, entries.len * index_record_length);
+
+        var writes = std.ArrayList(Ring.Write){};
+        defer writes.deinit(self.allocator);
+        try writes.ensureTotalCapacity(self.allocator, entries.len);
+
+        // Hashes placed by this batch, to skip repeats within it
+        var placed = std.AutoHashMap(BlockHash, Location).init(self.allocator);
+        defer placed.deinit();
+        try placed.ensureTotalCapacity(@intCast(entries.len));
+
+        // Only appends change `packs`, and they are serialized by
+        // `write_mutex`, so it can be read here without `lock`
+        const first_pack = self.packs.items.len - 1;
+
+        // A failed batch leaves nothing visible; take back its pack space
+        // and any index bytes so the next append starts where this one did
+        const first_size = self.active_size;
+        const index_end = try self.index_file.getPos();
+        errdefer {
+            self.active_size = if (self.packs.items.len - 1 == first_pack) first_size else 0;
+            self.truncateIndex(index_end);
+        }
+
+        // Place every block first; packs are started as they fill
+        for (entries) |entry| {
+            if (placed.contains(entry.hash) or self.contains(entry.hash)) continue;
+
+            if (self.active_size > 0 and self.active_size + entry.bytes.len > self.max_pack_size) {
+                try self.startPack();
+            }
+
+            const location = Location{
+                .pack = @intCast(self.packs.items.len - 1),
+                .offset = self.active_size,
+                .len = @intCast(entry.bytes.len),
+            };
+            writes.appendAssumeCapacity(.{
+                .file = self.packs.items[location.pack],
+                .bytes = entry.bytes,
+                .offset = location.offset,
+            });
+            self.active_size += entry.bytes.len;
+
+            records.appendSliceAssumeCapacity(&encodeRecord(entry.hash, location));
+            placed.putAssumeCapacity(entry.hash, location);
+        }
+        if (placed.count() == 0) return;
+
+        // Reserve now so publishing below cannot fail after the index
+        // records are written; only this writer inserts
+        {
+            self.lock.lock();
+            defer self.lock.unlock();
+            try self.index.ensureUnusedCapacity(placed.count());
+        }
+
+        // Data first, then the index records that make it visible
+        try self.writeBlocks(writes.items);
+        if (self.durable) {
+            for (self.packs.items[first_pack..]) |pack| try syncFile(pack);
+        }
+
+        try self.index_file.writeAll(records.items);
+        if (self.durable) try syncFile(self.index_file);
+
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        var it = placed.iterator();
+        while (it.next()) |entry| self.index.putAssumeCapacity(entry.key_ptr.*, entry.value_ptr.*);
+    }
+
+    fn contains(self: *PackStore, hash: BlockHash) bool {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+        return self.index.contains(hash);
+    }
+
+    /// Pack file and location of a packed block, or null
+    fn locate(self: *PackStore, hash: BlockHash) ?struct { file: std.fs.File, location: Location } {
+        self.lock.lockShared();
+        defer self.lock.unlockShared();
+
+        const location = self.index.get(hash) orelse return null;
+        return .{ .file = self.packs.items[location.pack], .location = location };
+    }
+
+    /// Write placed blocks to their packs
+    fn writeBlocks(self: *PackStore, writes: []Ring.Write) Error!void {
+        if (self.ring) |*ring| {
+            self.ring_mutex.lock();
+            defer self.ring_mutex.unlock();
+            ring.writeAll(writes) catch return Error.StorageFailure;
+            return;
+        }
+
+        // Coalesce blocks that are adjacent in the same pack
+        var iovecs: [64]std.posix.iovec_const = undefined;
+        var start: usize = 0;
+        while (start < writes.len) {
+            const first = writes[start];
+            var offset = first.offset;
+            var count: usize = 0;
+            while (start + count < writes.len and count < iovecs.len) : (count += 1) {
+                const write = writes[start + count];
+                if (write.file.handle != first.file.handle or write.offset != offset) break;
+                iovecs[count] = .{ .base = write.bytes.ptr, .len = write.bytes.len };
+                offset += write.bytes.len;
+            }
+
+            try first.file.pwritevAll(iovecs[0..count], first.offset);
+            start += count;
+        }
+    }
+
+    fn encodeRecord(hash: BlockHash, location: Location) [index_record_length]u8 {
+        var record: [index_record_length]u8 = undefined;
+        @memcpy(record[0..32], &hash);
+        std.mem.writeInt(u32, record[32..36], location.pack, .little);
+        std.mem.writeInt(u64, record[36..44], location.offset, .little);
+        std.mem.writeInt(u32, record[44..48], location.len, .little);
+        return record;
+    }
+
+    fn appendRecord(self: *PackStore, hash: BlockHash, location: Location) Error!void {
+        const index_end = try self.index_file.getPos();
+        errdefer self.truncateIndex(index_end);
+        try self.index_file.writeAll(&encodeRecord(hash, location));
+    }
+
+    /// Cut the index back to `end` after a failed append, so a partial
+    /// record does not misalign every record after it
+    fn truncateIndex(self: *PackStore, end: u64) void {
+        self.index_file.setEndPos(end) catch {};
+        self.index_file.seekTo(end) catch {};
+    }
+
+    /// Read a block without copying its fields
+    pub fn read(self: *PackStore, hash: BlockHash) Error!StoredBlock {
+        const found = self.locate(hash) orelse {
+            if (self.fallback) |*loose| return loose.read(hash);
+            return Error.NotFound;
+        };
+        const file = found.file;
+        const location = found.location;
+
+        if (location.len >= self.mmap_threshold) {
+            if (store.mapRange(file, location.offset, location.len)) |mapped| {
+                errdefer std.posix.munmap(mapped.mapping);
+                return StoredBlock{
+                    .view = try BlockView.parse(mapped.bytes),
+                    .backing = .{ .mapped = mapped.mapping },
+                };
+            } else |_| {}
+        }
+
+        const bytes = try self.allocator.alloc(u8, location.len);
+        errdefer self.allocator.free(bytes);
+
+        if (try file.preadAll(bytes, location.offset) != bytes.len) return Error.StorageFailure;
+
+        return StoredBlock{
+            .view = try BlockView.parse(bytes),
+            .backing = .{ .heap = .{ .bytes = bytes, .allocator = self.allocator } },
+        };
+    }
+
+    /// Read several blocks
+    ///
+    /// With an io_uring, every packed block is read into its own heap
+    /// buffer with up to the queue depth of reads in flight; otherwise this
+    /// is `read` per hash.
+    pub fn readMany(self: *PackStore, hashes: []const BlockHash, out: []StoredBlock) Error!void {
+        const ring = if (self.ring) |*ring| ring else {
+            for (hashes, 0..) |hash, i| {
+                out[i] = self.read(hash) catch |err| {
+                    for (out[0..i]) |*stored| stored.deinit();
+                    return err;
+                };
+            }
+            return;
+        };
+
+        // Loose stragglers keep an empty read and are read directly below
+        const reads = try self.allocator.alloc(Ring.Read, hashes.len);
+        defer self.allocator.free(reads);
+
+        {
+            var prepared: usize = 0;
+            errdefer for (reads[0..prepared]) |r| self.allocator.free(r.buffer);
+
+            for (hashes, reads) |hash, *r| {
+                r.* = .{ .file = undefined, .buffer = &.{}, .offset = 0 };
+                if (self.locate(hash)) |found| {
+                    r.* = .{
+                        .file = found.file,
+                        .buffer = try self.allocator.alloc(u8, found.location.len),
+                        .offset = found.location.offset,
+                    };
+                } else if (self.fallback == null) {
+                    return Error.NotFound;
+                }
+                prepared += 1;
+            }
+
+            self.ring_mutex.lock();
+            defer self.ring_mutex.unlock();
+            ring.readAll(reads) catch return Error.StorageFailure;
+        }
+
+        // Buffers move into `out` one by one
+        for (hashes, reads, 0..) |hash, r, i| {
+            out[i] = self.adoptRead(hash, r.buffer) catch |err| {
+                for (out[0..i]) |*stored| stored.deinit();
+                for (reads[i..]) |rest| self.allocator.free(rest.buffer);
+                return err;
+            };
+        }
+    }
+
+    /// Wrap a buffer filled by `readMany`, or read a loose block if empty
+    fn adoptRead(self: *PackStore, hash: BlockHash, buffer: []u8) Error!StoredBlock {
+        if (buffer.len == 0) return self.fallback.?.read(hash);
+
+        return StoredBlock{
+            .view = try BlockView.parse(buffer),
+            .backing = .{ .heap = .{ .bytes = buffer, .allocator = self.allocator } },
+        };
+    }
+
+    /// Route batch reads and writes through an io_uring keeping up to
+    /// `queue_depth` I/Os in flight; 0 turns it off
+    ///
+    /// Returns whether the ring is in use. Where io_uring is unavailable
+    /// (non-Linux, old kernels, seccomp) this returns false and the store
+    /// keeps using positioned reads and vectored writes. Batches from
+    /// concurrent readers take turns on the ring. Not safe to call while
+    /// other threads use the store.
+    pub fn setIoQueueDepth(self: *PackStore, queue_depth: u16) Error!bool {
+        if (self.ring) |*ring| {
+            ring.deinit();
+            self.ring = null;
+        }
+        if (queue_depth == 0) return false;
+
+        self.ring = Ring.init(queue_depth) catch return false;
+        return true;
+    }
+
+    /// Read just the header at the block's pack offset
+    pub fn readHeader(self: *PackStore, hash: BlockHash) Error!BlockHeader {
+        const found = self.locate(hash) orelse {
+            if (self.fallback) |*loose| return loose.readHeader(hash);
+            return Error.NotFound;
+        };
+        // Compact and batch-signed blocks can be shorter than a version 1 header
+        var buf: [header_length]u8 = undefined;
+        const len: usize = @intCast(@min(found.location.len, header_length));
+        if (try found.file.preadAll(buf[0..len], found.location.offset) != len) {
+            return Error.StorageFailure;
+        }
+        return BlockHeader.parse(buf[0..len]);
+    }
+
+    /// Check if a block exists
+    pub fn has(self: *PackStore, hash: BlockHash) Error!bool {
+        if (self.contains(hash)) return true;
+        if (self.fallback) |*loose| return loose.has(hash);
+        return false;
+    }
+
+    /// Drop a block from the index by appending a tombstone
+    pub fn delete(self: *PackStore, hash: BlockHash) Error!void {
+        self.write_mutex.lock();
+        defer self.write_mutex.unlock();
+
+        if (self.contains(hash)) {
+            try self.appendRecord(hash, .{ .pack = tombstone_pack, .offset = 0, .len = 0 });
+
+            self.lock.lock();
+            defer self.lock.unlock();
+            _ = self.index.remove(hash);
+            return;
+        }
+        if (self.fallback) |*loose| return loose.delete(hash);
+        return Error.NotFound;
+    }
+
+    /// Append every stored hash to `out`
+    pub fn list(self: *PackStore, allocator: std.mem.Allocator, out: *std.ArrayList(BlockHash)) Error!void {
+        {
+            self.lock.lockShared();
+            defer self.lock.unlockShared();
+
+            try out.ensureUnusedCapacity(allocator, self.index.count());
+            var it = self.index.keyIterator();
+            while (it.next()) |hash| out.appendAssumeCapacity(hash.*);
+        }
+
+        // Loose stragglers from a partial migration
+        if (self.fallback) |*loose| {
+            var loose_hashes = std.ArrayList(BlockHash){};
+            defer loose_hashes.deinit(allocator);
+            try loose.list(allocator, &loose_hashes);
+
+            for (loose_hashes.items) |hash| {
+                if (!self.contains(hash)) try out.append(allocator, hash);
+            }
+        }
+    }
+
+    /// Flush the active pack and the index to disk
+    pub fn sync(self: *PackStore) !void {
+        self.write_mutex.lock();
+        defer self.write_mutex.unlock();
+
+        try syncFile(self.packs.items[self.packs.items.len - 1]);
+        try syncFile(self.index_file);
+    }
+};
+
+/// Result of migrating a loose store
+pub const MigrateStats = struct {
+    /// Blocks copied into packs and removed from the loose layout
+    migrated: usize = 0,
+    /// Loose files left in place because they failed to parse or hash
+    skipped: usize = 0,
+};
+
+/// Move every loose `blocks/XX/<hash>` file under `base_path` into packs
+///
+/// Each block is checked against its file name before it is packed. Loose
+/// files are deleted only after the packs and index are synced, so the
+/// migration can be interrupted and re-run safely.
+pub fn migrate(allocator: std.mem.Allocator, base_path: []const u8) !MigrateStats {
+    var stats = MigrateStats{};
+
+    var packs = try PackStore.open(allocator, base_path);
+    defer packs.deinit();
+
+    const blocks_path = try std.fmt.allocPrint(allocator, "{s}/blocks", .{base_path});
+    defer allocator.free(blocks_path);
+
+    var blocks_dir = std.fs.cwd().openDir(blocks_path, .{ .iterate = true }) catch |err| switch (err) {
+        error.FileNotFound => return stats, // Nothing to migrate
+        else => return err,
+    };
+    defer blocks_dir.close();
+
+    var migrated = std.ArrayList(BlockHash){};
+    defer migrated.deinit(allocator);
+
+    // 1. Copy verified blocks into packs
+    {
+        var walker = try blocks_dir.walk(allocator);
+        defer walker.deinit();
+
+        while (try walker.next()) |entry| {
+            if (entry.kind != .file or entry.basename.len != 64) continue;
+
+            var hash: BlockHash = undefined;
+            _ = std.fmt.hexToBytes(&hash, entry.basename) catch {
+                stats.skipped += 1;
+                continue;
+            };
+
+            const bytes = try entry.dir.readFileAlloc(entry.basename, allocator, @enumFromInt(16 * 1024 * 1024));
+            defer allocator.free(bytes);
+
+            const view = BlockView.parse(bytes) catch {
+                stats.skipped += 1;
+                continue;
+            };
+            const computed = view.computeHash();
+            if (!std.mem.eql(u8, &computed, &hash) or !std.mem.eql(u8, view.hash, &hash)) {
+                stats.skipped += 1;
+                continue;
+            }
+
+            try packs.putBytes(hash, view.bytes);
+            try migrated.append(allocator, hash);
+        }
+    }
+
+    try packs.sync();
+
+    // 2. Remove the loose copies, then any directories left empty
+    for (migrated.items) |hash| {
+        const hex = std.fmt.bytesToHex(hash, .lower);
+        var path_buf: [3 + hex.len]u8 = undefined;
+        const path = std.fmt.bufPrint(&path_buf, "{s}/{s}", .{ hex[0..2], hex }) catch unreachable;
+        blocks_dir.deleteFile(path) catch |err| switch (err) {
+            error.FileNotFound => {},
+            else => return err,
+        };
+        blocks_dir.deleteDir(hex[0..2]) catch {};
+        stats.migrated += 1;
+    }
+
+    if (stats.skipped == 0) std.fs.cwd().deleteDir(blocks_path) catch {};
+
+    return stats;
+}
+
+test "packstore put, read and reopen" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const test_dir = "zig-cache/test-packstore";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const identity = Identity.generate();
+
+    var hashes: [3]BlockHash = undefined;
+    {
+        var packs = try PackStore.open(allocator, test_dir);
+        defer packs.deinit();
+        const pack_store = packs.blockStore();
+
+        // Tiny packs so the blocks roll over into several files
+        packs.max_pack_size = 1;
+
+        for (&hashes, 0..) |*hash, i| {
+            var block = Block{
+                .version = 0x01,
+                .block_type = .content,
+                .timestamp = @intCast(i),
+                .author = identity.public_key,
+                .data = "packed block",
+                .nonce = [_]u8{1} ** crypto.ChaCha20Poly1305.nonce_length,
+                .signature = undefined,
+                .prev_hash = [_]u8{0} ** 32,
+                .hash = undefined,
+            };
+            try block.sign(&identity.secret_key, allocator);
+            block.hash = block.computeHash();
+
+            try pack_store.put(block.hash, &block);
+            try pack_store.put(block.hash, &block); // Duplicate put is a no-op
+            hash.* = block.hash;
+        }
+
+        try std.testing.expectEqual(@as(usize, 3), packs.packs.items.len);
+        try std.testing.expectEqual(@as(u32, 3), packs.index.count());
+    }
+
+    // Reopen and read everything back from the index
+    var packs = try PackStore.open(allocator, test_dir);
+    defer packs.deinit();
+
+    try std.testing.expect(PackStore.exists(test_dir));
+    for (hashes) |hash| {
+        var stored = try packs.read(hash);
+        defer stored.deinit();
+
+        try std.testing.expectEqualStrings("packed block", stored.view.data);
+        try std.testing.expectEqualSlices(u8, &hash, &stored.view.computeHash());
+        try stored.view.verify(allocator);
+
+        const header = try packs.readHeader(hash);
+        try std.testing.expectEqual(stored.view.block_type, header.block_type);
+        try std.testing.expectEqual(stored.view.bytes.len, header.blockLength());
+    }
+
+    try std.testing.expectError(error.NotFound, packs.read([_]u8{0xEE} ** 32));
+
+    // Deletes are tombstoned and survive a reopen
+    try packs.delete(hashes[1]);
+    try std.testing.expect(!try packs.has(hashes[1]));
+    packs.deinit();
+    packs = try PackStore.open(allocator, test_dir);
+    try std.testing.expect(!try packs.has(hashes[1]));
+    try std.testing.expect(try packs.has(hashes[2]));
+}
+
+test "packstore putMany batches blocks" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const test_dir = "zig-cache/test-packstore-many";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const identity = Identity.generate();
+
+    var serialized: [4][]u8 = undefined;
+    var entries: [5]BlockStore.Entry = undefined;
+    for (&serialized, 0..) |*bytes, i| {
+        var block = Block{
+            .version = 0x01,
+            .block_type = .content,
+            .timestamp = @intCast(i),
+            .author = identity.public_key,
+            .data = "batched block",
+            .nonce = [_]u8{4} ** crypto.ChaCha20Poly1305.nonce_length,
+            .signature = undefined,
+            .prev_hash = [_]u8{0} ** 32,
+            .hash = undefined,
+        };
+        try block.sign(&identity.secret_key, allocator);
+        block.hash = block.computeHash();
+
+        bytes.* = try block.serialize(allocator);
+        entries[i] = .{ .hash = block.hash, .bytes = bytes.* };
+    }
+    defer for (serialized) |bytes| allocator.free(bytes);
+    entries[4] = entries[1]; // Repeated within the batch
+
+    {
+        var packs = try PackStore.open(allocator, test_dir);
+        defer packs.deinit();
+        packs.durable = true;
+
+        // Two blocks per pack, so the batch spans two packs
+        packs.max_pack_size = 2 * serialized[0].len;
+
+        try packs.blockStore().putMany(&entries);
+        try std.testing.expectEqual(@as(usize, 2), packs.packs.items.len);
+        try std.testing.expectEqual(@as(u32, 4), packs.index.count());
+    }
+
+    {
+        var packs = try PackStore.open(allocator, test_dir);
+        defer packs.deinit();
+
+        for (entries[0..4]) |entry| {
+            var stored = try packs.read(entry.hash);
+            defer stored.deinit();
+            try std.testing.expectEqualSlices(u8, entry.bytes, stored.view.bytes);
+        }
+    }
+
+    // Lose the last block's data, as a power loss without `durable` can
+    {
+        const pack = try std.fs.cwd().openFile(test_dir ++ "/packs/pack-000001.pack", .{ .mode = .read_write });
+        defer pack.close();
+        try pack.setEndPos(serialized[2].len);
+    }
+
+    var packs = try PackStore.open(allocator, test_dir);
+    defer packs.deinit();
+
+    // Its record is dropped rather than pointing past the end of the pack
+    try std.testing.expectEqual(@as(u32, 3), packs.index.count());
+    try std.testing.expectError(error.NotFound, packs.read(entries[3].hash));
+    try std.testing.expectEqual(@as(u64, index_magic.len + 3 * index_record_length), (try packs.index_file.stat()).size);
+
+    // And the block can be stored again
+    try packs.putBytes(entries[3].hash, entries[3].bytes);
+    var stored = try packs.read(entries[3].hash);
+    defer stored.deinit();
+    try std.testing.expectEqualSlices(u8, entries[3].bytes, stored.view.bytes);
+}
+
+test "migrate loose blocks into packs" {
+    const allocator = std.testing.allocator;
+    const Identity = @import("identity.zig").Identity;
+
+    const test_dir = "zig-cache/test-packstore-migrate";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const identity = Identity.generate();
+
+    var block = Block{
+        .version = 0x01,
+        .block_type = .content,
+        .timestamp = 0,
+        .author = identity.public_key,
+        .data = "loose block",
+        .nonce = [_]u8{2} ** crypto.ChaCha20Poly1305.nonce_length,
+        .signature = undefined,
+        .prev_hash = [_]u8{0} ** 32,
+        .hash = undefined,
+    };
+    try block.sign(&identity.secret_key, allocator);
+    block.hash = block.computeHash();
+
+    {
+        var loose = try BlockStore.initLayout(allocator, test_dir, .loose);
+        defer loose.deinit();
+        try loose.put(block.hash, &block);
+    }
+
+    const stats = try migrate(allocator, test_dir);
+    try std.testing.expectEqual(@as(usize, 1), stats.migrated);
+    try std.testing.expectEqual(@as(usize, 0), stats.skipped);
+
+    // The store now opens as packed and still finds the block
+    var migrated = try BlockStore.init(allocator, test_dir);
+    defer migrated.deinit();
+
+    try std.testing.expectEqual(store.Layout.pack, BlockStore.detectLayout(test_dir));
+    try std.testing.expect(try migrated.has(block.hash));
+
+    // Re-running is a no-op
+    const again = try migrate(allocator, test_dir);
+    try std.testing.expectEqual(@as(usize, 0), again.migrated);
+}
@@ -29,6 +29,7 @@
 
 const std = @import("std");
 const crypto = @import("crypto.zig");
+const metrics = @import("metrics.zig");
 const BlockHash = @import("store.zig").BlockHash;
 
 /// Share token structure
@@ -125,7 +126,9 @@ pub fn encryptShareToken(
     const recipient_pk = try crypto.MLKem768.PublicKey.fromBytes(recipient_pubkey);
 
     // 3. Encapsulate (generate shared secret)
+    const encaps_span = metrics.start(.encaps);
     const encapsulation = recipient_pk.encaps(null); // null = random seed
+    encaps_span.end(0);
 
     // 4. Derive encryption key from shared secret using HKDF
     const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &encapsulation.shared_secret);
@@ -155,6 +158,16 @@ pub fn decryptShareToken(
     encrypted: []const u8,
     recipient_seckey: *const [crypto.MLKem768.SecretKey.encoded_length]u8,
     allocator: std.mem.Allocator,
+) !ShareToken {
+    const secret_key = try crypto.MLKem768.SecretKey.fromBytes(recipient_seckey);
+    return decryptShareTokenWith(encrypted, &secret_key, allocator);
+}
+
+/// Decrypt a share token with an already decoded ML-KEM-768 secret key
+pub fn decryptShareTokenWith(
+    encrypted: []const u8,
+    secret_key: *const crypto.MLKem768.SecretKey,
+    allocator: std.mem.Allocator,
 ) !ShareToken {
     var pos: usize = 0;
 
@@ -173,9 +186,10 @@ pub fn decryptShareToken(
     // 3. Extract encrypted token
     const encrypted_token = encrypted[pos..];
 
-    // 4. Reconstruct secret key and decapsulate
-    const secret_key = try crypto.MLKem768.SecretKey.fromBytes(recipient_seckey);
+    // 4. Decapsulate
+    const decaps_span = metrics.start(.decaps);
     const shared_secret = try secret_key.decaps(&kem_ciphertext);
+    decaps_span.end(0);
 
     // 5. Derive decryption key
     const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &shared_secret);
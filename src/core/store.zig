@@ -1,10 +1,24 @@
 //! Storage backend for Zault blocks
 //!
-//! Provides a content-addressed block store with a local filesystem backend.
+//! Provides a content-addressed block store interface and its filesystem
+//! backends. Blocks live either in append-only pack files (see
+//! packstore.zig) or, in stores created before packs existed, one file per
+//! block under `blocks/XX/<hash>`. Large blocks are memory-mapped on read
+//! so their payload is decrypted straight out of the page cache.
+//!
+//! The backends here may be called from several threads at once.
 
 const std = @import("std");
+const builtin = @import("builtin");
 const crypto = @import("crypto.zig");
+const metrics = @import("metrics.zig");
 const Block = @import("block.zig").Block;
+const BlockView = @import("block.zig").BlockView;
+const BlockHeader = @import("block.zig").BlockHeader;
+const BlockType = @import("block.zig").BlockType;
+const header_length = @import("block.zig").header_length;
+const PackStore = @import("packstore.zig").PackStore;
+const CacheEntry = @import("cache.zig").Entry;
 
 /// Hash type for block addresses
 pub const BlockHash = [crypto.Sha3_256.digest_length]u8;
@@ -21,106 +35,548 @@ pub const Error = error{
     Streaming,
     StreamTooLong,
     RenameAcrossMountPoints,
-} || std.mem.Allocator.Error || std.fs.File.OpenError || std.fs.File.WriteError || std.fs.File.ReadError;
+} || std.mem.Allocator.Error || std.fs.File.OpenError || std.fs.File.WriteError || std.fs.File.ReadError || std.fs.File.StatError ||
+    std.fs.File.PReadError || std.fs.File.PWriteError || std.fs.File.SetEndPosError || std.fs.File.SeekError ||
+    std.fs.File.SyncError;
+
+/// Largest block file the store will read
+const max_block_size = 16 * 1024 * 1024;
+
+/// Blocks at least this large are memory-mapped instead of copied to the heap.
+/// Below it, one read() is cheaper than setting up and tearing down a mapping.
+pub const default_mmap_threshold = 64 * 1024;
+
+const mmap_supported = switch (builtin.os.tag) {
+    .linux, .macos, .ios, .freebsd, .netbsd, .openbsd, .dragonfly => true,
+    else => false,
+};
+
+/// A serialized block read from the store, viewed in place
+pub const StoredBlock = struct {
+    /// Borrowed view into the backing memory
+    view: BlockView,
+    backing: Backing,
+
+    pub const Backing = union(enum) {
+        /// Heap buffer owned by the allocator
+        heap: struct { bytes: []u8, allocator: std.mem.Allocator },
+        /// Read-only file mapping
+        mapped: []align(std.heap.page_size_min) const u8,
+        /// Memory owned by the backend; valid until the block is deleted
+        borrowed,
+        /// Pinned in a `BlockCache` until released
+        cached: *CacheEntry,
+    };
+
+    /// Release the backing memory; `view` is invalid afterwards
+    pub fn deinit(self: *StoredBlock) void {
+        switch (self.backing) {
+            .heap => |heap| heap.allocator.free(heap.bytes),
+            .mapped => |mapping| std.posix.munmap(mapping),
+            .borrowed => {},
+            .cached => |entry| entry.release(),
+        }
+    }
+};
+
+/// A read-only mapping and the requested range within it
+pub const Mapping = struct {
+    /// Whole mapping, page aligned; pass to munmap
+    mapping: []align(std.heap.page_size_min) const u8,
+    /// The `len` bytes starting at the requested offset
+    bytes: []const u8,
+};
+
+/// Map `len` bytes of `file` starting at `offset` read-only.
+/// The offset need not be page aligned.
+pub fn mapRange(file: std.fs.File, offset: u64, len: usize) !Mapping {
+    if (comptime !mmap_supported) return error.Unsupported;
+
+    const page = std.heap.pageSize();
+    const aligned_offset = offset - offset % page;
+    const lead: usize = @intCast(offset - aligned_offset);
+
+    const mapping = try std.posix.mmap(
+        null,
+        lead + len,
+        std.posix.PROT.READ,
+        .{ .TYPE = .PRIVATE },
+        file.handle,
+        aligned_offset,
+    );
+
+    return Mapping{ .mapping = mapping, .bytes = mapping[lead..][0..len] };
+}
+
+/// fsync `file`, counted under the `fsync` metric
+pub fn syncFile(file: std.fs.File) !void {
+    const span = metrics.start(.fsync);
+    defer span.end(0);
+    try file.sync();
+}
+
+/// On-disk layout of a filesystem block store
+pub const Layout = enum {
+    /// One file per block under `blocks/XX/<hash>`
+    loose,
+    /// Append-only pack files with a hash index under `packs/`
+    pack,
+};
 
 /// Block storage interface
+///
+/// A type-erased handle over a storage backend, in the same shape as
+/// `std.mem.Allocator`: backends implement the byte-level operations in
+/// `VTable`, and `put`/`get` wrap them to (de)serialize `Block`s.
+///
+/// Backends: `LooseStore` (one file per block), `PackStore` (packstore.zig)
+/// and `MemoryStore` (memstore.zig). Any type with the same methods can be
+/// adapted with `BlockStore.implement`; a backend used by a shared vault
+/// must be safe to call from several threads at once.
 pub const BlockStore = struct {
+    ptr: *anyopaque,
+    vtable: *const VTable,
+    /// Used by `put` and `get` for serialization buffers
     allocator: std.mem.Allocator,
-    base_path: []const u8,
 
-    /// Initialize a new block store
+    pub const VTable = struct {
+        /// Store serialized block bytes. Storing an existing hash is not an error.
+        putBytes: *const fn (ptr: *anyopaque, hash: BlockHash, bytes: []const u8) Error!void,
+        /// Read a block in place; `error.NotFound` if absent
+        read: *const fn (ptr: *anyopaque, hash: BlockHash) Error!StoredBlock,
+        has: *const fn (ptr: *anyopaque, hash: BlockHash) Error!bool,
+        /// Remove a block; `error.NotFound` if absent
+        delete: *const fn (ptr: *anyopaque, hash: BlockHash) Error!void,
+        /// Append every stored hash to `out`
+        list: *const fn (ptr: *anyopaque, allocator: std.mem.Allocator, out: *std.ArrayList(BlockHash)) Error!void,
+        /// Release the backend (and free it, if `BlockStore.init` allocated it)
+        deinit: *const fn (ptr: *anyopaque, allocator: std.mem.Allocator) void,
+        /// Optional batch put; null falls back to `putBytes` per entry
+        putMany: ?*const fn (ptr: *anyopaque, entries: []const Entry) Error!void = null,
+        /// Optional batch read; null falls back to `read` per hash
+        readMany: ?*const fn (ptr: *anyopaque, hashes: []const BlockHash, out: []StoredBlock) Error!void = null,
+        /// Optional header-only read; null falls back to a full `read`
+        readHeader: ?*const fn (ptr: *anyopaque, hash: BlockHash) Error!BlockHeader = null,
+        /// Optional async I/O for batch operations; null means unsupported
+        setIoQueueDepth: ?*const fn (ptr: *anyopaque, queue_depth: u16) Error!bool = null,
+    };
+
+    /// One block in a batch put
+    pub const Entry = struct {
+        hash: BlockHash,
+        bytes: []const u8,
+    };
+
+    /// Open the default filesystem backend at `base_path`
+    ///
+    /// Existing stores keep their layout. New stores use packs; loose stores
+    /// can be converted with `packstore.migrate`. The returned handle owns
+    /// the backend; release it with `deinit`.
     pub fn init(allocator: std.mem.Allocator, base_path: []const u8) !BlockStore {
+        return initLayout(allocator, base_path, detectLayout(base_path));
+    }
+
+    /// Open a filesystem backend with an explicit layout
+    pub fn initLayout(allocator: std.mem.Allocator, base_path: []const u8, layout: Layout) !BlockStore {
+        switch (layout) {
+            .loose => {
+                const backend = try allocator.create(LooseStore);
+                errdefer allocator.destroy(backend);
+                backend.* = try LooseStore.init(allocator, base_path);
+                return implementOwned(LooseStore, backend, allocator);
+            },
+            .pack => {
+                const backend = try allocator.create(PackStore);
+                errdefer allocator.destroy(backend);
+                backend.* = try PackStore.open(allocator, base_path);
+                return implementOwned(PackStore, backend, allocator);
+            },
+        }
+    }
+
+    /// Layout of the store at `base_path`: packs if present, loose if only
+    /// a `blocks/` directory exists, packs for a new store
+    pub fn detectLayout(base_path: []const u8) Layout {
+        if (PackStore.exists(base_path)) return .pack;
+        if (LooseStore.exists(base_path)) return .loose;
+        return .pack;
+    }
+
+    /// Wrap a caller-owned backend. `deinit` on the handle calls the
+    /// backend's `deinit` but does not free `backend` itself.
+    pub fn implement(comptime T: type, backend: *T, allocator: std.mem.Allocator) BlockStore {
+        return .{ .ptr = backend, .vtable = &Adapter(T, false).vtable, .allocator = allocator };
+    }
+
+    fn implementOwned(comptime T: type, backend: *T, allocator: std.mem.Allocator) BlockStore {
+        return .{ .ptr = backend, .vtable = &Adapter(T, true).vtable, .allocator = allocator };
+    }
+
+    fn Adapter(comptime T: type, comptime owned: bool) type {
+        return struct {
+            const vtable = VTable{
+                .putBytes = putBytes,
+                .read = read,
+                .has = has,
+                .delete = delete,
+                .list = list,
+                .deinit = deinit,
+                .putMany = if (@hasDecl(T, "putMany")) putMany else null,
+                .readMany = if (@hasDecl(T, "readMany")) readMany else null,
+                .readHeader = if (@hasDecl(T, "readHeader")) readHeader else null,
+                .setIoQueueDepth = if (@hasDecl(T, "setIoQueueDepth")) setIoQueueDepth else null,
+            };
+
+            fn cast(ptr: *anyopaque) *T {
+                return @ptrCast(@alignCast(ptr));
+            }
+            fn putBytes(ptr: *anyopaque, hash: BlockHash, bytes: []const u8) Error!void {
+                return cast(ptr).putBytes(hash, bytes);
+            }
+            fn read(ptr: *anyopaque, hash: BlockHash) Error!StoredBlock {
+                return cast(ptr).read(hash);
+            }
+            fn has(ptr: *anyopaque, hash: BlockHash) Error!bool {
+                return cast(ptr).has(hash);
+            }
+            fn delete(ptr: *anyopaque, hash: BlockHash) Error!void {
+                return cast(ptr).delete(hash);
+            }
+            fn list(ptr: *anyopaque, allocator: std.mem.Allocator, out: *std.ArrayList(BlockHash)) Error!void {
+                return cast(ptr).list(allocator, out);
+            }
+            fn deinit(ptr: *anyopaque, allocator: std.mem.Allocator) void {
+                const backend = cast(ptr);
+                backend.deinit();
+                if (owned) allocator.destroy(backend);
+            }
+            fn putMany(ptr: *anyopaque, entries: []const Entry) Error!void {
+                return cast(ptr).putMany(entries);
+            }
+            fn readMany(ptr: *anyopaque, hashes: []const BlockHash, out: []StoredBlock) Error!void {
+                return cast(ptr).readMany(hashes, out);
+            }
+            fn readHeader(ptr: *anyopaque, hash: BlockHash) Error!BlockHeader {
+                return cast(ptr).readHeader(hash);
+            }
+            fn setIoQueueDepth(ptr: *anyopaque, queue_depth: u16) Error!bool {
+                return cast(ptr).setIoQueueDepth(queue_depth);
+            }
+        };
+    }
+
+    /// Store a block
+    pub fn put(self: BlockStore, hash: BlockHash, block: *const Block) Error!void {
+        // Serialize the block
+        const serialized = try block.serialize(self.allocator);
+        defer self.allocator.free(serialized);
+
+        return self.putBytes(hash, serialized);
+    }
+
+    /// Store an already serialized block
+    pub fn putBytes(self: BlockStore, hash: BlockHash, bytes: []const u8) Error!void {
+        const span = metrics.start(.store_write);
+        defer span.end(bytes.len);
+
+        return self.vtable.putBytes(self.ptr, hash, bytes);
+    }
+
+    /// Store several serialized blocks
+    pub fn putMany(self: BlockStore, entries: []const Entry) Error!void {
+        const span = metrics.start(.store_write);
+        defer if (metrics.enabled) {
+            var bytes: usize = 0;
+            for (entries) |entry| bytes += entry.bytes.len;
+            span.end(bytes);
+        };
+
+        if (self.vtable.putMany) |putManyFn| return putManyFn(self.ptr, entries);
+
+        for (entries) |entry| try self.vtable.putBytes(self.ptr, entry.hash, entry.bytes);
+    }
+
+    /// Retrieve a block
+    ///
+    /// The returned block owns its `data`; free it with the store allocator.
+    /// Prefer `read` on hot paths to avoid the copy.
+    pub fn get(self: BlockStore, hash: BlockHash) Error!Block {
+        var stored = try self.read(hash);
+        defer stored.deinit();
+
+        var block = stored.view.toBlock();
+        block.data = try self.allocator.dupe(u8, stored.view.data);
+        return block;
+    }
+
+    /// Read a block without copying its fields. Call `deinit` on the result
+    /// when done with the view.
+    pub fn read(self: BlockStore, hash: BlockHash) Error!StoredBlock {
+        const span = metrics.start(.store_read);
+        const stored = try self.vtable.read(self.ptr, hash);
+        span.end(stored.view.bytes.len);
+        return stored;
+    }
+
+    /// Read several blocks into `out` (same length as `hashes`).
+    /// On error, blocks already read are released.
+    pub fn readMany(self: BlockStore, hashes: []const BlockHash, out: []StoredBlock) Error!void {
+        std.debug.assert(out.len == hashes.len);
+        const span = metrics.start(.store_read);
+
+        if (self.vtable.readMany) |readManyFn| {
+            try readManyFn(self.ptr, hashes, out);
+        } else {
+            for (hashes, 0..) |hash, i| {
+                out[i] = self.vtable.read(self.ptr, hash) catch |err| {
+                    for (out[0..i]) |*stored| stored.deinit();
+                    return err;
+                };
+            }
+        }
+
+        if (metrics.enabled) {
+            var bytes: usize = 0;
+            for (out) |stored| bytes += stored.view.bytes.len;
+            span.end(bytes);
+        }
+    }
+
+    /// Read only the header of a block (under 2 KiB), leaving the payload
+    /// on disk
+    pub fn readHeader(self: BlockStore, hash: BlockHash) Error!BlockHeader {
+        const span = metrics.start(.store_read);
+        defer span.end(header_length);
+
+        if (self.vtable.readHeader) |readHeaderFn| return readHeaderFn(self.ptr, hash);
+
+        var stored = try self.vtable.read(self.ptr, hash);
+        defer stored.deinit();
+        return BlockHeader.parse(stored.view.bytes);
+    }
+
+    /// Type of a stored block, from its header
+    pub fn peekType(self: BlockStore, hash: BlockHash) Error!BlockType {
+        return (try self.readHeader(hash)).block_type;
+    }
+
+    /// Let `putMany` and `readMany` keep up to `queue_depth` I/Os in
+    /// flight (io_uring on Linux pack stores); 0 turns it off.
+    /// Returns false if the backend stays synchronous.
+    pub fn setIoQueueDepth(self: BlockStore, queue_depth: u16) Error!bool {
+        const setFn = self.vtable.setIoQueueDepth orelse return false;
+        return setFn(self.ptr, queue_depth);
+    }
+
+    /// Check if a block exists
+    pub fn has(self: BlockStore, hash: BlockHash) Error!bool {
+        return self.vtable.has(self.ptr, hash);
+    }
+
+    /// Remove a block
+    pub fn delete(self: BlockStore, hash: BlockHash) Error!void {
+        return self.vtable.delete(self.ptr, hash);
+    }
+
+    /// List the hashes of all stored blocks
+    pub fn list(self: BlockStore, allocator: std.mem.Allocator) Error!std.ArrayList(BlockHash) {
+        var hashes = std.ArrayList(BlockHash){};
+        errdefer hashes.deinit(allocator);
+
+        try self.vtable.list(self.ptr, allocator, &hashes);
+        return hashes;
+    }
+
+    /// Release the backend; the handle is invalid afterwards
+    pub fn deinit(self: *BlockStore) void {
+        self.vtable.deinit(self.ptr, self.allocator);
+        self.* = undefined;
+    }
+};
+
+/// Loose-file backend: one file per block under `blocks/XX/<hash>`
+pub const LooseStore = struct {
+    allocator: std.mem.Allocator,
+    /// Owned copy of the store root
+    base_path: []u8,
+    /// Map blocks of at least this many bytes on read (maxInt disables mmap)
+    mmap_threshold: usize = default_mmap_threshold,
+    /// Fsync each block file before its rename, and each touched shard
+    /// directory once per put
+    durable: bool = false,
+
+    /// Whether `base_path` has a loose `blocks/` directory
+    pub fn exists(base_path: []const u8) bool {
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const blocks_path = std.fmt.bufPrint(&path_buf, "{s}/blocks", .{base_path}) catch return false;
+        std.fs.cwd().access(blocks_path, .{}) catch return false;
+        return true;
+    }
+
+    /// Initialize a loose store rooted at `base_path`
+    pub fn init(allocator: std.mem.Allocator, base_path: []const u8) Error!LooseStore {
         // Create base directory if it doesn't exist
         std.fs.cwd().makePath(base_path) catch |err| switch (err) {
             error.PathAlreadyExists => {},
-            else => return err,
+            else => return Error.StorageFailure,
         };
 
-        return BlockStore{
+        return LooseStore{
             .allocator = allocator,
-            .base_path = base_path,
+            .base_path = try allocator.dupe(u8, base_path),
         };
     }
 
+    /// Clean up resources
+    pub fn deinit(self: *LooseStore) void {
+        self.allocator.free(self.base_path);
+    }
+
+    /// Interface handle; the caller keeps ownership of `self`
+    pub fn blockStore(self: *LooseStore) BlockStore {
+        return BlockStore.implement(LooseStore, self, self.allocator);
+    }
+
     /// Get the file path for a block hash
-    fn getBlockPath(self: *BlockStore, hash: BlockHash) ![]u8 {
+    fn getBlockPath(self: *LooseStore, hash: BlockHash) ![]u8 {
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+        return self.allocator.dupe(u8, try self.blockPath(&path_buf, hash));
+    }
+
+    /// Format `base_path/blocks/XX/<hash>` into `buf`
+    fn blockPath(self: *LooseStore, buf: []u8, hash: BlockHash) Error![]u8 {
         // Use first 2 hex chars as subdirectory
-        var hex_buf: [64]u8 = undefined;
         const hex = std.fmt.bytesToHex(hash, .lower);
-        @memcpy(&hex_buf, &hex);
+        return std.fmt.bufPrint(buf, "{s}/blocks/{s}/{s}", .{ self.base_path, hex[0..2], &hex }) catch return Error.InvalidPath;
+    }
 
-        const subdir = hex_buf[0..2];
-        const filename = hex_buf[0..];
+    /// Format `base_path/blocks/XX` into `buf`
+    fn shardPath(self: *LooseStore, buf: []u8, shard: u8) Error![]u8 {
+        return std.fmt.bufPrint(buf, "{s}/blocks/{x:0>2}", .{ self.base_path, shard }) catch return Error.InvalidPath;
+    }
 
-        // Create path: base_path/blocks/XX/XXXX...
-        return std.fmt.allocPrint(
-            self.allocator,
-            "{s}/blocks/{s}/{s}",
-            .{ self.base_path, subdir, filename },
-        );
+    /// Store a serialized block
+    pub fn putBytes(self: *LooseStore, hash: BlockHash, bytes: []const u8) Error!void {
+        return self.putMany(&.{.{ .hash = hash, .bytes = bytes }});
     }
 
-    /// Store a block
-    pub fn put(self: *BlockStore, hash: BlockHash, block: *const Block) Error!void {
+    /// Store a batch of serialized blocks
+    ///
+    /// Each shard directory is created at most once per batch and paths are
+    /// built on the stack, so a block costs one create, write and rename.
+    /// With `durable` set, every touched shard directory is fsynced once
+    /// after all of its renames rather than once per block.
+    pub fn putMany(self: *LooseStore, entries: []const BlockStore.Entry) Error!void {
+        var shards = std.StaticBitSet(256).initEmpty();
+        var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+        var tmp_buf: [std.fs.max_path_bytes]u8 = undefined;
+
+        for (entries) |entry| {
+            const shard = entry.hash[0];
+            if (!shards.isSet(shard)) {
+                // Create subdirectory if needed
+                std.fs.cwd().makePath(try self.shardPath(&path_buf, shard)) catch |err| switch (err) {
+                    error.PathAlreadyExists => {},
+                    else => return err,
+                };
+                shards.set(shard);
+            }
+
+            // Unique per writer, so concurrent puts of one hash don't
+            // share a temporary file
+            const block_path = try self.blockPath(&path_buf, entry.hash);
+            const tmp_path = std.fmt.bufPrint(&tmp_buf, "{s}.{x}.tmp", .{ block_path, crypto.random.int(u64) }) catch return Error.InvalidPath;
+
+            // Write to temporary file first (atomic write)
+            {
+                const tmp_file = try std.fs.cwd().createFile(tmp_path, .{});
+                defer tmp_file.close();
+                try tmp_file.writeAll(entry.bytes);
+                if (self.durable) try syncFile(tmp_file);
+            }
+
+            // Atomic rename
+            std.fs.cwd().rename(tmp_path, block_path) catch |err| {
+                // If rename fails, try to clean up tmp file
+                std.fs.cwd().deleteFile(tmp_path) catch {};
+                return err;
+            };
+        }
+
+        if (!self.durable) return;
+
+        // Make the renames themselves durable
+        var it = shards.iterator(.{});
+        while (it.next()) |shard| {
+            var dir = std.fs.cwd().openDir(try self.shardPath(&path_buf, @intCast(shard)), .{}) catch return Error.StorageFailure;
+            defer dir.close();
+            const span = metrics.start(.fsync);
+            defer span.end(0);
+            try std.posix.fsync(dir.fd);
+        }
+    }
+
+    /// Read a block without copying its fields
+    ///
+    /// Blocks of at least `mmap_threshold` bytes are mapped read-only and
+    /// `view` points into the mapping, so repeat reads share the page cache.
+    /// Smaller blocks are read into one heap buffer.
+    pub fn read(self: *LooseStore, hash: BlockHash) Error!StoredBlock {
         // Get the block path
         const block_path = try self.getBlockPath(hash);
         defer self.allocator.free(block_path);
 
-        // Create subdirectory if needed
-        const dir_path = std.fs.path.dirname(block_path) orelse return error.InvalidPath;
-        std.fs.cwd().makePath(dir_path) catch |err| switch (err) {
-            error.PathAlreadyExists => {},
+        const file = std.fs.cwd().openFile(block_path, .{}) catch |err| switch (err) {
+            error.FileNotFound => return Error.NotFound,
             else => return err,
         };
-
-        // Serialize the block
-        const serialized = try block.serialize(self.allocator);
-        defer self.allocator.free(serialized);
-
-        // Write to temporary file first (atomic write)
-        const tmp_path = try std.fmt.allocPrint(
-            self.allocator,
-            "{s}.tmp",
-            .{block_path},
-        );
-        defer self.allocator.free(tmp_path);
-
-        const tmp_file = try std.fs.cwd().createFile(tmp_path, .{});
-        defer tmp_file.close();
-        try tmp_file.writeAll(serialized);
-
-        // Atomic rename
-        std.fs.cwd().rename(tmp_path, block_path) catch |err| {
-            // If rename fails, try to clean up tmp file
-            std.fs.cwd().deleteFile(tmp_path) catch {};
-            return err;
+        defer file.close();
+
+        const size = (try file.stat()).size;
+        if (size > max_block_size) return Error.StorageFailure;
+
+        if (size > 0 and size >= self.mmap_threshold) {
+            if (mapRange(file, 0, @intCast(size))) |mapped| {
+                errdefer std.posix.munmap(mapped.mapping);
+                return StoredBlock{
+                    .view = try BlockView.parse(mapped.bytes),
+                    .backing = .{ .mapped = mapped.mapping },
+                };
+            } else |_| {
+                // Fall through to a plain read (e.g. filesystems without mmap)
+            }
+        }
+
+        const bytes = try self.allocator.alloc(u8, @intCast(size));
+        errdefer self.allocator.free(bytes);
+
+        if (try file.readAll(bytes) != bytes.len) return Error.StorageFailure;
+
+        return StoredBlock{
+            .view = try BlockView.parse(bytes),
+            .backing = .{ .heap = .{ .bytes = bytes, .allocator = self.allocator } },
         };
     }
 
-    /// Retrieve a block
-    pub fn get(self: *BlockStore, hash: BlockHash) Error!Block {
-        // Get the block path
+    /// Read just the header from the start of the block file
+    pub fn readHeader(self: *LooseStore, hash: BlockHash) Error!BlockHeader {
         const block_path = try self.getBlockPath(hash);
         defer self.allocator.free(block_path);
 
-        // Read the file
-        const bytes = std.fs.cwd().readFileAlloc(
-            block_path,
-            self.allocator,
-            @enumFromInt(16 * 1024 * 1024), // max 16MB
-        ) catch |err| switch (err) {
+        const file = std.fs.cwd().openFile(block_path, .{}) catch |err| switch (err) {
             error.FileNotFound => return Error.NotFound,
-            error.StreamTooLong => return Error.StorageFailure,
             else => return err,
         };
-        defer self.allocator.free(bytes);
+        defer file.close();
 
-        // Deserialize
-        return try Block.deserialize(bytes, self.allocator);
+        // Compact and batch-signed blocks can be shorter than a version 1 header
+        var buf: [header_length]u8 = undefined;
+        const len = try file.readAll(&buf);
+        return BlockHeader.parse(buf[0..len]);
     }
 
     /// Check if a block exists
-    pub fn has(self: *BlockStore, hash: BlockHash) Error!bool {
+    pub fn has(self: *LooseStore, hash: BlockHash) Error!bool {
         const block_path = try self.getBlockPath(hash);
         defer self.allocator.free(block_path);
 
@@ -134,10 +590,45 @@ pub const BlockStore = struct {
         return true;
     }
 
-    /// Clean up resources
-    pub fn deinit(self: *BlockStore) void {
-        _ = self;
-        // Nothing to clean up yet
+    /// Remove a block file
+    pub fn delete(self: *LooseStore, hash: BlockHash) Error!void {
+        const block_path = try self.getBlockPath(hash);
+        defer self.allocator.free(block_path);
+
+        std.fs.cwd().deleteFile(block_path) catch |err| switch (err) {
+            error.FileNotFound => return Error.NotFound,
+            else => return Error.StorageFailure,
+        };
+    }
+
+    /// Append the hash of every block file to `out`
+    pub fn list(self: *LooseStore, allocator: std.mem.Allocator, out: *std.ArrayList(BlockHash)) Error!void {
+        const blocks_path = try std.fmt.allocPrint(allocator, "{s}/blocks", .{self.base_path});
+        defer allocator.free(blocks_path);
+
+        var blocks_dir = std.fs.cwd().openDir(blocks_path, .{ .iterate = true }) catch |err| switch (err) {
+            error.FileNotFound => return, // Empty store
+            else => return Error.StorageFailure,
+        };
+        defer blocks_dir.close();
+
+        // Walk through all subdirectories
+        var walker = try blocks_dir.walk(allocator);
+        defer walker.deinit();
+
+        while (walker.next() catch return Error.StorageFailure) |entry| {
+            if (entry.kind == .file) {
+                // Skip .tmp files
+                if (std.mem.endsWith(u8, entry.basename, ".tmp")) continue;
+
+                // Parse hex filename to hash (SHA3-256 = 32 bytes = 64 hex chars)
+                if (entry.basename.len == 64) {
+                    var hash: BlockHash = undefined;
+                    _ = std.fmt.hexToBytes(&hash, entry.basename) catch continue;
+                    try out.append(allocator, hash);
+                }
+            }
+        }
     }
 };
 
@@ -146,10 +637,11 @@ test "blockstore init" {
 
     // Create a temporary directory for testing
     const test_dir = "zig-cache/test-blockstore";
-    var store = try BlockStore.init(allocator, test_dir);
-    defer store.deinit();
+    var loose = try LooseStore.init(allocator, test_dir);
+    defer loose.deinit();
 
-    try std.testing.expect(std.mem.eql(u8, store.base_path, test_dir));
+    try std.testing.expect(std.mem.eql(u8, loose.base_path, test_dir));
+    try std.testing.expect(loose.base_path.ptr != test_dir.ptr); // Owned copy
 }
 
 test "blockstore operations compile" {
@@ -218,4 +710,45 @@ test "blockstore put and get" {
 
     // Verify signature
     try retrieved.verify(allocator);
+
+    // Zero-copy read sees the same block
+    var stored = try store.read(block.hash);
+    defer stored.deinit();
+    try std.testing.expectEqualStrings(block.data, stored.view.data);
+    try std.testing.expectEqualSlices(u8, &block.hash, &stored.view.computeHash());
+    try stored.view.verify(allocator);
+
+    // Loose backend through the interface, forcing the mmap path
+    var loose = try LooseStore.init(allocator, test_dir ++ "-loose");
+    defer loose.deinit();
+    loose.mmap_threshold = 0;
+
+    const loose_store = loose.blockStore();
+    try loose_store.put(block.hash, &block);
+
+    var mapped = try loose_store.read(block.hash);
+    defer mapped.deinit();
+    if (mmap_supported) try std.testing.expect(mapped.backing == .mapped);
+    try std.testing.expectEqualStrings(block.data, mapped.view.data);
+    try mapped.view.verify(allocator);
+
+    // Header probe reads only the prefix
+    try std.testing.expectEqual(BlockType.content, try loose_store.peekType(block.hash));
+    const header = try loose_store.readHeader(block.hash);
+    try std.testing.expectEqual(mapped.view.bytes.len, header.blockLength());
+
+    // Batch put, durable: the same block again is overwritten in place
+    loose.durable = true;
+    const serialized = try block.serialize(allocator);
+    defer allocator.free(serialized);
+    try loose_store.putMany(&.{
+        .{ .hash = block.hash, .bytes = serialized },
+        .{ .hash = block.hash, .bytes = serialized },
+    });
+    try std.testing.expect(try loose_store.has(block.hash));
+
+    // Delete removes the block
+    try loose_store.delete(block.hash);
+    try std.testing.expect(!try loose_store.has(block.hash));
+    try std.testing.expectError(error.NotFound, loose_store.delete(block.hash));
 }
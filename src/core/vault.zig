@@ -35,29 +35,104 @@
 //! - Metadata encrypted with vault master key
 //! - All blocks signed with ML-DSA-65
 //! - Master key derived from identity via HKDF
+//!
+//! ## Threads
+//!
+//! Every vault handle may be used from several threads at once, given a
+//! thread-safe allocator: adds, gets, listing, shares and verification
+//! all run concurrently. The block stores lock internally (readers in
+//! parallel), as do the verified set, key registry and block cache, and
+//! the file index sits behind a reader-writer lock. One handle loads the
+//! identity and derives the master key once for all threads. Settings
+//! such as `chunk_size` and `ingest_threads` must be fixed before other
+//! threads start.
 
 const std = @import("std");
 const Identity = @import("identity.zig").Identity;
-const Block = @import("block.zig").Block;
+const BlockView = @import("block.zig").BlockView;
+const BlockType = @import("block.zig").BlockType;
 const BlockStore = @import("store.zig").BlockStore;
 const BlockHash = @import("store.zig").BlockHash;
+const StoredBlock = @import("store.zig").StoredBlock;
 const FileMetadata = @import("metadata.zig").FileMetadata;
+const manifest = @import("manifest.zig");
+const FileIndex = @import("index.zig").FileIndex;
+const VerifiedSet = @import("verified.zig").VerifiedSet;
+const KeyRegistry = @import("keys.zig").KeyRegistry;
+const ingest = @import("ingest.zig");
+const cdc = @import("cdc.zig");
+const BatchRoot = @import("batch.zig").Root;
+const rootBlockOf = @import("batch.zig").rootBlockOf;
+const verifyInclusion = @import("batch.zig").verifyInclusion;
+const verify = @import("verify.zig");
+const ChunkManifest = manifest.ChunkManifest;
 const ShareToken = @import("share.zig").ShareToken;
 const encryptShareToken = @import("share.zig").encryptShareToken;
-const decryptShareToken = @import("share.zig").decryptShareToken;
+const decryptShareTokenWith = @import("share.zig").decryptShareTokenWith;
 const crypto = @import("crypto.zig");
-const encryptData = @import("block.zig").encryptData;
+const encryptDataInto = @import("block.zig").encryptDataInto;
+const BlockBuilder = @import("block.zig").BlockBuilder;
+const serializedLengthFor = @import("block.zig").serializedLengthFor;
+const compact_version = @import("block.zig").compact_version;
+const batched_version = @import("block.zig").batched_version;
+const keyId = @import("block.zig").keyId;
 const decryptData = @import("block.zig").decryptData;
+const decryptDataInto = @import("block.zig").decryptDataInto;
+const cache = @import("cache.zig");
+const BlockCache = cache.BlockCache;
 
 pub const Vault = struct {
     identity: Identity,
     store: BlockStore,
+    /// Borrowed; only read during init
     vault_path: []const u8,
     master_key: [32]u8,
     allocator: std.mem.Allocator,
+    /// Plaintext bytes per content chunk for new files
+    chunk_size: usize = manifest.default_chunk_size,
+    /// Threads used to encrypt and sign chunks on add (0 = one per CPU).
+    /// Values above 1 require a thread-safe allocator.
+    ingest_threads: usize = 1,
+    /// Dedup mode for new files: content-defined chunks under convergent
+    /// keys, so content already in the vault is not stored again. Null
+    /// (the default) keeps fixed-size chunks under a per-file key.
+    dedup: ?cdc.Params = null,
+    /// Content chunks signed together under one Merkle batch root (see
+    /// `batch.zig`), at most 256; 0 (the default) signs every chunk
+    signature_batch: u16 = 0,
+    /// Encrypted listing cache in `index.db`; null lists by scanning blocks
+    index: ?FileIndex = null,
+    /// Verified blocks kept in memory across gets; see `setCacheLimits`
+    cache: *BlockCache,
+    /// How signatures are checked when blocks are read
+    verify_mode: VerifyMode = .memo,
+    /// Blocks whose signatures have verified (`verified.db`); null
+    /// verifies on every read
+    verified: ?VerifiedSet = null,
+    /// Author keys for compact blocks (`keys.db`); null only knows the
+    /// vault's own key
+    keys: ?KeyRegistry = null,
+    /// Write new blocks in the compact format, naming the author by key
+    /// fingerprint instead of embedding the 1952-byte key. Off by default:
+    /// older builds cannot read compact blocks or the V2 exports that
+    /// carry them.
+    compact_blocks: bool = false,
+    /// Guards `index` so it can be read and appended from several threads
+    index_lock: std.Thread.RwLock = .{},
 
     /// Initialize or load a vault
     pub fn init(allocator: std.mem.Allocator, vault_path: []const u8) !Vault {
+        var store = try BlockStore.init(allocator, vault_path);
+        errdefer store.deinit();
+
+        return initWithStore(allocator, vault_path, store);
+    }
+
+    /// Initialize or load a vault whose blocks live in `store`
+    ///
+    /// The identity is still kept under `vault_path`. On success the vault
+    /// owns the handle and releases it in `deinit`.
+    pub fn initWithStore(allocator: std.mem.Allocator, vault_path: []const u8, store: BlockStore) !Vault {
         // Create vault directory if it doesn't exist
         std.fs.cwd().makePath(vault_path) catch |err| switch (err) {
             error.PathAlreadyExists => {},
@@ -85,16 +160,31 @@ pub const Vault = struct {
         // Derive vault master key from identity
         const master_key = deriveMasterKey(&identity.secret_key);
 
-        // Initialize block store
-        const store = try BlockStore.init(allocator, vault_path);
+        const block_cache = try BlockCache.create(allocator, .{});
+        errdefer block_cache.destroy();
 
-        return Vault{
+        var vault = Vault{
             .identity = identity,
             .store = store,
             .vault_path = vault_path,
             .master_key = master_key,
             .allocator = allocator,
+            .index = try FileIndex.open(allocator, vault_path, master_key),
+            .cache = block_cache,
         };
+        errdefer vault.index.?.deinit();
+
+        vault.verified = try VerifiedSet.open(allocator, vault_path, master_key);
+        errdefer vault.verified.?.deinit();
+
+        vault.keys = try KeyRegistry.open(allocator, vault_path);
+        errdefer vault.keys.?.deinit();
+        _ = try vault.keys.?.register(&identity.public_key);
+
+        // First open, or the index was unreadable: rebuild it once
+        if (vault.index.?.needs_rebuild) try vault.rebuildIndex();
+
+        return vault;
     }
 
     /// Derive vault master key from identity secret key using HKDF
@@ -109,106 +199,263 @@ pub const Vault = struct {
         return master_key;
     }
 
+    /// Derive a subkey of the master key for one purpose
+    fn deriveKey(self: *const Vault, context: []const u8) [32]u8 {
+        const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &self.master_key);
+
+        var key: [32]u8 = undefined;
+        crypto.HkdfSha3_256.expand(&key, context, prk);
+        return key;
+    }
+
     /// Add a file to the vault with full encryption
     pub fn addFile(self: *Vault, file_path: []const u8) !BlockHash {
-        // 1. Read file
-        const plaintext = try std.fs.cwd().readFileAlloc(
-            file_path,
-            self.allocator,
-            @enumFromInt(100 * 1024 * 1024), // 100MB max
-        );
-        defer self.allocator.free(plaintext);
+        const file = try std.fs.cwd().openFile(file_path, .{});
+        defer file.close();
+
+        return try self.addFileHandle(file, file_path);
+    }
+
+    /// Add an already-open file to the vault with full encryption
+    ///
+    /// The file is read in `chunk_size` pieces, so memory use stays flat
+    /// regardless of file size. `name` is recorded as the filename and used
+    /// for MIME detection; the handle is not closed. Chunks are sealed on
+    /// `ingest_threads` threads and stored in file order.
+    pub fn addFileHandle(self: *Vault, file: std.fs.File, name: []const u8) !BlockHash {
+        return self.storeFile(file, name, null);
+    }
+
+    /// Store a new version of the file whose metadata block is `previous`
+    pub fn updateFile(self: *Vault, previous: BlockHash, file_path: []const u8) !BlockHash {
+        const file = try std.fs.cwd().openFile(file_path, .{});
+        defer file.close();
+
+        return try self.updateFileHandle(previous, file, file_path);
+    }
+
+    /// Store a new version of a file from an open handle, re-encrypting
+    /// only the chunks that changed
+    ///
+    /// The new version is always chunked in dedup mode (`dedup`, or the
+    /// default `cdc.Params` when unset). Chunks whose content appears in
+    /// the previous version are only read and hashed: their blocks are
+    /// reused without encrypting, signing or writing anything. The first
+    /// update of a file added outside dedup mode seals every chunk.
+    ///
+    /// The new manifest is chained to `previous` through its `prev_hash`
+    /// (see `listVersions`), and `previous` leaves the file listing.
+    pub fn updateFileHandle(self: *Vault, previous: BlockHash, file: std.fs.File, name: []const u8) !BlockHash {
+        var stored = try self.readVerified(previous, .metadata);
+        defer stored.deinit();
+        if (stored.view.block_type != .metadata) return error.InvalidBlock;
+
+        var old_metadata = try self.openMetadata(&stored.view);
+        defer old_metadata.deinit(self.allocator);
+
+        // Chunk keys of the previous version, if it has any
+        var reuse = std.AutoHashMap(manifest.ChunkKey, BlockHash).init(self.allocator);
+        defer reuse.deinit();
+        {
+            var stored_content = try self.readVerified(old_metadata.content_hash, .metadata);
+            defer stored_content.deinit();
+
+            if (stored_content.view.block_type == .manifest) {
+                var old_manifest = try self.openManifest(&stored_content.view, old_metadata.content_key, old_metadata.content_nonce);
+                defer old_manifest.deinit(self.allocator);
+
+                if (old_manifest.keys) |keys| {
+                    try reuse.ensureTotalCapacity(@intCast(keys.len));
+                    for (keys, old_manifest.chunks) |key, hash| reuse.putAssumeCapacity(key, hash);
+                }
+            }
+        }
+
+        const hash = try self.storeFile(file, name, .{ .hash = previous, .reuse = &reuse });
+
+        if (self.index) |*index| {
+            self.index_lock.lock();
+            defer self.index_lock.unlock();
+            try index.remove(previous);
+        }
+        return hash;
+    }
 
-        // 2. Generate per-file encryption key and nonce
+    /// Earlier version of a file being stored
+    const PreviousVersion = struct {
+        /// Its metadata block
+        hash: BlockHash,
+        /// Its chunk blocks by convergent key
+        reuse: *const std.AutoHashMap(manifest.ChunkKey, BlockHash),
+    };
+
+    /// Ingest `file` and store its manifest, metadata and index entry
+    fn storeFile(self: *Vault, file: std.fs.File, name: []const u8, previous: ?PreviousVersion) !BlockHash {
+        // 1. Generate per-file encryption key and base nonce
         var content_key: [32]u8 = undefined;
         crypto.random.bytes(&content_key);
 
         var content_nonce: [12]u8 = undefined;
         crypto.random.bytes(&content_nonce);
 
-        // 3. Encrypt file data
-        const ciphertext = try encryptData(
-            plaintext,
-            content_key,
-            content_nonce,
-            self.allocator,
-        );
-        defer self.allocator.free(ciphertext);
+        // 2. Encrypt, sign and store each chunk as its own content block
+        var out = ingest.Output{};
+        defer out.deinit(self.allocator);
+
+        const signing_key = try self.identity.signingKey();
+        var job = ingest.Job{
+            .content_key = content_key,
+            .content_nonce = content_nonce,
+            .author = &self.identity.public_key,
+            .signing_key = &signing_key,
+            .block_version = self.blockVersion(),
+            .chunk_size = self.chunk_size,
+            .signature_batch = self.signature_batch,
+        };
+
+        var gear: cdc.Gear = undefined;
+        // Updates always chunk in dedup mode so their chunks can be matched
+        const dedup: ?cdc.Params = if (self.dedup) |params| params else if (previous != null) cdc.Params{} else null;
+        if (dedup) |params| {
+            try params.validate();
+            gear = cdc.Gear.fromKey(self.deriveKey("zault-cdc-gear-key-v1"));
+            job.chunk_size = params.max_size;
+            job.chunking = .{ .gear = &gear, .params = params };
+            job.convergence_key = self.deriveKey("zault-convergent-key-v1");
+            if (previous) |version| job.reuse = version.reuse;
+        }
+        defer if (job.convergence_key) |*key| std.crypto.secureZero(u8, key);
+
+        const total_size = try ingest.run(self.allocator, file, &self.store, job, ingest.resolveThreads(self.ingest_threads), &out);
 
-        // 4. Create content block
-        var content_block = Block{
+        // 3. Create and store the chunk manifest (encrypted with the file key)
+        const chunk_manifest = ChunkManifest{
             .version = 0x01,
-            .block_type = .content,
-            .timestamp = 0,
-            .author = self.identity.public_key,
-            .data = ciphertext,
-            .nonce = content_nonce,
-            .signature = undefined,
-            .prev_hash = [_]u8{0} ** 32,
-            .hash = undefined,
+            .chunk_size = @intCast(job.chunk_size),
+            .total_size = total_size,
+            .chunks = out.chunks.items,
+            .keys = if (job.convergence_key != null) out.keys.items else null,
         };
 
-        // 5. Sign content block
-        try content_block.sign(&self.identity.secret_key, self.allocator);
-        content_block.hash = content_block.computeHash();
+        const manifest_bytes = try chunk_manifest.serialize(self.allocator);
+        defer self.allocator.free(manifest_bytes);
 
-        // 6. Store content block
-        try self.store.put(content_block.hash, &content_block);
+        // A new version's manifest points back at the previous metadata
+        const prev_hash = if (previous) |version| version.hash else [_]u8{0} ** 32;
+        const manifest_hash = try self.storeEncrypted(.manifest, manifest_bytes, content_key, content_nonce, prev_hash);
 
-        // 7. Create metadata
-        const basename = std.fs.path.basename(file_path);
-        const mime_type = detectMimeType(file_path);
+        // 4. Create metadata
+        const basename = std.fs.path.basename(name);
+        const mime_type = detectMimeType(name);
 
         const file_metadata = FileMetadata{
             .version = 0x01,
             .filename = basename,
-            .size = plaintext.len,
+            .size = total_size,
             .mime_type = mime_type,
             .created = 0,
             .modified = 0,
-            .content_hash = content_block.hash,
+            .content_hash = manifest_hash,
             .content_key = content_key,
             .content_nonce = content_nonce,
         };
 
-        // 8. Serialize metadata
+        // 5. Serialize metadata
         const metadata_bytes = try file_metadata.serialize(self.allocator);
         defer self.allocator.free(metadata_bytes);
 
-        // 9. Encrypt metadata with vault master key
+        // 6. Encrypt metadata with vault master key
         var metadata_nonce: [12]u8 = undefined;
         crypto.random.bytes(&metadata_nonce);
 
-        const encrypted_metadata = try encryptData(
-            metadata_bytes,
-            self.master_key,
-            metadata_nonce,
-            self.allocator,
-        );
-        defer self.allocator.free(encrypted_metadata);
-
-        // 10. Create metadata block
-        var metadata_block = Block{
-            .version = 0x01,
-            .block_type = .metadata,
-            .timestamp = 0,
-            .author = self.identity.public_key,
-            .data = encrypted_metadata,
-            .nonce = metadata_nonce,
-            .signature = undefined,
-            .prev_hash = content_block.hash, // Chain to content
-            .hash = undefined,
-        };
+        // 7. Sign and store metadata block, chained to the manifest
+        const metadata_hash = try self.storeEncrypted(.metadata, metadata_bytes, self.master_key, metadata_nonce, manifest_hash);
 
-        // 11. Sign metadata block
-        try metadata_block.sign(&self.identity.secret_key, self.allocator);
-        metadata_block.hash = metadata_block.computeHash();
+        // 8. Record it in the file index
+        if (self.index) |*index| {
+            self.index_lock.lock();
+            defer self.index_lock.unlock();
 
-        // 12. Store metadata block
-        try self.store.put(metadata_block.hash, &metadata_block);
+            try index.put(.{
+                .hash = metadata_hash,
+                .filename = file_metadata.filename,
+                .size = file_metadata.size,
+                .mime_type = file_metadata.mime_type,
+                .created = file_metadata.created,
+            });
+        }
 
         // Return metadata block hash (user stores this)
-        return metadata_block.hash;
+        return metadata_hash;
+    }
+
+    /// Encrypt `plaintext` into a new block authored by this vault, then
+    /// sign, hash and store it
+    ///
+    /// The ciphertext is written straight into the serialized block, so the
+    /// only allocation is the block image itself.
+    fn storeEncrypted(
+        self: *Vault,
+        block_type: BlockType,
+        plaintext: []const u8,
+        key: [32]u8,
+        nonce: [12]u8,
+        prev_hash: BlockHash,
+    ) !BlockHash {
+        const version = self.blockVersion();
+        const image = try self.allocator.alloc(u8, serializedLengthFor(version, plaintext.len + crypto.ChaCha20Poly1305.tag_length));
+        defer self.allocator.free(image);
+
+        var builder = BlockBuilder.init(image, .{
+            .version = version,
+            .block_type = block_type,
+            .author = &self.identity.public_key,
+            .nonce = nonce,
+            .prev_hash = prev_hash,
+        });
+        encryptDataInto(builder.payload(), plaintext, key, nonce);
+
+        const signing_key = try self.identity.signingKey();
+        const hash = try builder.seal(&signing_key);
+
+        try self.store.putBytes(hash, image);
+        return hash;
+    }
+
+    /// Format of new blocks
+    fn blockVersion(self: *const Vault) u8 {
+        return if (self.compact_blocks) compact_version else 0x01;
+    }
+
+    /// Check a block's signature, or for a batch-signed block its proof
+    /// against the batch root
+    fn verifyView(self: *Vault, view: *const BlockView) !void {
+        if (view.version == batched_version) {
+            var root = try self.readBatchRoot(try rootBlockOf(view));
+            defer root.deinit();
+            return verifyInclusion(view, try BatchRoot.parse(&root.view));
+        }
+        return self.verifySignature(view);
+    }
+
+    /// Check a block's signature, finding a compact block's author key
+    /// in the registry (or the vault's own key)
+    fn verifySignature(self: *Vault, view: *const BlockView) !void {
+        if (self.keys) |*registry| return registry.verify(view);
+
+        switch (view.author) {
+            .key => try view.verify(self.allocator),
+            .id => |id| {
+                const own = keyId(&self.identity.public_key);
+                if (!std.mem.eql(u8, id, &own)) return error.UnknownAuthor;
+                try view.verifyWith(try crypto.MLDSA65.PublicKey.fromBytes(self.identity.public_key));
+            },
+        }
+    }
+
+    /// Record an author key, so its compact blocks can be verified
+    pub fn registerKey(self: *Vault, key: *const [crypto.MLDSA65.PublicKey.encoded_length]u8) !void {
+        if (self.keys) |*registry| _ = try registry.register(key);
     }
 
     /// Simple MIME type detection based on file extension
@@ -226,85 +473,263 @@ pub const Vault = struct {
 
     /// Get a file from the vault with full decryption
     pub fn getFile(self: *Vault, hash: BlockHash, output_path: []const u8) !void {
-        // 1. Retrieve metadata block
-        const metadata_block = try self.store.get(hash);
-        defer self.allocator.free(metadata_block.data);
+        const file = try std.fs.cwd().createFile(output_path, .{});
+        defer file.close();
 
-        // 2. Verify metadata signature
-        try metadata_block.verify(self.allocator);
+        try self.streamFile(hash, ContentSink.fromFile(&file));
+    }
 
-        // 3. Decrypt metadata with vault master key
+    /// Decrypt a file chunk by chunk into `sink`
+    ///
+    /// Memory use is bounded by one chunk regardless of file size, and the
+    /// first chunk reaches the sink before later chunks are read.
+    pub fn streamFile(self: *Vault, hash: BlockHash, sink: ContentSink) !void {
+        // 1. Retrieve and verify the metadata block (cached when hot)
+        var stored = try self.readVerified(hash, .metadata);
+        defer stored.deinit();
+        const metadata_block = &stored.view;
+
+        // 2. Decrypt metadata with vault master key
         const metadata_bytes = try decryptData(
             metadata_block.data,
             self.master_key,
-            metadata_block.nonce,
+            metadata_block.nonce.*,
             self.allocator,
         );
         defer self.allocator.free(metadata_bytes);
 
-        // 4. Parse metadata
+        // 3. Parse metadata
         var file_metadata = try FileMetadata.deserialize(metadata_bytes, self.allocator);
         defer file_metadata.deinit(self.allocator);
 
-        // 5. Retrieve content block
-        const content_block = try self.store.get(file_metadata.content_hash);
-        defer self.allocator.free(content_block.data);
-
-        // 6. Verify content signature
-        try content_block.verify(self.allocator);
-
-        // 7. Decrypt content with per-file key
-        const plaintext = try decryptData(
-            content_block.data,
+        // 4. Decrypt content with per-file key into the sink
+        try self.streamContent(
+            file_metadata.content_hash,
             file_metadata.content_key,
             file_metadata.content_nonce,
-            self.allocator,
+            sink,
         );
+    }
+
+    /// How block signatures are checked on read
+    pub const VerifyMode = enum {
+        /// Verify the ML-DSA signature on every read
+        always,
+        /// Verify once per vault and record it in `verified.db`; later
+        /// reads only check that the block still hashes to its address
+        memo,
+    };
+
+    /// Check a block read for `hash`. Returns true if its signature was
+    /// verified just now, false if the verified set vouched for it.
+    fn checkBlock(self: *Vault, hash: BlockHash, view: *const BlockView) !bool {
+        if (self.memoVouches(hash, view)) return false;
+
+        try self.verifyView(view);
+        return true;
+    }
+
+    /// Whether the verified set holds `view` and it still hashes to `hash`
+    fn memoVouches(self: *Vault, hash: BlockHash, view: *const BlockView) bool {
+        if (self.verify_mode != .memo) return false;
+        const memo = if (self.verified) |*open_memo| open_memo else return false;
+        if (!std.mem.eql(u8, view.hash, &hash) or !memo.contains(view)) return false;
+
+        const computed = view.computeHash();
+        return std.mem.eql(u8, &computed, &hash);
+    }
+
+    /// `readVerified` for the batch root of a batch-signed block. Roots
+    /// are small and shared by many chunks, so they stay in the metadata
+    /// cache.
+    fn readBatchRoot(self: *Vault, hash: BlockHash) !StoredBlock {
+        if (self.cache.get(hash, .metadata)) |hit| return hit;
+
+        var stored = try self.store.read(hash);
+        errdefer stored.deinit();
+        if (stored.view.block_type != .batch) return error.InvalidBlock;
+        if (!self.memoVouches(hash, &stored.view)) {
+            try self.verifySignature(&stored.view);
+            self.rememberVerified(&.{&stored.view});
+        }
+
+        self.cache.insert(&stored.view);
+        return stored;
+    }
+
+    /// Add freshly verified blocks to the verified set. Best effort: a
+    /// failed write only means they are verified again next time.
+    fn rememberVerified(self: *Vault, views: []const *const BlockView) void {
+        if (self.verify_mode != .memo or views.len == 0) return;
+        const memo = if (self.verified) |*open_memo| open_memo else return;
+        memo.addMany(views) catch {};
+    }
+
+    /// Read a block and check its signature, or take it verified from
+    /// the cache. The result is cached if its kind has room.
+    fn readVerified(self: *Vault, hash: BlockHash, kind: cache.Kind) !StoredBlock {
+        if (self.cache.get(hash, kind)) |hit| return hit;
+
+        var stored = try self.store.read(hash);
+        errdefer stored.deinit();
+        if (try self.checkBlock(hash, &stored.view)) self.rememberVerified(&.{&stored.view});
+
+        self.cache.insert(&stored.view);
+        return stored;
+    }
+
+    /// `readVerified` for content chunks; cache misses are fetched from
+    /// the store in one `readMany`
+    fn readManyVerified(self: *Vault, hashes: []const BlockHash, out: []StoredBlock) !void {
+        std.debug.assert(hashes.len <= read_batch and out.len == hashes.len);
+
+        var missing: [read_batch]BlockHash = undefined;
+        var missing_at: [read_batch]usize = undefined;
+        var missing_count: usize = 0;
+        for (hashes, out, 0..) |hash, *stored, i| {
+            if (self.cache.get(hash, .content)) |hit| {
+                stored.* = hit;
+                continue;
+            }
+            stored.* = .{ .view = undefined, .backing = .borrowed };
+            missing[missing_count] = hash;
+            missing_at[missing_count] = i;
+            missing_count += 1;
+        }
+        errdefer for (out) |*stored| stored.deinit();
+        if (missing_count == 0) return;
+
+        var fetched: [read_batch]StoredBlock = undefined;
+        try self.store.readMany(missing[0..missing_count], fetched[0..missing_count]);
+        for (fetched[0..missing_count], missing_at[0..missing_count]) |stored, i| out[i] = stored;
+
+        var checked: [read_batch]*const BlockView = undefined;
+        var checked_count: usize = 0;
+        for (missing_at[0..missing_count]) |i| {
+            if (try self.checkBlock(hashes[i], &out[i].view)) {
+                checked[checked_count] = &out[i].view;
+                checked_count += 1;
+            }
+            self.cache.insert(&out[i].view);
+        }
+        self.rememberVerified(checked[0..checked_count]);
+    }
+
+    /// Destination for decrypted file content
+    pub const ContentSink = struct {
+        context: *anyopaque,
+        writeFn: *const fn (context: *anyopaque, bytes: []const u8) anyerror!void,
+
+        pub fn write(self: ContentSink, bytes: []const u8) !void {
+            return self.writeFn(self.context, bytes);
+        }
+
+        /// Sink that appends to an open file
+        pub fn fromFile(file: *const std.fs.File) ContentSink {
+            return .{ .context = @constCast(file), .writeFn = writeToFile };
+        }
+
+        fn writeToFile(context: *anyopaque, bytes: []const u8) anyerror!void {
+            const file: *const std.fs.File = @ptrCast(@alignCast(context));
+            try file.writeAll(bytes);
+        }
+    };
+
+    /// Decrypt file content (a chunk manifest or a legacy single content
+    /// block) into `sink`
+    fn streamContent(
+        self: *Vault,
+        content_hash: BlockHash,
+        content_key: [32]u8,
+        content_nonce: [12]u8,
+        sink: ContentSink,
+    ) !void {
+        var stored = try self.readVerified(content_hash, .metadata);
+        defer stored.deinit();
+        const content_block = &stored.view;
+
+        if (content_block.block_type != .manifest) {
+            // Legacy layout: the whole file in one content block
+            const plaintext = try decryptData(
+                content_block.data,
+                content_key,
+                content_nonce,
+                self.allocator,
+            );
+            defer self.allocator.free(plaintext);
+
+            try sink.write(plaintext);
+            return;
+        }
+
+        // Chunked layout: decrypt the manifest, then each chunk in order
+        var chunk_manifest = try self.openManifest(content_block, content_key, content_nonce);
+        defer chunk_manifest.deinit(self.allocator);
+
+        // One plaintext buffer, reused for every chunk
+        const plaintext = try self.allocator.alloc(u8, chunk_manifest.chunk_size);
         defer self.allocator.free(plaintext);
 
-        // 8. Write plaintext to output file
-        const file = try std.fs.cwd().createFile(output_path, .{});
-        defer file.close();
-        try file.writeAll(plaintext);
+        // Chunks are fetched a batch at a time so the store can overlap
+        // the reads, then decrypted in order
+        var batch: [read_batch]StoredBlock = undefined;
+        var start: usize = 0;
+        while (start < chunk_manifest.chunks.len) {
+            const hashes = chunk_manifest.chunks[start..@min(start + read_batch, chunk_manifest.chunks.len)];
+            const fetched = batch[0..hashes.len];
+            try self.readManyVerified(hashes, fetched);
+            defer for (fetched) |*stored_chunk| stored_chunk.deinit();
+
+            for (fetched, start..) |*stored_chunk, i| {
+                const cipher = chunk_manifest.chunkCipher(i, content_key, content_nonce);
+                try decryptChunk(&stored_chunk.view, plaintext, cipher.key, cipher.nonce, sink);
+            }
+            start += hashes.len;
+        }
     }
 
-    /// List all blocks in the vault
-    pub fn listBlocks(self: *Vault) !std.ArrayList(BlockHash) {
-        var list = std.ArrayList(BlockHash){};
+    /// Decrypt one verified content chunk into `sink`
+    fn decryptChunk(
+        chunk_block: *const BlockView,
+        plaintext: []u8,
+        content_key: [32]u8,
+        chunk_nonce: [12]u8,
+        sink: ContentSink,
+    ) !void {
+        if (chunk_block.block_type != .content) return error.InvalidBlock;
+
+        const tag_length = crypto.ChaCha20Poly1305.tag_length;
+        if (chunk_block.data.len < tag_length or chunk_block.data.len - tag_length > plaintext.len) {
+            return error.InvalidBlock;
+        }
+        const chunk_plaintext = plaintext[0 .. chunk_block.data.len - tag_length];
 
-        const blocks_path = try std.fmt.allocPrint(
+        try decryptDataInto(chunk_plaintext, chunk_block.data, content_key, chunk_nonce);
+
+        try sink.write(chunk_plaintext);
+    }
+
+    /// Decrypt and parse a manifest block
+    fn openManifest(
+        self: *Vault,
+        manifest_block: *const BlockView,
+        content_key: [32]u8,
+        content_nonce: [12]u8,
+    ) !ChunkManifest {
+        const manifest_bytes = try decryptData(
+            manifest_block.data,
+            content_key,
+            content_nonce,
             self.allocator,
-            "{s}/blocks",
-            .{self.vault_path},
         );
-        defer self.allocator.free(blocks_path);
+        defer self.allocator.free(manifest_bytes);
 
-        // Try to open blocks directory
-        var blocks_dir = std.fs.cwd().openDir(blocks_path, .{ .iterate = true }) catch |err| switch (err) {
-            error.FileNotFound => return list, // Empty vault
-            else => return err,
-        };
-        defer blocks_dir.close();
-
-        // Walk through all subdirectories
-        var walker = try blocks_dir.walk(self.allocator);
-        defer walker.deinit();
-
-        while (try walker.next()) |entry| {
-            if (entry.kind == .file) {
-                // Skip .tmp files
-                if (std.mem.endsWith(u8, entry.basename, ".tmp")) continue;
-
-                // Parse hex filename to hash (SHA3-256 = 32 bytes = 64 hex chars)
-                if (entry.basename.len == 64) {
-                    var hash: BlockHash = undefined;
-                    _ = try std.fmt.hexToBytes(&hash, entry.basename);
-                    try list.append(self.allocator, hash);
-                }
-            }
-        }
+        return try ChunkManifest.deserialize(manifest_bytes, self.allocator);
+    }
 
-        return list;
+    /// List all blocks in the vault
+    pub fn listBlocks(self: *Vault) !std.ArrayList(BlockHash) {
+        return self.store.list(self.allocator);
     }
 
     /// File information for listing
@@ -317,32 +742,122 @@ pub const Vault = struct {
     };
 
     /// List all files in the vault with metadata
+    ///
+    /// Served from the file index when one is open: one lookup per file
+    /// to skip blocks that have since been removed, and no decryption.
     pub fn listFiles(self: *Vault) !std.ArrayList(FileInfo) {
+        const index = if (self.index) |*open_index| open_index else return self.scanFiles();
+
+        var list = std.ArrayList(FileInfo){};
+        errdefer freeFileInfos(self.allocator, &list);
+
+        self.index_lock.lockShared();
+        defer self.index_lock.unlockShared();
+
+        try list.ensureTotalCapacity(self.allocator, index.entries.items.len);
+        for (index.entries.items) |entry| {
+            if (!try self.store.has(entry.hash)) continue;
+
+            const filename = try self.allocator.dupe(u8, entry.filename);
+            errdefer self.allocator.free(filename);
+            const mime_type = try self.allocator.dupe(u8, entry.mime_type);
+
+            list.appendAssumeCapacity(FileInfo{
+                .hash = entry.hash,
+                .filename = filename,
+                .size = entry.size,
+                .mime_type = mime_type,
+                .created = entry.created,
+            });
+        }
+
+        return list;
+    }
+
+    /// Metadata hashes of every version of a file, oldest first, ending
+    /// with `hash`
+    ///
+    /// Versions link through their manifests: a metadata block's
+    /// `prev_hash` is its manifest, and an updated file's manifest has the
+    /// previous metadata block as its `prev_hash`.
+    pub fn listVersions(self: *Vault, hash: BlockHash) !std.ArrayList(BlockHash) {
+        var versions = std.ArrayList(BlockHash){};
+        errdefer versions.deinit(self.allocator);
+
+        var current: ?BlockHash = hash;
+        while (current) |version| {
+            try versions.append(self.allocator, version);
+            current = try self.previousVersion(version);
+        }
+
+        std.mem.reverse(BlockHash, versions.items);
+        return versions;
+    }
+
+    /// Metadata block of the version before `hash`, or null for the first
+    fn previousVersion(self: *Vault, hash: BlockHash) !?BlockHash {
+        const content_hash = blk: {
+            var stored = try self.readVerified(hash, .metadata);
+            defer stored.deinit();
+            if (stored.view.block_type != .metadata) return error.InvalidBlock;
+            break :blk stored.view.prev_hash.*;
+        };
+
+        var stored = try self.readVerified(content_hash, .metadata);
+        defer stored.deinit();
+
+        // Legacy single content blocks have no history
+        if (stored.view.block_type != .manifest) return null;
+        const prev_hash = stored.view.prev_hash.*;
+        if (std.mem.allEqual(u8, &prev_hash, 0)) return null;
+        return prev_hash;
+    }
+
+    fn freeFileInfos(allocator: std.mem.Allocator, list: *std.ArrayList(FileInfo)) void {
+        for (list.items) |info| {
+            allocator.free(info.filename);
+            allocator.free(info.mime_type);
+        }
+        list.deinit(allocator);
+    }
+
+    /// List files by decrypting every metadata block in the store
+    fn scanFiles(self: *Vault) !std.ArrayList(FileInfo) {
         var list = std.ArrayList(FileInfo){};
+        errdefer freeFileInfos(self.allocator, &list);
 
         var blocks = try self.listBlocks();
         defer blocks.deinit(self.allocator);
 
+        // Versions replaced by `updateFile` are left out: their hashes are
+        // the `prev_hash` of a newer manifest
+        var superseded = std.AutoHashMap(BlockHash, void).init(self.allocator);
+        defer superseded.deinit();
         for (blocks.items) |hash| {
-            // Try to load as metadata block
-            const block = self.store.get(hash) catch continue;
-            defer self.allocator.free(block.data);
+            const header = self.store.readHeader(hash) catch continue;
+            if (header.block_type != .manifest) continue;
 
-            // Skip if not metadata
-            if (block.block_type != .metadata) continue;
+            var stored = self.store.read(hash) catch continue;
+            defer stored.deinit();
+            const prev_hash = stored.view.prev_hash.*;
+            if (!std.mem.allEqual(u8, &prev_hash, 0)) try superseded.put(prev_hash, {});
+        }
 
-            // Decrypt and parse metadata
-            const metadata_bytes = decryptData(
-                block.data,
-                self.master_key,
-                block.nonce,
-                self.allocator,
-            ) catch continue;
-            defer self.allocator.free(metadata_bytes);
+        for (blocks.items) |hash| {
+            // Classify from the header so content payloads are never read
+            const block_type = self.store.peekType(hash) catch continue;
+            if (block_type != .metadata) continue;
+            if (superseded.contains(hash)) continue;
 
-            var file_metadata = FileMetadata.deserialize(metadata_bytes, self.allocator) catch continue;
-            // Don't defer deinit - we're transferring ownership to FileInfo
+            var stored = self.store.read(hash) catch continue;
+            defer stored.deinit();
+            const block = &stored.view;
 
+            // Skip metadata that isn't ours
+            var file_metadata = self.openMetadata(block) catch continue;
+            errdefer file_metadata.deinit(self.allocator);
+
+            // Ownership of the strings moves to FileInfo
             try list.append(self.allocator, FileInfo{
                 .hash = hash,
                 .filename = file_metadata.filename,
@@ -355,12 +870,74 @@ pub const Vault = struct {
         return list;
     }
 
+    /// Decrypt and parse a metadata block with the vault master key
+    fn openMetadata(self: *Vault, metadata_block: *const BlockView) !FileMetadata {
+        const metadata_bytes = try decryptData(
+            metadata_block.data,
+            self.master_key,
+            metadata_block.nonce.*,
+            self.allocator,
+        );
+        defer self.allocator.free(metadata_bytes);
+
+        return try FileMetadata.deserialize(metadata_bytes, self.allocator);
+    }
+
+    /// Repopulate the file index from the metadata blocks in the store
+    ///
+    /// Only needed when `index.db` is missing or unreadable, or when
+    /// blocks were added to the store behind the vault's back.
+    pub fn rebuildIndex(self: *Vault) !void {
+        const index = if (self.index) |*open_index| open_index else return;
+
+        var files = try self.scanFiles();
+        defer freeFileInfos(self.allocator, &files);
+
+        self.index_lock.lock();
+        defer self.index_lock.unlock();
+
+        try index.reset();
+
+        for (files.items) |info| {
+            try index.put(.{
+                .hash = info.hash,
+                .filename = info.filename,
+                .size = info.size,
+                .mime_type = info.mime_type,
+                .created = info.created,
+            });
+        }
+        index.needs_rebuild = false;
+    }
+
     /// Verify a block's signature
+    ///
+    /// Always checks the signature itself, whatever `verify_mode` says,
+    /// and records the block in the verified set on success.
     pub fn verifyBlock(self: *Vault, hash: BlockHash) !void {
-        const block = try self.store.get(hash);
-        defer self.allocator.free(block.data);
+        var stored = try self.store.read(hash);
+        defer stored.deinit();
+
+        try self.verifyView(&stored.view);
+        self.rememberVerified(&.{&stored.view});
+    }
+
+    /// Verify the hash and signature of every block in the vault
+    ///
+    /// Author keys are parsed once and blocks are checked on `threads`
+    /// threads (0 = one per CPU; above 1 requires a thread-safe allocator).
+    /// Bad blocks are collected in the report rather than stopping the scan.
+    pub fn verifyAll(self: *Vault, threads: usize) !verify.Report {
+        var blocks = try self.listBlocks();
+        defer blocks.deinit(self.allocator);
+
+        return self.verifyBlocks(blocks.items, threads);
+    }
 
-        try block.verify(self.allocator);
+    /// Verify the hash and signature of each block in `hashes`
+    pub fn verifyBlocks(self: *Vault, hashes: []const BlockHash, threads: usize) !verify.Report {
+        const registry = if (self.keys) |*open_registry| open_registry else null;
+        return verify.run(self.allocator, self.store, registry, hashes, ingest.resolveThreads(threads));
     }
 
     /// Create a share token for a file
@@ -372,14 +949,15 @@ pub const Vault = struct {
         allocator: std.mem.Allocator,
     ) ![]u8 {
         // 1. Get the metadata block to extract content key
-        const metadata_block = try self.store.get(file_hash);
-        defer allocator.free(metadata_block.data);
+        var stored = try self.readVerified(file_hash, .metadata);
+        defer stored.deinit();
+        const metadata_block = &stored.view;
 
         // 2. Decrypt metadata
         const metadata_bytes = try decryptData(
             metadata_block.data,
             self.master_key,
-            metadata_block.nonce,
+            metadata_block.nonce.*,
             allocator,
         );
         defer allocator.free(metadata_bytes);
@@ -417,18 +995,18 @@ pub const Vault = struct {
         allocator: std.mem.Allocator,
     ) !ShareInfo {
         // 1. Decrypt share token using our ML-KEM secret key
-        const share_token = try decryptShareToken(
-            encrypted_share,
-            &self.identity.kem_secret_key,
-            allocator,
-        );
+        const kem_key = try self.identity.kemSecretKey();
+        const share_token = try decryptShareTokenWith(encrypted_share, &kem_key, allocator);
 
         // 2. Check expiration
         if (share_token.expires_at < 0) { // TODO: Compare with actual timestamp
             return error.ShareExpired;
         }
 
-        // 3. Return the share info with decryption keys
+        // 3. Learn the sender's key, which their compact blocks only name
+        try self.registerKey(&share_token.granted_by);
+
+        // 4. Return the share info with decryption keys
         return ShareInfo{
             .file_hash = share_token.file_hash,
             .content_key = share_token.content_key,
@@ -444,38 +1022,30 @@ pub const Vault = struct {
         output_path: []const u8,
         allocator: std.mem.Allocator,
     ) !void {
-        // 1. Retrieve metadata block
-        const metadata_block = try self.store.get(share_info.file_hash);
-        defer allocator.free(metadata_block.data);
+        _ = allocator;
 
-        // 2. Verify signature
-        try metadata_block.verify(allocator);
+        const file = try std.fs.cwd().createFile(output_path, .{});
+        defer file.close();
 
-        // 3. Use share_info to get content block directly
-        // (Can't decrypt metadata with our vault key - it's from sender)
-        // Share token provides everything we need
-        const content_hash = metadata_block.prev_hash;
+        try self.streamSharedFile(share_info, ContentSink.fromFile(&file));
+    }
 
-        // 4. Get content block
-        const content_block = try self.store.get(content_hash);
-        defer allocator.free(content_block.data);
+    /// Decrypt a shared file chunk by chunk into `sink`
+    pub fn streamSharedFile(self: *Vault, share_info: ShareInfo, sink: ContentSink) !void {
+        try self.registerKey(&share_info.granted_by);
 
-        // 5. Verify signature
-        try content_block.verify(allocator);
+        // 1. Retrieve and verify the metadata block (cached when hot)
+        var stored = try self.readVerified(share_info.file_hash, .metadata);
+        defer stored.deinit();
+        const metadata_block = &stored.view;
 
-        // 6. Decrypt with share_info keys
-        const plaintext = try decryptData(
-            content_block.data,
-            share_info.content_key,
-            share_info.content_nonce,
-            allocator,
-        );
-        defer allocator.free(plaintext);
+        // 2. Use share_info to get content block directly
+        // (Can't decrypt metadata with our vault key - it's from sender)
+        // Share token provides everything we need
+        const content_hash = metadata_block.prev_hash.*;
 
-        // 7. Write to output
-        const file = try std.fs.cwd().createFile(output_path, .{});
-        defer file.close();
-        try file.writeAll(plaintext);
+        // 3. Decrypt content with share_info keys into the sink
+        try self.streamContent(content_hash, share_info.content_key, share_info.content_nonce, sink);
     }
 
     /// Export blocks to a portable file with dependencies
@@ -488,8 +1058,8 @@ pub const Vault = struct {
         const file = try std.fs.cwd().createFile(output_path, .{});
         defer file.close();
 
-        // Write header
-        try file.writeAll("ZAULT_BLOCKS_V1\n");
+        // Write header; the first key record upgrades it to V2
+        try file.writeAll(export_header_v1);
 
         var exported = std.AutoHashMap(BlockHash, void).init(allocator);
         defer exported.deinit();
@@ -511,16 +1081,17 @@ pub const Vault = struct {
         if (exported.contains(hash)) return;
 
         // Get block
-        const block = try self.store.get(hash);
-        defer allocator.free(block.data);
+        var stored = try self.store.read(hash);
+        defer stored.deinit();
+        const block = &stored.view;
 
-        // If metadata block, export content block first
+        // If metadata block, export content first
         if (block.block_type == .metadata) {
-            // Decrypt metadata to get content hash
+            // Decrypt metadata to get content hash and key
             const metadata_bytes = try decryptData(
                 block.data,
                 self.master_key,
-                block.nonce,
+                block.nonce.*,
                 allocator,
             );
             defer allocator.free(metadata_bytes);
@@ -528,80 +1099,331 @@ pub const Vault = struct {
             var file_metadata = try FileMetadata.deserialize(metadata_bytes, allocator);
             defer file_metadata.deinit(allocator);
 
-            // Recursively export content block
-            try self.exportBlockRecursive(file_metadata.content_hash, file, exported, allocator);
+            // Export manifest and chunks (or legacy content block)
+            try self.exportContent(
+                file_metadata.content_hash,
+                file_metadata.content_key,
+                file_metadata.content_nonce,
+                file,
+                exported,
+                allocator,
+            );
         }
 
-        // Serialize and write block
-        const serialized = try block.serialize(allocator);
-        defer allocator.free(serialized);
-
-        // Write: [size: u64][serialized block]
-        var size_bytes: [8]u8 = undefined;
-        std.mem.writeInt(u64, &size_bytes, serialized.len, .little);
-        try file.writeAll(&size_bytes);
-        try file.writeAll(serialized);
+        try self.writeExportRecord(block, file, exported);
 
         // Mark as exported
         try exported.put(hash, {});
     }
 
-    /// Import blocks from a portable file
-    pub fn importBlocks(
+    fn exportContent(
         self: *Vault,
-        import_path: []const u8,
+        content_hash: BlockHash,
+        content_key: [32]u8,
+        content_nonce: [12]u8,
+        file: std.fs.File,
+        exported: *std.AutoHashMap(BlockHash, void),
         allocator: std.mem.Allocator,
-    ) !std.ArrayList(BlockHash) {
-        var imported = std.ArrayList(BlockHash){};
+    ) !void {
+        if (exported.contains(content_hash)) return;
 
-        const file = try std.fs.cwd().openFile(import_path, .{});
-        defer file.close();
+        var stored = try self.store.read(content_hash);
+        defer stored.deinit();
+        const content_block = &stored.view;
 
-        // Read and verify header
-        var header: [16]u8 = undefined;
-        const header_len = try file.read(&header);
-        if (header_len < 15 or !std.mem.eql(u8, header[0..15], "ZAULT_BLOCKS_V1")) {
-            return error.InvalidExportFile;
+        // Chunks go out before the manifest that references them
+        if (content_block.block_type == .manifest) {
+            var chunk_manifest = try self.openManifest(content_block, content_key, content_nonce);
+            defer chunk_manifest.deinit(self.allocator);
+
+            try self.exportChunks(chunk_manifest.chunks, file, exported);
         }
 
-        // Read blocks
-        while (true) {
-            // Read size
-            var size_bytes: [8]u8 = undefined;
-            const n = try file.read(&size_bytes);
-            if (n == 0 or n != 8) break; // End of file
+        try self.writeExportRecord(content_block, file, exported);
+        try exported.put(content_hash, {});
+    }
 
-            const size = std.mem.readInt(u64, &size_bytes, .little);
+    /// Export content chunks not yet exported, fetching them in batches
+    fn exportChunks(
+        self: *Vault,
+        chunks: []const BlockHash,
+        file: std.fs.File,
+        exported: *std.AutoHashMap(BlockHash, void),
+    ) !void {
+        var pending: [read_batch]BlockHash = undefined;
+        var batch: [read_batch]StoredBlock = undefined;
+
+        var next: usize = 0;
+        while (next < chunks.len) {
+            var count: usize = 0;
+            while (next < chunks.len and count < read_batch) : (next += 1) {
+                const entry = try exported.getOrPut(chunks[next]);
+                if (entry.found_existing) continue;
+                pending[count] = chunks[next];
+                count += 1;
+            }
 
-            // Read serialized block
-            const serialized = try allocator.alloc(u8, size);
-            defer allocator.free(serialized);
+            const fetched = batch[0..count];
+            try self.store.readMany(pending[0..count], fetched);
+            defer for (fetched) |*stored| stored.deinit();
 
-            var total_read: usize = 0;
-            while (total_read < size) {
-                const nread = try file.read(serialized[total_read..]);
-                if (nread == 0) return error.UnexpectedEOF;
+            for (fetched) |*stored| try self.writeExportRecord(&stored.view, file, exported);
+        }
+    }
+
+    /// Write one export record: [size: u64][serialized block]
+    /// The stored bytes are copied out as-is, without re-serializing.
+    ///
+    /// A batch-signed block's batch root goes out first, once per export.
+    fn writeExportRecord(
+        self: *Vault,
+        block: *const BlockView,
+        file: std.fs.File,
+        exported: *std.AutoHashMap(BlockHash, void),
+    ) !void {
+        if (block.version == batched_version) {
+            const root_hash = try rootBlockOf(block);
+            const entry = try exported.getOrPut(root_hash);
+            if (!entry.found_existing) {
+                var root = try self.store.read(root_hash);
+                defer root.deinit();
+                try self.writeBlockRecord(&root.view, file, exported);
+            }
+        }
+
+        try self.writeBlockRecord(block, file, exported);
+    }
+
+    /// Write one block record. A compact block's author key goes out
+    /// first, once per export, as a key record
+    /// ([size: u64]["ZAULTKEY"][public key]); `exported` tracks key
+    /// fingerprints alongside block hashes.
+    fn writeBlockRecord(
+        self: *Vault,
+        block: *const BlockView,
+        file: std.fs.File,
+        exported: *std.AutoHashMap(BlockHash, void),
+    ) !void {
+        var size_bytes: [8]u8 = undefined;
+
+        if (block.author == .id) {
+            const id = block.author.id;
+            const entry = try exported.getOrPut(id.*);
+            if (!entry.found_existing) {
+                const own = keyId(&self.identity.public_key);
+                const key = if (std.mem.eql(u8, id, &own))
+                    self.identity.public_key
+                else if (self.keys) |*registry|
+                    registry.get(id) orelse return error.UnknownAuthor
+                else
+                    return error.UnknownAuthor;
+
+                // Importers that predate key records and compact blocks
+                // reject a V2 file up front instead of failing midway
+                try file.pwriteAll(export_header_v2, 0);
+
+                std.mem.writeInt(u64, &size_bytes, key_record_magic.len + key.len, .little);
+                try file.writeAll(&size_bytes);
+                try file.writeAll(key_record_magic);
+                try file.writeAll(&key);
+            }
+        }
+
+        std.mem.writeInt(u64, &size_bytes, block.bytes.len, .little);
+        try file.writeAll(&size_bytes);
+        try file.writeAll(block.bytes);
+    }
+
+    /// Prefix of an export record carrying an author key
+    const key_record_magic = "ZAULTKEY";
+
+    /// Export file headers, the same length so the header can be
+    /// rewritten in place. V2 files may hold key records and compact or
+    /// batch-signed blocks, which only appear after a key record.
+    const export_header_v1 = "ZAULT_BLOCKS_V1\n";
+    const export_header_v2 = "ZAULT_BLOCKS_V2\n";
+
+    /// Bytes of blocks read ahead before an import batch is stored
+    const import_batch_bytes = 8 * 1024 * 1024;
+
+    /// Chunks fetched per `readMany` on restore and export
+    const read_batch = 8;
+
+    /// Keep up to `queue_depth` block reads and writes in flight during
+    /// import, export and restore, where the store supports it (io_uring
+    /// on Linux pack stores). 0 turns it off.
+    ///
+    /// Returns whether asynchronous I/O is now in use.
+    pub fn setIoQueueDepth(self: *Vault, queue_depth: u16) !bool {
+        return self.store.setIoQueueDepth(queue_depth);
+    }
+
+    /// Bound the memory the block cache may hold for metadata-like blocks
+    /// and for content chunks; 0 disables caching that kind
+    pub fn setCacheLimits(self: *Vault, limits: cache.Limits) void {
+        self.cache.setLimits(limits);
+    }
+
+    /// Block cache hit, miss and eviction counters
+    pub fn cacheStats(self: *Vault) cache.Stats {
+        return self.cache.stats();
+    }
+
+    /// Import blocks from a portable file
+    ///
+    /// Blocks are stored in batches of up to `import_batch_bytes` with one
+    /// `BlockStore.putMany` each.
+    pub fn importBlocks(
+        self: *Vault,
+        import_path: []const u8,
+        allocator: std.mem.Allocator,
+    ) !std.ArrayList(BlockHash) {
+        var imported = std.ArrayList(BlockHash){};
+        errdefer imported.deinit(allocator);
+
+        var batch = ImportBatch{};
+        defer batch.deinit(allocator);
+
+        const file = try std.fs.cwd().openFile(import_path, .{});
+        defer file.close();
+
+        // Read and verify header
+        var header: [export_header_v1.len]u8 = undefined;
+        const header_len = try file.readAll(&header);
+        if (header_len != header.len or
+            !(std.mem.eql(u8, &header, export_header_v1) or std.mem.eql(u8, &header, export_header_v2)))
+        {
+            return error.InvalidExportFile;
+        }
+
+        // Read blocks
+        while (true) {
+            // Read size
+            var size_bytes: [8]u8 = undefined;
+            const n = try file.read(&size_bytes);
+            if (n == 0 or n != 8) break; // End of file
+
+            const size = std.mem.readInt(u64, &size_bytes, .little);
+
+            // Read serialized block
+            const serialized = try allocator.alloc(u8, size);
+            var queued = false;
+            defer if (!queued) allocator.free(serialized);
+
+            var total_read: usize = 0;
+            while (total_read < size) {
+                const nread = try file.read(serialized[total_read..]);
+                if (nread == 0) return error.UnexpectedEOF;
                 total_read += nread;
             }
 
-            // Deserialize
-            const block = try Block.deserialize(serialized, allocator);
-            defer allocator.free(block.data);
+            // Author keys for the compact blocks that follow
+            if (serialized.len == key_record_magic.len + crypto.MLDSA65.PublicKey.encoded_length and
+                std.mem.startsWith(u8, serialized, key_record_magic))
+            {
+                try self.registerKey(serialized[key_record_magic.len..][0..crypto.MLDSA65.PublicKey.encoded_length]);
+                continue;
+            }
+
+            // Parse in place; data borrows from the read buffer
+            const view = try BlockView.parse(serialized);
 
-            // Store (skip if already exists)
-            self.store.put(block.hash, &block) catch |err| switch (err) {
-                error.AlreadyExists => {},
-                else => return err,
-            };
+            try batch.records.append(allocator, .{ .buffer = serialized, .view = view });
+            queued = true;
+            batch.bytes += serialized.len;
+            try imported.append(allocator, view.hash.*);
 
-            try imported.append(allocator, block.hash);
+            if (batch.bytes >= import_batch_bytes) try self.storeImportBatch(&batch, allocator);
         }
 
+        try self.storeImportBatch(&batch, allocator);
         return imported;
     }
 
+    /// Parsed import records waiting to be stored
+    const ImportBatch = struct {
+        records: std.ArrayList(Record) = .{},
+        bytes: usize = 0,
+        /// Metadata of versions replaced by an imported update, across
+        /// the whole import; kept out of the index
+        superseded: std.AutoHashMapUnmanaged(BlockHash, void) = .{},
+
+        const Record = struct {
+            /// Owned read buffer that `view` points into
+            buffer: []u8,
+            view: BlockView,
+        };
+
+        fn clear(self: *ImportBatch, allocator: std.mem.Allocator) void {
+            for (self.records.items) |record| allocator.free(record.buffer);
+            self.records.clearRetainingCapacity();
+            self.bytes = 0;
+        }
+
+        fn deinit(self: *ImportBatch, allocator: std.mem.Allocator) void {
+            self.clear(allocator);
+            self.records.deinit(allocator);
+            self.superseded.deinit(allocator);
+        }
+    };
+
+    /// Store a batch of imported blocks, then index the ones that are ours
+    fn storeImportBatch(self: *Vault, batch: *ImportBatch, allocator: std.mem.Allocator) !void {
+        defer batch.clear(allocator);
+        const records = batch.records.items;
+        if (records.len == 0) return;
+
+        const entries = try allocator.alloc(BlockStore.Entry, records.len);
+        defer allocator.free(entries);
+        for (records, entries) |record, *entry| {
+            entry.* = .{ .hash = record.view.hash.*, .bytes = record.view.bytes };
+        }
+
+        // Blocks already present are skipped by the store
+        try self.store.putMany(entries);
+
+        // Index our own files; other authors' metadata won't decrypt
+        const index = if (self.index) |*open_index| open_index else return;
+
+        // An updated file's manifest names the version it replaces, which
+        // leaves the listing as it does in `updateFile`, whichever batch
+        // it arrived in
+        for (records) |*record| {
+            const view = &record.view;
+            if (view.block_type != .manifest or std.mem.allEqual(u8, view.prev_hash, 0)) continue;
+            try batch.superseded.put(allocator, view.prev_hash.*, {});
+
+            self.index_lock.lock();
+            defer self.index_lock.unlock();
+            try index.remove(view.prev_hash.*);
+        }
+
+        for (records) |*record| {
+            const view = &record.view;
+            if (view.block_type != .metadata or batch.superseded.contains(view.hash.*)) continue;
+            if (self.openMetadata(view)) |file_metadata| {
+                var owned = file_metadata;
+                defer owned.deinit(self.allocator);
+
+                self.index_lock.lock();
+                defer self.index_lock.unlock();
+                try index.put(.{
+                    .hash = view.hash.*,
+                    .filename = owned.filename,
+                    .size = owned.size,
+                    .mime_type = owned.mime_type,
+                    .created = owned.created,
+                });
+            } else |_| {}
+        }
+    }
+
     /// Clean up resources
     pub fn deinit(self: *Vault) void {
+        self.cache.destroy();
+        if (self.verified) |*memo| memo.deinit();
+        if (self.keys) |*registry| registry.deinit();
+        if (self.index) |*index| index.deinit();
         self.store.deinit();
     }
 };
@@ -676,6 +1498,235 @@ test "vault add and get file" {
     try std.testing.expectEqualStrings(test_data, retrieved_data);
 }
 
+test "vault add and get multi-chunk file" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-vault-chunks";
+    var vault = try Vault.init(allocator, test_dir);
+    defer vault.deinit();
+
+    // Small chunks so the file spans several content blocks
+    vault.chunk_size = 64;
+
+    const test_file = "zig-cache/test-chunked-file.bin";
+    var test_data: [1000]u8 = undefined;
+    for (&test_data, 0..) |*b, i| b.* = @truncate(i * 7);
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll(&test_data);
+    }
+    defer std.fs.cwd().deleteFile(test_file) catch {};
+
+    const hash = try vault.addFile(test_file);
+
+    const output_file = "zig-cache/test-chunked-output.bin";
+    try vault.getFile(hash, output_file);
+    defer std.fs.cwd().deleteFile(output_file) catch {};
+
+    const retrieved_data = try std.fs.cwd().readFileAlloc(
+        output_file,
+        allocator,
+        @enumFromInt(4096),
+    );
+    defer allocator.free(retrieved_data);
+
+    try std.testing.expectEqualSlices(u8, &test_data, retrieved_data);
+
+    // Listing reports the full plaintext size
+    var files = try vault.listFiles();
+    defer {
+        for (files.items) |*f| {
+            allocator.free(f.filename);
+            allocator.free(f.mime_type);
+        }
+        files.deinit(allocator);
+    }
+    var matches: usize = 0;
+    for (files.items) |f| {
+        if (std.mem.eql(u8, &f.hash, &hash)) {
+            try std.testing.expectEqual(@as(u64, test_data.len), f.size);
+            matches += 1;
+        }
+    }
+    try std.testing.expectEqual(@as(usize, 1), matches);
+}
+
+test "vault dedup stores shared content once" {
+    const allocator = std.testing.allocator;
+    const MemoryStore = @import("memstore.zig").MemoryStore;
+
+    var memory = MemoryStore.init(allocator);
+    var vault = try Vault.initWithStore(allocator, "zig-cache/test-vault-dedup", memory.blockStore());
+    defer vault.deinit();
+    vault.dedup = .{ .min_size = 1024, .avg_size = 4096, .max_size = 16384 };
+
+    // Second file: the first with 10 bytes prepended
+    var original: [96 * 1024]u8 = undefined;
+    crypto.random.bytes(&original);
+    var edited: [original.len + 10]u8 = undefined;
+    @memset(edited[0..10], 0xEE);
+    @memcpy(edited[10..], &original);
+
+    const paths = [_][]const u8{ "zig-cache/test-dedup-a.bin", "zig-cache/test-dedup-b.bin" };
+    const contents = [_][]const u8{ &original, &edited };
+    var hashes: [2]BlockHash = undefined;
+    var added: [2]usize = undefined;
+    for (paths, contents, &hashes, &added) |path, data, *hash, *count| {
+        {
+            const file = try std.fs.cwd().createFile(path, .{});
+            defer file.close();
+            try file.writeAll(data);
+        }
+        defer std.fs.cwd().deleteFile(path) catch {};
+
+        const before = memory.blocks.count();
+        hash.* = try vault.addFile(path);
+        count.* = memory.blocks.count() - before;
+    }
+
+    // Only the chunks around the edit, the manifest and metadata are new
+    try std.testing.expect(added[1] * 2 < added[0]);
+
+    const output_file = "zig-cache/test-dedup-output.bin";
+    defer std.fs.cwd().deleteFile(output_file) catch {};
+    for (hashes, contents) |hash, data| {
+        try vault.getFile(hash, output_file);
+        const retrieved = try std.fs.cwd().readFileAlloc(output_file, allocator, @enumFromInt(256 * 1024));
+        defer allocator.free(retrieved);
+        try std.testing.expectEqualSlices(u8, data, retrieved);
+    }
+}
+
+test "vault update reuses unchanged chunks and chains versions" {
+    const allocator = std.testing.allocator;
+    const MemoryStore = @import("memstore.zig").MemoryStore;
+
+    var memory = MemoryStore.init(allocator);
+    var vault = try Vault.initWithStore(allocator, "zig-cache/test-vault-update", memory.blockStore());
+    defer vault.deinit();
+    vault.dedup = .{ .min_size = 1024, .avg_size = 4096, .max_size = 16384 };
+
+    var data: [96 * 1024]u8 = undefined;
+    crypto.random.bytes(&data);
+
+    const test_file = "zig-cache/test-update-file.bin";
+    defer std.fs.cwd().deleteFile(test_file) catch {};
+    const Write = struct {
+        fn file(path: []const u8, bytes: []const u8) !void {
+            const out = try std.fs.cwd().createFile(path, .{});
+            defer out.close();
+            try out.writeAll(bytes);
+        }
+    };
+
+    try Write.file(test_file, &data);
+    const v1 = try vault.addFile(test_file);
+    const v1_blocks = memory.blocks.count();
+
+    // One byte changes: one or two chunks, the manifest and metadata are new
+    data[50_000] ^= 0xFF;
+    try Write.file(test_file, &data);
+    const v2 = try vault.updateFile(v1, test_file);
+    try std.testing.expect(memory.blocks.count() - v1_blocks <= 4);
+
+    var versions = try vault.listVersions(v2);
+    defer versions.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 2), versions.items.len);
+    try std.testing.expectEqualSlices(u8, &v1, &versions.items[0]);
+    try std.testing.expectEqualSlices(u8, &v2, &versions.items[1]);
+
+    // Both versions still read back
+    const output_file = "zig-cache/test-update-output.bin";
+    defer std.fs.cwd().deleteFile(output_file) catch {};
+    try vault.getFile(v2, output_file);
+    {
+        const retrieved = try std.fs.cwd().readFileAlloc(output_file, allocator, @enumFromInt(256 * 1024));
+        defer allocator.free(retrieved);
+        try std.testing.expectEqualSlices(u8, &data, retrieved);
+    }
+    try vault.getFile(v1, output_file);
+    {
+        const retrieved = try std.fs.cwd().readFileAlloc(output_file, allocator, @enumFromInt(256 * 1024));
+        defer allocator.free(retrieved);
+        try std.testing.expect(retrieved[50_000] != data[50_000]);
+    }
+
+    // Only the latest version is listed, before and after a rebuild
+    for (0..2) |round| {
+        if (round == 1) try vault.rebuildIndex();
+
+        var files = try vault.listFiles();
+        defer Vault.freeFileInfos(allocator, &files);
+        try std.testing.expectEqual(@as(usize, 1), files.items.len);
+        try std.testing.expectEqualSlices(u8, &v2, &files.items[0].hash);
+    }
+
+    // Imported into a vault with the same identity, the update still
+    // replaces the old version in the listing
+    const export_path = "zig-cache/test-update.zault";
+    try vault.exportBlocks(&.{ v1, v2 }, export_path, allocator);
+    defer std.fs.cwd().deleteFile(export_path) catch {};
+
+    const import_dir = "zig-cache/test-vault-update-import";
+    std.fs.cwd().deleteTree(import_dir) catch {};
+    defer std.fs.cwd().deleteTree(import_dir) catch {};
+    try std.fs.cwd().makePath(import_dir);
+    try std.fs.cwd().copyFile("zig-cache/test-vault-update/identity.bin", std.fs.cwd(), import_dir ++ "/identity.bin", .{});
+
+    var other_memory = MemoryStore.init(allocator);
+    var other = try Vault.initWithStore(allocator, import_dir, other_memory.blockStore());
+    defer other.deinit();
+
+    var imported = try other.importBlocks(export_path, allocator);
+    defer imported.deinit(allocator);
+
+    var files = try other.listFiles();
+    defer Vault.freeFileInfos(allocator, &files);
+    try std.testing.expectEqual(@as(usize, 1), files.items.len);
+    try std.testing.expectEqualSlices(u8, &v2, &files.items[0].hash);
+}
+
+test "vault streams chunks into a sink" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-vault-stream";
+    var vault = try Vault.init(allocator, test_dir);
+    defer vault.deinit();
+    vault.chunk_size = 100;
+
+    const test_file = "zig-cache/test-stream-file.txt";
+    const test_data = "streamed " ** 40;
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll(test_data);
+    }
+    defer std.fs.cwd().deleteFile(test_file) catch {};
+
+    const hash = try vault.addFile(test_file);
+
+    // Collect every write the sink receives
+    const Collector = struct {
+        bytes: std.ArrayList(u8) = .{},
+        writes: usize = 0,
+
+        fn write(context: *anyopaque, bytes: []const u8) anyerror!void {
+            const self: *@This() = @ptrCast(@alignCast(context));
+            try self.bytes.appendSlice(std.testing.allocator, bytes);
+            self.writes += 1;
+        }
+    };
+    var collector = Collector{};
+    defer collector.bytes.deinit(allocator);
+
+    try vault.streamFile(hash, .{ .context = &collector, .writeFn = Collector.write });
+
+    try std.testing.expectEqualStrings(test_data, collector.bytes.items);
+    // One write per chunk: 360 bytes in 100-byte chunks
+    try std.testing.expectEqual(@as(usize, 4), collector.writes);
+}
+
 test "create and redeem share token" {
     const allocator = std.testing.allocator;
 
@@ -716,6 +1767,7 @@ test "create and redeem share token" {
         .vault_path = shared_dir,
         .master_key = Vault.deriveMasterKey(&recipient_identity.secret_key),
         .allocator = allocator,
+        .cache = sender_vault.cache,
     };
 
     const share_info = try recipient_vault.redeemShare(share_token, allocator);
@@ -766,33 +1818,334 @@ test "import blocks from file" {
     var vault1 = try Vault.init(allocator, vault1_dir);
     defer vault1.deinit();
 
-    const test_file = "/tmp/test-import-file.txt";
-    const test_data = "Import test data";
+    // Vault 2: Import blocks
+    const vault2_dir = "/tmp/test-vault-import2";
+    var vault2 = try Vault.init(allocator, vault2_dir);
+    defer vault2.deinit();
+
+    // Full blocks export as V1; compact ones need V2 and their key records
+    for ([_]bool{ false, true }) |compact| {
+        vault1.compact_blocks = compact;
+
+        const test_file = "/tmp/test-import-file.txt";
+        const test_data = "Import test data";
+        {
+            const file = try std.fs.cwd().createFile(test_file, .{});
+            defer file.close();
+            try file.writeAll(test_data);
+        }
+        defer std.fs.cwd().deleteFile(test_file) catch {};
+
+        const file_hash = try vault1.addFile(test_file);
+
+        const export_path = "/tmp/test-import.zault";
+        try vault1.exportBlocks(&[_]BlockHash{file_hash}, export_path, allocator);
+        defer std.fs.cwd().deleteFile(export_path) catch {};
+
+        var header: [Vault.export_header_v1.len]u8 = undefined;
+        {
+            const exported = try std.fs.cwd().openFile(export_path, .{});
+            defer exported.close();
+            _ = try exported.readAll(&header);
+        }
+        try std.testing.expectEqualStrings(if (compact) Vault.export_header_v2 else Vault.export_header_v1, &header);
+
+        var imported = try vault2.importBlocks(export_path, allocator);
+        defer imported.deinit(allocator);
+
+        // Should have imported 2 blocks (content + metadata)
+        try std.testing.expect(imported.items.len >= 2);
+
+        // Blocks should now exist in vault2
+        try std.testing.expect(try vault2.store.has(file_hash));
+
+        // And verify there: a V2 export carries vault1's key
+        for (imported.items) |hash| try vault2.verifyBlock(hash);
+    }
+}
+
+test "vault on an in-memory block store" {
+    const allocator = std.testing.allocator;
+    const MemoryStore = @import("memstore.zig").MemoryStore;
+
+    var memory = MemoryStore.init(allocator);
+    var vault = try Vault.initWithStore(allocator, "zig-cache/test-vault-memory", memory.blockStore());
+    defer vault.deinit();
+
+    const test_file = "zig-cache/test-memory-file.txt";
     {
         const file = try std.fs.cwd().createFile(test_file, .{});
         defer file.close();
-        try file.writeAll(test_data);
+        try file.writeAll("kept in memory");
     }
     defer std.fs.cwd().deleteFile(test_file) catch {};
 
-    const file_hash = try vault1.addFile(test_file);
+    const hash = try vault.addFile(test_file);
 
-    const export_path = "/tmp/test-import.zault";
-    try vault1.exportBlocks(&[_]BlockHash{file_hash}, export_path, allocator);
-    defer std.fs.cwd().deleteFile(export_path) catch {};
+    // Metadata, manifest and one chunk, none of them on disk
+    try std.testing.expectEqual(@as(u32, 3), memory.blocks.count());
+    try vault.verifyBlock(hash);
+}
 
-    // Vault 2: Import blocks
-    const vault2_dir = "/tmp/test-vault-import2";
-    var vault2 = try Vault.init(allocator, vault2_dir);
-    defer vault2.deinit();
+test "vault serves repeated gets from the block cache" {
+    const allocator = std.testing.allocator;
 
-    // This will fail until we implement importBlocks
-    var imported = try vault2.importBlocks(export_path, allocator);
-    defer imported.deinit(allocator);
+    const test_dir = "zig-cache/test-vault-cache";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var vault = try Vault.init(allocator, test_dir);
+    defer vault.deinit();
+    vault.chunk_size = 64;
+    vault.setCacheLimits(.{ .content_bytes = 1024 * 1024 });
+
+    const test_file = test_dir ++ "/input.bin";
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll(&([_]u8{0x33} ** 200));
+    }
+    const hash = try vault.addFile(test_file);
+
+    const Counter = struct {
+        fn write(context: *anyopaque, bytes: []const u8) anyerror!void {
+            const total: *usize = @ptrCast(@alignCast(context));
+            total.* += bytes.len;
+        }
+    };
+
+    for (0..3) |_| {
+        var total: usize = 0;
+        try vault.streamFile(hash, .{ .context = &total, .writeFn = Counter.write });
+        try std.testing.expectEqual(@as(usize, 200), total);
+    }
+
+    // Metadata and manifest, then 4 chunks: missed once, hit twice after
+    const stats = vault.cacheStats();
+    try std.testing.expectEqual(@as(u64, 2), stats.metadata_misses);
+    try std.testing.expectEqual(@as(u64, 4), stats.metadata_hits);
+    try std.testing.expectEqual(@as(u64, 4), stats.content_misses);
+    try std.testing.expectEqual(@as(u64, 8), stats.content_hits);
+}
+
+test "vault memoizes verified blocks and still catches tampering" {
+    const allocator = std.testing.allocator;
+    const MemoryStore = @import("memstore.zig").MemoryStore;
+
+    const test_dir = "zig-cache/test-vault-verified";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var memory = MemoryStore.init(allocator);
+    var vault = try Vault.initWithStore(allocator, test_dir, memory.blockStore());
+    defer vault.deinit();
+    vault.setCacheLimits(.{ .metadata_bytes = 0, .content_bytes = 0 });
+
+    const test_file = "zig-cache/test-verified-file.txt";
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll("verified once");
+    }
+    defer std.fs.cwd().deleteFile(test_file) catch {};
 
-    // Should have imported 2 blocks (content + metadata)
-    try std.testing.expect(imported.items.len >= 2);
+    const hash = try vault.addFile(test_file);
 
-    // Blocks should now exist in vault2
-    try std.testing.expect(try vault2.store.has(file_hash));
+    const Discard = struct {
+        fn write(context: *anyopaque, bytes: []const u8) anyerror!void {
+            _ = context;
+            _ = bytes;
+        }
+    };
+    var unused: u8 = 0;
+    const sink = ContentSink{ .context = &unused, .writeFn = Discard.write };
+
+    // Metadata, manifest and chunk are checked on the first read only
+    try vault.streamFile(hash, sink);
+    try std.testing.expectEqual(@as(u32, 3), vault.verified.?.entries.count());
+    try vault.streamFile(hash, sink);
+    try std.testing.expectEqual(@as(u32, 3), vault.verified.?.entries.count());
+
+    // Changed bytes no longer hash to the memoized address, so the
+    // signature is checked again and fails
+    const stored = memory.blocks.get(hash).?;
+    stored[@import("block.zig").headerLength(stored[0])] ^= 0x01; // First payload byte
+    try std.testing.expectError(error.SignatureVerificationFailed, vault.streamFile(hash, sink));
+}
+
+test "vault lists files from the index and rebuilds it" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-vault-index";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const test_file = "zig-cache/test-index-file.md";
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll("# indexed");
+    }
+    defer std.fs.cwd().deleteFile(test_file) catch {};
+
+    const hash = blk: {
+        var vault = try Vault.init(allocator, test_dir);
+        defer vault.deinit();
+        break :blk try vault.addFile(test_file);
+    };
+
+    // Reopen from the index, then again after losing it
+    for (0..2) |_| {
+        var vault = try Vault.init(allocator, test_dir);
+        defer vault.deinit();
+        try std.testing.expect(!vault.index.?.needs_rebuild);
+
+        var files = try vault.listFiles();
+        defer Vault.freeFileInfos(allocator, &files);
+
+        try std.testing.expectEqual(@as(usize, 1), files.items.len);
+        try std.testing.expectEqualSlices(u8, &hash, &files.items[0].hash);
+        try std.testing.expectEqualStrings("test-index-file.md", files.items[0].filename);
+        try std.testing.expectEqualStrings("text/markdown", files.items[0].mime_type);
+
+        try std.fs.cwd().deleteFile(test_dir ++ "/index.db");
+    }
+}
+
+test "vault verifies all blocks" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-vault-verify";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var vault = try Vault.init(allocator, test_dir);
+    defer vault.deinit();
+    vault.chunk_size = 64;
+
+    const test_file = "zig-cache/test-verify-file.bin";
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll(&([_]u8{0x5A} ** 300));
+    }
+    defer std.fs.cwd().deleteFile(test_file) catch {};
+
+    _ = try vault.addFile(test_file);
+
+    // 5 chunks, manifest and metadata
+    var report = try vault.verifyAll(2);
+    defer report.deinit(allocator);
+    try std.testing.expect(report.ok());
+    try std.testing.expectEqual(@as(u64, 7), report.verified);
+}
+
+test "one vault serves several threads" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-vault-shared";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var vault = try Vault.init(allocator, test_dir);
+    defer vault.deinit();
+    vault.chunk_size = 64;
+
+    const Worker = struct {
+        fn run(shared: *Vault, id: usize, result: *anyerror!void) void {
+            result.* = roundTrip(shared, id);
+        }
+
+        fn roundTrip(shared: *Vault, id: usize) !void {
+            var path_buf: [64]u8 = undefined;
+            var data: [500]u8 = undefined;
+            @memset(&data, @intCast(id));
+
+            const input = try std.fmt.bufPrint(&path_buf, test_dir ++ "/in-{d}.bin", .{id});
+            {
+                const file = try std.fs.cwd().createFile(input, .{});
+                defer file.close();
+                try file.writeAll(&data);
+            }
+            const hash = try shared.addFile(input);
+
+            const output = try std.fmt.bufPrint(&path_buf, test_dir ++ "/out-{d}.bin", .{id});
+            try shared.getFile(hash, output);
+
+            const restored = try std.fs.cwd().readFileAlloc(output, std.testing.allocator, @enumFromInt(4096));
+            defer std.testing.allocator.free(restored);
+            try std.testing.expectEqualSlices(u8, &data, restored);
+
+            var files = try shared.listFiles();
+            Vault.freeFileInfos(std.testing.allocator, &files);
+        }
+    };
+
+    var threads: [4]std.Thread = undefined;
+    var results: [4]anyerror!void = undefined;
+    for (&threads, &results, 0..) |*thread, *result, i| {
+        thread.* = try std.Thread.spawn(.{}, Worker.run, .{ &vault, i, result });
+    }
+    for (threads) |thread| thread.join();
+    for (results) |result| try result;
+
+    var files = try vault.listFiles();
+    defer Vault.freeFileInfos(allocator, &files);
+    try std.testing.expectEqual(@as(usize, threads.len), files.items.len);
+}
+
+test "vault batch-signs chunks and verifies them" {
+    const allocator = std.testing.allocator;
+
+    const test_dir = "zig-cache/test-vault-batch";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    var vault = try Vault.init(allocator, test_dir);
+    defer vault.deinit();
+    vault.chunk_size = 64;
+    vault.signature_batch = 4;
+
+    const test_file = "zig-cache/test-batch-file.bin";
+    var test_data: [1000]u8 = undefined;
+    for (&test_data, 0..) |*b, i| b.* = @truncate(i * 13);
+    {
+        const file = try std.fs.cwd().createFile(test_file, .{});
+        defer file.close();
+        try file.writeAll(&test_data);
+    }
+    defer std.fs.cwd().deleteFile(test_file) catch {};
+
+    const hash = try vault.addFile(test_file);
+
+    const output_file = "zig-cache/test-batch-output.bin";
+    try vault.getFile(hash, output_file);
+    defer std.fs.cwd().deleteFile(output_file) catch {};
+
+    const retrieved_data = try std.fs.cwd().readFileAlloc(output_file, allocator, @enumFromInt(4096));
+    defer allocator.free(retrieved_data);
+    try std.testing.expectEqualSlices(u8, &test_data, retrieved_data);
+
+    // 16 chunks under 4 batch roots, manifest and metadata
+    var report = try vault.verifyAll(2);
+    defer report.deinit(allocator);
+    try std.testing.expect(report.ok());
+    try std.testing.expectEqual(@as(u64, 22), report.verified);
+
+    // Exports carry the batch roots, so the chunks verify elsewhere
+    const export_path = "zig-cache/test-batch.zault";
+    try vault.exportBlocks(&[_]BlockHash{hash}, export_path, allocator);
+    defer std.fs.cwd().deleteFile(export_path) catch {};
+
+    const import_dir = "zig-cache/test-vault-batch-import";
+    std.fs.cwd().deleteTree(import_dir) catch {};
+    defer std.fs.cwd().deleteTree(import_dir) catch {};
+
+    var other = try Vault.init(allocator, import_dir);
+    defer other.deinit();
+
+    var imported = try other.importBlocks(export_path, allocator);
+    defer imported.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 22), imported.items.len);
+    for (imported.items) |imported_hash| try other.verifyBlock(imported_hash);
 }
@@ -0,0 +1,291 @@
+//! Persistent set of blocks whose signatures have been verified
+//!
+//! Checking an ML-DSA-65 signature is by far the most expensive part of
+//! reading a block. Blocks are immutable and content-addressed, so once a
+//! block has verified, a later read only needs to show that its bytes still
+//! hash to the same address. This set records, in `<vault>/verified.db`,
+//! every block hash that has passed, along with a digest of its author key.
+//!
+//! ## Format
+//!
+//! ```
+//! "ZAULTVS1"
+//! record*   hash(32) author(32) mac(16)
+//! ```
+//!
+//! `author` is the SHA3-256 of the author's public key. `mac` is
+//! HMAC-SHA3-256 over hash and author, truncated to 16 bytes, with a key
+//! derived from the vault master key, so entries cannot be added without
+//! the vault identity.
+//!
+//! ## Recovery
+//!
+//! A torn trailing record is truncated on open. A record that fails its
+//! MAC (tampering, a different identity) empties the set: every block is
+//! then verified again on its next read. Losing entries only costs time.
+
+const std = @import("std");
+const crypto = @import("crypto.zig");
+const BlockView = @import("block.zig").BlockView;
+
+/// Hash type for block addresses
+pub const BlockHash = [crypto.Sha3_256.digest_length]u8;
+
+const set_magic = "ZAULTVS1";
+const mac_length = 16;
+const record_length = 32 + 32 + mac_length;
+
+/// In-memory view of `verified.db`, appended to as blocks verify
+pub const VerifiedSet = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    key: [32]u8,
+    /// Author key digest of each verified block
+    entries: std.AutoHashMap(BlockHash, [32]u8),
+    /// Guards `entries` and appends to `file`
+    lock: std.Thread.RwLock = .{},
+
+    /// Open or create the set under `vault_path`
+    pub fn open(allocator: std.mem.Allocator, vault_path: []const u8, master_key: [32]u8) !VerifiedSet {
+        const path = try std.fmt.allocPrint(allocator, "{s}/verified.db", .{vault_path});
+        defer allocator.free(path);
+
+        var created = false;
+        const file = std.fs.cwd().openFile(path, .{ .mode = .read_write }) catch |err| switch (err) {
+            error.FileNotFound => blk: {
+                created = true;
+                break :blk try std.fs.cwd().createFile(path, .{ .read = true, .exclusive = true });
+            },
+            else => return err,
+        };
+        errdefer file.close();
+
+        var self = VerifiedSet{
+            .allocator = allocator,
+            .file = file,
+            .key = deriveSetKey(master_key),
+            .entries = std.AutoHashMap(BlockHash, [32]u8).init(allocator),
+        };
+        errdefer self.entries.deinit();
+
+        if (created) {
+            try self.reset();
+        } else {
+            self.load() catch |err| switch (err) {
+                error.InvalidSet => try self.reset(),
+                else => return err,
+            };
+        }
+
+        return self;
+    }
+
+    /// Close the file and free the entries
+    pub fn deinit(self: *VerifiedSet) void {
+        self.entries.deinit();
+        self.file.close();
+        std.crypto.secureZero(u8, &self.key);
+    }
+
+    /// MAC key, separate from the metadata and index keys
+    fn deriveSetKey(master_key: [32]u8) [32]u8 {
+        const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &master_key);
+
+        var key: [32]u8 = undefined;
+        crypto.HkdfSha3_256.expand(&key, "zault-verified-set-v1", prk);
+        return key;
+    }
+
+    /// Forget every block and truncate the file to its header
+    pub fn reset(self: *VerifiedSet) !void {
+        self.entries.clearRetainingCapacity();
+
+        try self.file.setEndPos(0);
+        try self.file.pwriteAll(set_magic, 0);
+        try self.file.seekTo(set_magic.len);
+    }
+
+    /// Read every record into memory
+    fn load(self: *VerifiedSet) !void {
+        const size = (try self.file.stat()).size;
+        if (size < set_magic.len) return error.InvalidSet;
+
+        const bytes = try self.allocator.alloc(u8, size);
+        defer self.allocator.free(bytes);
+        if (try self.file.preadAll(bytes, 0) != size) return error.InvalidSet;
+
+        if (!std.mem.eql(u8, bytes[0..set_magic.len], set_magic)) return error.InvalidSet;
+
+        const records = bytes[set_magic.len..];
+        const count = records.len / record_length;
+        try self.entries.ensureTotalCapacity(@intCast(count));
+
+        for (0..count) |i| {
+            const record = records[i * record_length ..][0..record_length];
+            const hash = record[0..32];
+            const author = record[32..64];
+
+            const expected = self.mac(hash, author);
+            if (!std.crypto.timing_safe.eql([mac_length]u8, expected, record[64..][0..mac_length].*)) {
+                return error.InvalidSet;
+            }
+            self.entries.putAssumeCapacity(hash.*, author.*);
+        }
+
+        // Truncate a partial record so the next append stays aligned
+        const end = set_magic.len + count * record_length;
+        if (end != size) try self.file.setEndPos(end);
+        try self.file.seekTo(end);
+    }
+
+    fn mac(self: *const VerifiedSet, hash: *const BlockHash, author: *const [32]u8) [mac_length]u8 {
+        var out: [crypto.HmacSha3_256.mac_length]u8 = undefined;
+        var hmac = crypto.HmacSha3_256.init(&self.key);
+        hmac.update(hash);
+        hmac.update(author);
+        hmac.final(&out);
+        return out[0..mac_length].*;
+    }
+
+    /// Key fingerprint; compact blocks carry it already
+    fn authorDigest(view: *const BlockView) [32]u8 {
+        return view.author.fingerprint();
+    }
+
+    /// Whether `view` is a block that has verified before, by the same
+    /// author. The caller must still check that the bytes hash to
+    /// `view.hash`; the set says nothing about what the store returned.
+    pub fn contains(self: *VerifiedSet, view: *const BlockView) bool {
+        const author = blk: {
+            self.lock.lockShared();
+            defer self.lock.unlockShared();
+            break :blk self.entries.get(view.hash.*) orelse return false;
+        };
+        const digest = authorDigest(view);
+        return std.mem.eql(u8, &author, &digest);
+    }
+
+    /// Record blocks whose signatures have just verified, in one append.
+    /// Blocks already in the set are skipped, so re-verifying a block or
+    /// racing readers of it do not grow the file.
+    pub fn addMany(self: *VerifiedSet, views: []const *const BlockView) !void {
+        var records = std.ArrayList(u8){};
+        defer records.deinit(self.allocator);
+        try records.ensureTotalCapacity(self.allocator, views.len * record_length);
+
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        // Entries go in first to catch repeats within `views`; nothing
+        // reads them until the lock is released
+        try self.entries.ensureUnusedCapacity(@intCast(views.len));
+        for (views) |view| {
+            const entry = self.entries.getOrPutAssumeCapacity(view.hash.*);
+            if (entry.found_existing) continue;
+
+            entry.value_ptr.* = authorDigest(view);
+            records.appendSliceAssumeCapacity(view.hash);
+            records.appendSliceAssumeCapacity(entry.value_ptr);
+            records.appendSliceAssumeCapacity(&self.mac(view.hash, entry.value_ptr));
+        }
+        if (records.items.len == 0) return;
+
+        // On failure, drop the new entries and any partial record
+        const end = try self.file.getPos();
+        self.file.writeAll(records.items) catch |err| {
+            var pos: usize = 0;
+            while (pos < records.items.len) : (pos += record_length) {
+                _ = self.entries.remove(records.items[pos..][0..32].*);
+            }
+            self.file.setEndPos(end) catch {};
+            self.file.seekTo(end) catch {};
+            return err;
+        };
+    }
+
+    /// Record one verified block
+    pub fn add(self: *VerifiedSet, view: *const BlockView) !void {
+        return self.addMany(&.{view});
+    }
+};
+
+test "verified set persists and rejects tampering" {
+    const allocator = std.testing.allocator;
+    const Block = @import("block.zig").Block;
+    const Identity = @import("identity.zig").Identity;
+
+    const test_dir = "zig-cache/test-verified-set";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    try std.fs.cwd().makePath(test_dir);
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+
+    const master_key = [_]u8{0x42} ** 32;
+    const identity = Identity.generate();
+
+    var block = Block{
+        .version = 0x01,
+        .block_type = .metadata,
+        .timestamp = 0,
+        .author = identity.public_key,
+        .data = "verified once",
+        .nonce = [_]u8{3} ** crypto.ChaCha20Poly1305.nonce_length,
+        .signature = undefined,
+        .prev_hash = [_]u8{0} ** 32,
+        .hash = undefined,
+    };
+    try block.sign(&identity.secret_key, allocator);
+    block.hash = block.computeHash();
+
+    const bytes = try block.serialize(allocator);
+    defer allocator.free(bytes);
+    const view = try BlockView.parse(bytes);
+
+    {
+        var set = try VerifiedSet.open(allocator, test_dir, master_key);
+        defer set.deinit();
+        try std.testing.expect(!set.contains(&view));
+        try set.add(&view);
+        try std.testing.expect(set.contains(&view));
+
+        // Recording it again, alone or twice in one batch, appends nothing
+        const size = (try set.file.stat()).size;
+        try set.add(&view);
+        try set.addMany(&.{ &view, &view });
+        try std.testing.expectEqual(size, (try set.file.stat()).size);
+    }
+
+    // Survives reopening, and a torn append
+    {
+        var set = try VerifiedSet.open(allocator, test_dir, master_key);
+        defer set.deinit();
+        try std.testing.expect(set.contains(&view));
+        try set.file.writeAll(&[_]u8{ 0x01, 0x02 });
+    }
+
+    // Another author's key under the same hash is not trusted
+    {
+        var set = try VerifiedSet.open(allocator, test_dir, master_key);
+        defer set.deinit();
+
+        var forged_bytes: [8192]u8 = undefined;
+        const forged = forged_bytes[0..bytes.len];
+        @memcpy(forged, bytes);
+        forged[10] ^= 0xFF; // First byte of the author key
+        try std.testing.expect(!set.contains(&try BlockView.parse(forged)));
+    }
+
+    // A flipped MAC bit empties the set
+    {
+        const file = try std.fs.cwd().openFile(test_dir ++ "/verified.db", .{ .mode = .read_write });
+        defer file.close();
+        var last: [1]u8 = undefined;
+        _ = try file.preadAll(&last, set_magic.len + record_length - 1);
+        last[0] ^= 0x01;
+        try file.pwriteAll(&last, set_magic.len + record_length - 1);
+    }
+    {
+        var set = try VerifiedSet.open(allocator, test_dir, master_key);
+        defer set.deinit();
+        try std.testing.expect(!set.contains(&view));
+    }
+}
@@ -29,6 +29,9 @@ const Identity = zault.Identity;
 const Block = zault.Block;
 const BlockHash = zault.BlockHash;
 const crypto = zault.crypto;
+const metrics = zault.metrics;
+const Executor = zault.executor.Executor;
+const Task = zault.executor.Task;
 
 // =============================================================================
 // Error codes
@@ -62,6 +65,10 @@ pub const ZAULT_MSG_OVERHEAD: usize = ZAULT_MLKEM768_CT_LEN + 12 + 16;
 // Serialized public identity: ML-DSA-65 pk (1952) + ML-KEM-768 pk (1184)
 pub const ZAULT_PUBLIC_IDENTITY_LEN: usize = ZAULT_MLDSA65_PK_LEN + ZAULT_MLKEM768_PK_LEN;
 
+// Signature checking on read (zault_vault_set_verify_mode)
+pub const ZAULT_VERIFY_ALWAYS: c_int = 0;
+pub const ZAULT_VERIFY_MEMO: c_int = 1;
+
 // =============================================================================
 // Allocator for FFI
 // =============================================================================
@@ -79,6 +86,9 @@ pub const ZaultVault = opaque {};
 /// Opaque identity handle
 pub const ZaultIdentity = opaque {};
 
+/// Opaque async context handle
+pub const ZaultAsync = opaque {};
+
 // =============================================================================
 // Memory management
 // =============================================================================
@@ -130,8 +140,7 @@ export fn zault_identity_destroy(handle: ?*ZaultIdentity) void {
     if (handle) |h| {
         const identity_ptr: *Identity = @ptrCast(@alignCast(h));
         // Zero out secret keys before freeing
-        @memset(&identity_ptr.secret_key, 0);
-        @memset(&identity_ptr.kem_secret_key, 0);
+        identity_ptr.wipe();
         ffi_allocator.destroy(identity_ptr);
     }
 }
@@ -246,6 +255,43 @@ export fn zault_vault_destroy(handle: ?*ZaultVault) void {
     }
 }
 
+// Error code mapping, shared by the blocking and async entry points
+
+fn addStatus(err: anyerror) c_int {
+    return switch (err) {
+        error.FileNotFound, error.NotFound => ZAULT_ERR_NOT_FOUND,
+        error.OutOfMemory => ZAULT_ERR_ALLOC,
+        else => ZAULT_ERR_IO,
+    };
+}
+
+fn getStatus(err: anyerror) c_int {
+    return switch (err) {
+        error.FileNotFound, error.NotFound => ZAULT_ERR_NOT_FOUND,
+        error.OutOfMemory => ZAULT_ERR_ALLOC,
+        error.AuthenticationFailed => ZAULT_ERR_AUTH_FAILED,
+        else => ZAULT_ERR_IO,
+    };
+}
+
+fn shareStatus(err: anyerror) c_int {
+    return switch (err) {
+        error.FileNotFound => ZAULT_ERR_NOT_FOUND,
+        error.OutOfMemory => ZAULT_ERR_ALLOC,
+        error.AuthenticationFailed => ZAULT_ERR_AUTH_FAILED,
+        else => ZAULT_ERR_CRYPTO,
+    };
+}
+
+fn redeemStatus(err: anyerror) c_int {
+    return switch (err) {
+        error.OutOfMemory => ZAULT_ERR_ALLOC,
+        error.AuthenticationFailed => ZAULT_ERR_AUTH_FAILED,
+        error.ShareExpired => ZAULT_ERR_AUTH_FAILED,
+        else => ZAULT_ERR_CRYPTO,
+    };
+}
+
 /// Add a file to the vault.
 /// On success, writes the 32-byte hash to hash_out.
 export fn zault_vault_add_file(
@@ -266,18 +312,168 @@ export fn zault_vault_add_file(
     defer ffi_allocator.free(path_z);
     @memcpy(path_z[0..file_path_len], file_path);
 
-    const hash = vault.addFile(path_z) catch |err| {
-        return switch (err) {
-            error.FileNotFound => ZAULT_ERR_NOT_FOUND,
-            error.OutOfMemory => ZAULT_ERR_ALLOC,
-            else => ZAULT_ERR_IO,
-        };
-    };
+    const hash = vault.addFile(path_z) catch |err| return addStatus(err);
+
+    @memcpy(hash_out.?[0..ZAULT_HASH_LEN], &hash);
+    return ZAULT_OK;
+}
+
+/// Store a new version of a file, re-encrypting only the changed chunks.
+/// `previous_hash` is the metadata hash of the version being replaced.
+export fn zault_vault_update_file(
+    handle: ?*ZaultVault,
+    previous_hash: ?[*]const u8,
+    file_path_ptr: ?[*]const u8,
+    file_path_len: usize,
+    hash_out: ?[*]u8,
+    hash_out_len: usize,
+) c_int {
+    if (handle == null or previous_hash == null or file_path_ptr == null or file_path_len == 0) return ZAULT_ERR_INVALID_ARG;
+    if (hash_out == null or hash_out_len < ZAULT_HASH_LEN) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    const file_path = file_path_ptr.?[0..file_path_len];
+
+    const path_z = ffi_allocator.allocSentinel(u8, file_path_len, 0) catch return ZAULT_ERR_ALLOC;
+    defer ffi_allocator.free(path_z);
+    @memcpy(path_z[0..file_path_len], file_path);
+
+    const hash = vault.updateFile(previous_hash.?[0..ZAULT_HASH_LEN].*, path_z) catch |err| return addStatus(err);
+
+    @memcpy(hash_out.?[0..ZAULT_HASH_LEN], &hash);
+    return ZAULT_OK;
+}
+
+/// Add a file to the vault from an open file descriptor.
+/// The descriptor is read to EOF in fixed-size chunks and is not closed.
+export fn zault_vault_add_fd(
+    handle: ?*ZaultVault,
+    fd: c_int,
+    name_ptr: ?[*]const u8,
+    name_len: usize,
+    hash_out: ?[*]u8,
+    hash_out_len: usize,
+) c_int {
+    if (handle == null or fd < 0 or name_ptr == null or name_len == 0) return ZAULT_ERR_INVALID_ARG;
+    if (hash_out == null or hash_out_len < ZAULT_HASH_LEN) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    const name = name_ptr.?[0..name_len];
+    const file = std.fs.File{ .handle = fd };
+
+    const hash = vault.addFileHandle(file, name) catch |err| return addStatus(err);
 
     @memcpy(hash_out.?[0..ZAULT_HASH_LEN], &hash);
     return ZAULT_OK;
 }
 
+/// Set the number of threads used to encrypt and sign chunks on add.
+/// 0 means one thread per CPU; 1 (the default) disables the pipeline.
+export fn zault_vault_set_ingest_threads(handle: ?*ZaultVault, threads: usize) c_int {
+    if (handle == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    vault.ingest_threads = threads;
+    return ZAULT_OK;
+}
+
+/// Turn dedup mode on or off for files added from now on: content-defined
+/// chunks under convergent keys, so content already in the vault is not
+/// stored again. Off by default.
+export fn zault_vault_set_dedup(handle: ?*ZaultVault, enabled: c_int) c_int {
+    if (handle == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    vault.dedup = if (enabled != 0) .{} else null;
+    return ZAULT_OK;
+}
+
+/// Write new blocks in the compact format, naming the author by key
+/// fingerprint instead of embedding the public key. Off by default;
+/// older builds cannot read compact blocks.
+export fn zault_vault_set_compact_blocks(handle: ?*ZaultVault, enabled: c_int) c_int {
+    if (handle == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    vault.compact_blocks = enabled != 0;
+    return ZAULT_OK;
+}
+
+/// Sign content chunks of files added from now on in batches of up to
+/// `leaves` under one Merkle root signature, each chunk carrying its
+/// inclusion proof. 0 (the default) signs every chunk.
+export fn zault_vault_set_signature_batch(handle: ?*ZaultVault, leaves: u16) c_int {
+    if (handle == null or leaves > zault.batch.max_leaves) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    vault.signature_batch = leaves;
+    return ZAULT_OK;
+}
+
+/// Keep up to `depth` block reads and writes in flight during import,
+/// export and get (io_uring on Linux pack vaults). 0 turns it off.
+/// Returns 1 if asynchronous I/O is in use, 0 if the vault stays synchronous.
+export fn zault_vault_set_io_queue_depth(handle: ?*ZaultVault, depth: u16) c_int {
+    if (handle == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    const enabled = vault.setIoQueueDepth(depth) catch return ZAULT_ERR_IO;
+    return @intFromBool(enabled);
+}
+
+/// Block cache counters, as returned by zault_vault_cache_stats
+pub const ZaultCacheStats = extern struct {
+    metadata_hits: u64,
+    metadata_misses: u64,
+    content_hits: u64,
+    content_misses: u64,
+    evictions: u64,
+    metadata_bytes: u64,
+    content_bytes: u64,
+};
+
+/// Bound the verified-block cache: bytes for metadata-like blocks and for
+/// content chunks. 0 disables caching that kind.
+export fn zault_vault_set_cache_limits(handle: ?*ZaultVault, metadata_bytes: usize, content_bytes: usize) c_int {
+    if (handle == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    vault.setCacheLimits(.{ .metadata_bytes = metadata_bytes, .content_bytes = content_bytes });
+    return ZAULT_OK;
+}
+
+/// Choose how block signatures are checked on read: ZAULT_VERIFY_ALWAYS,
+/// or ZAULT_VERIFY_MEMO (the default) to verify each block once per vault.
+export fn zault_vault_set_verify_mode(handle: ?*ZaultVault, mode: c_int) c_int {
+    if (handle == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    vault.verify_mode = switch (mode) {
+        ZAULT_VERIFY_ALWAYS => .always,
+        ZAULT_VERIFY_MEMO => .memo,
+        else => return ZAULT_ERR_INVALID_ARG,
+    };
+    return ZAULT_OK;
+}
+
+/// Read the block cache hit, miss and eviction counters.
+export fn zault_vault_cache_stats(handle: ?*ZaultVault, stats_out: ?*ZaultCacheStats) c_int {
+    if (handle == null or stats_out == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    const stats = vault.cacheStats();
+    stats_out.?.* = .{
+        .metadata_hits = stats.metadata_hits,
+        .metadata_misses = stats.metadata_misses,
+        .content_hits = stats.content_hits,
+        .content_misses = stats.content_misses,
+        .evictions = stats.evictions,
+        .metadata_bytes = stats.metadata_bytes,
+        .content_bytes = stats.content_bytes,
+    };
+    return ZAULT_OK;
+}
+
 /// Get a file from the vault by hash.
 export fn zault_vault_get_file(
     handle: ?*ZaultVault,
@@ -298,14 +494,42 @@ export fn zault_vault_get_file(
     defer ffi_allocator.free(path_z);
     @memcpy(path_z[0..output_path_len], output_path);
 
-    vault.getFile(hash.*, path_z) catch |err| {
-        return switch (err) {
-            error.FileNotFound => ZAULT_ERR_NOT_FOUND,
-            error.OutOfMemory => ZAULT_ERR_ALLOC,
-            error.AuthenticationFailed => ZAULT_ERR_AUTH_FAILED,
-            else => ZAULT_ERR_IO,
-        };
-    };
+    vault.getFile(hash.*, path_z) catch |err| return getStatus(err);
+
+    return ZAULT_OK;
+}
+
+/// Callback receiving decrypted file content, one chunk at a time.
+/// Return 0 to continue, non-zero to abort the stream.
+pub const ZaultWriteFn = *const fn (ctx: ?*anyopaque, data: [*]const u8, len: usize) callconv(.c) c_int;
+
+/// Adapts a C write callback to a Vault.ContentSink.
+const CallbackSink = struct {
+    write_fn: ZaultWriteFn,
+    ctx: ?*anyopaque,
+
+    fn write(context: *anyopaque, bytes: []const u8) anyerror!void {
+        const self: *const CallbackSink = @ptrCast(@alignCast(context));
+        if (self.write_fn(self.ctx, bytes.ptr, bytes.len) != 0) return error.CallbackAborted;
+    }
+};
+
+/// Stream a decrypted file to a callback, chunk by chunk.
+export fn zault_vault_get_stream(
+    handle: ?*ZaultVault,
+    hash_ptr: ?[*]const u8,
+    hash_len: usize,
+    write_fn: ?ZaultWriteFn,
+    ctx: ?*anyopaque,
+) c_int {
+    if (handle == null or hash_ptr == null or hash_len != ZAULT_HASH_LEN) return ZAULT_ERR_INVALID_ARG;
+    if (write_fn == null) return ZAULT_ERR_INVALID_ARG;
+
+    const vault: *Vault = @ptrCast(@alignCast(handle.?));
+    const hash: *const [32]u8 = @ptrCast(hash_ptr.?);
+
+    var callback = CallbackSink{ .write_fn = write_fn.?, .ctx = ctx };
+    vault.streamFile(hash.*, .{ .context = &callback, .writeFn = CallbackSink.write }) catch |err| return getStatus(err);
 
     return ZAULT_OK;
 }
@@ -349,14 +573,7 @@ export fn zault_vault_create_share(
     const file_hash: *const [32]u8 = @ptrCast(file_hash_ptr.?);
     const recipient_pk: *const [ZAULT_MLKEM768_PK_LEN]u8 = @ptrCast(recipient_kem_pk_ptr.?);
 
-    const token = vault.createShare(file_hash.*, recipient_pk, expires_at, ffi_allocator) catch |err| {
-        return switch (err) {
-            error.FileNotFound => ZAULT_ERR_NOT_FOUND,
-            error.OutOfMemory => ZAULT_ERR_ALLOC,
-            error.AuthenticationFailed => ZAULT_ERR_AUTH_FAILED,
-            else => ZAULT_ERR_CRYPTO,
-        };
-    };
+    const token = vault.createShare(file_hash.*, recipient_pk, expires_at, ffi_allocator) catch |err| return shareStatus(err);
     defer ffi_allocator.free(token);
 
     if (token_len_out) |len_out| {
@@ -386,14 +603,7 @@ export fn zault_vault_redeem_share(
     const vault: *Vault = @ptrCast(@alignCast(handle.?));
     const token = token_ptr.?[0..token_len];
 
-    const share_info = vault.redeemShare(token, ffi_allocator) catch |err| {
-        return switch (err) {
-            error.OutOfMemory => ZAULT_ERR_ALLOC,
-            error.AuthenticationFailed => ZAULT_ERR_AUTH_FAILED,
-            error.ShareExpired => ZAULT_ERR_AUTH_FAILED,
-            else => ZAULT_ERR_CRYPTO,
-        };
-    };
+    const share_info = vault.redeemShare(token, ffi_allocator) catch |err| return redeemStatus(err);
 
     @memcpy(hash_out.?[0..ZAULT_HASH_LEN], &share_info.file_hash);
     return ZAULT_OK;
@@ -434,7 +644,7 @@ export fn zault_vault_export_blocks(
 
     vault.exportBlocks(hashes, path_z, ffi_allocator) catch |err| {
         return switch (err) {
-            error.FileNotFound => ZAULT_ERR_NOT_FOUND,
+            error.FileNotFound, error.NotFound => ZAULT_ERR_NOT_FOUND,
             error.OutOfMemory => ZAULT_ERR_ALLOC,
             else => ZAULT_ERR_IO,
         };
@@ -473,6 +683,280 @@ export fn zault_vault_import_blocks(
     return @intCast(imported.items.len);
 }
 
+// =============================================================================
+// Asynchronous vault operations
+// =============================================================================
+
+/// One finished async operation, as returned by zault_async_poll/wait
+pub const ZaultCompletion = extern struct {
+    /// Request id returned by the submit call
+    id: u64,
+    /// ZAULT_OK or a negative error code, as from the blocking call
+    status: c_int,
+    /// add: metadata hash; redeem: shared file hash
+    hash: [ZAULT_HASH_LEN]u8,
+    /// create_share: token length (also on ZAULT_ERR_INVALID_ARG if the
+    /// buffer was too small)
+    len: usize,
+};
+
+/// Worker pool driving one vault; the vault synchronizes itself, so
+/// every operation runs concurrently
+const AsyncContext = struct {
+    vault: *Vault,
+    executor: *Executor,
+};
+
+/// One submitted operation; owned by the context until it is collected
+const Request = struct {
+    task: Task = .{ .runFn = run },
+    context: *AsyncContext,
+    op: Op,
+    status: c_int = ZAULT_OK,
+    hash: [ZAULT_HASH_LEN]u8 = [_]u8{0} ** ZAULT_HASH_LEN,
+    len: usize = 0,
+
+    const Op = union(enum) {
+        add: struct { path: [:0]u8 },
+        get: struct { hash: BlockHash, path: [:0]u8 },
+        share: struct {
+            hash: BlockHash,
+            recipient: [ZAULT_MLKEM768_PK_LEN]u8,
+            expires_at: i64,
+            /// Caller buffer; must stay valid until completion
+            token_out: [*]u8,
+            token_out_len: usize,
+        },
+        redeem: struct { token: []u8 },
+    };
+
+    fn create(context: *AsyncContext, op: Op) ?*Request {
+        const request = ffi_allocator.create(Request) catch return null;
+        request.* = .{ .context = context, .op = op };
+        return request;
+    }
+
+    fn destroy(self: *Request) void {
+        freeOp(self.op);
+        ffi_allocator.destroy(self);
+    }
+
+    fn freeOp(op: Op) void {
+        switch (op) {
+            .add => |add| ffi_allocator.free(add.path),
+            .get => |get| ffi_allocator.free(get.path),
+            .share => {},
+            .redeem => |redeem| ffi_allocator.free(redeem.token),
+        }
+    }
+
+    fn run(task: *Task) void {
+        const self: *Request = @fieldParentPtr("task", task);
+        const vault = self.context.vault;
+
+        switch (self.op) {
+            .add => |add| {
+                self.hash = vault.addFile(add.path) catch |err| {
+                    self.status = addStatus(err);
+                    return;
+                };
+            },
+            .get => |get| {
+                vault.getFile(get.hash, get.path) catch |err| {
+                    self.status = getStatus(err);
+                };
+            },
+            .share => |share| {
+                const token = vault.createShare(share.hash, &share.recipient, share.expires_at, ffi_allocator) catch |err| {
+                    self.status = shareStatus(err);
+                    return;
+                };
+                defer ffi_allocator.free(token);
+
+                self.len = token.len;
+                if (share.token_out_len < token.len) {
+                    self.status = ZAULT_ERR_INVALID_ARG;
+                    return;
+                }
+                @memcpy(share.token_out[0..token.len], token);
+            },
+            .redeem => |redeem| {
+                const share_info = vault.redeemShare(redeem.token, ffi_allocator) catch |err| {
+                    self.status = redeemStatus(err);
+                    return;
+                };
+                self.hash = share_info.file_hash;
+            },
+        }
+    }
+};
+
+/// Copy a caller path into an owned, null-terminated string
+fn dupePath(ptr: ?[*]const u8, len: usize) ?[:0]u8 {
+    if (ptr == null or len == 0) return null;
+    const path_z = ffi_allocator.allocSentinel(u8, len, 0) catch return null;
+    @memcpy(path_z[0..len], ptr.?[0..len]);
+    return path_z;
+}
+
+fn submitRequest(handle: ?*ZaultAsync, op: Request.Op) u64 {
+    const context: *AsyncContext = @ptrCast(@alignCast(handle.?));
+    const request = Request.create(context, op) orelse {
+        Request.freeOp(op);
+        return 0;
+    };
+    return context.executor.submit(&request.task);
+}
+
+/// Create an async context running vault operations on `threads` workers
+/// (0 = one per CPU). The vault must outlive the context; it may still be
+/// used through the blocking API meanwhile.
+export fn zault_async_create(vault_handle: ?*ZaultVault, threads: usize) ?*ZaultAsync {
+    if (vault_handle == null) return null;
+
+    const context = ffi_allocator.create(AsyncContext) catch return null;
+    context.* = .{
+        .vault = @ptrCast(@alignCast(vault_handle.?)),
+        .executor = Executor.create(ffi_allocator, threads) catch {
+            ffi_allocator.destroy(context);
+            return null;
+        },
+    };
+    return @ptrCast(context);
+}
+
+/// Wait for every submitted operation, then free the context and any
+/// completions that were never collected.
+export fn zault_async_destroy(handle: ?*ZaultAsync) void {
+    const context: *AsyncContext = @ptrCast(@alignCast(handle orelse return));
+
+    context.executor.shutdown();
+    var done: [64]*Task = undefined;
+    while (true) {
+        const tasks = context.executor.poll(&done);
+        if (tasks.len == 0) break;
+        for (tasks) |task| {
+            const request: *Request = @fieldParentPtr("task", task);
+            request.destroy();
+        }
+    }
+
+    context.executor.destroy();
+    ffi_allocator.destroy(context);
+}
+
+/// File descriptor that is readable while completions are waiting, for
+/// epoll/poll loops (Linux). Returns -1 where unavailable.
+export fn zault_async_fd(handle: ?*ZaultAsync) c_int {
+    const context: *AsyncContext = @ptrCast(@alignCast(handle orelse return -1));
+    return context.executor.fd() orelse -1;
+}
+
+/// Queue zault_vault_add_file. Returns a request id, or 0 on invalid
+/// arguments or allocation failure.
+export fn zault_async_add_file(
+    handle: ?*ZaultAsync,
+    file_path_ptr: ?[*]const u8,
+    file_path_len: usize,
+) u64 {
+    if (handle == null) return 0;
+    const path_z = dupePath(file_path_ptr, file_path_len) orelse return 0;
+    return submitRequest(handle, .{ .add = .{ .path = path_z } });
+}
+
+/// Queue zault_vault_get_file. Returns a request id, or 0 on failure.
+export fn zault_async_get_file(
+    handle: ?*ZaultAsync,
+    hash_ptr: ?[*]const u8,
+    hash_len: usize,
+    output_path_ptr: ?[*]const u8,
+    output_path_len: usize,
+) u64 {
+    if (handle == null or hash_ptr == null or hash_len != ZAULT_HASH_LEN) return 0;
+    const path_z = dupePath(output_path_ptr, output_path_len) orelse return 0;
+    return submitRequest(handle, .{ .get = .{ .hash = hash_ptr.?[0..ZAULT_HASH_LEN].*, .path = path_z } });
+}
+
+/// Queue zault_vault_create_share. The token is written to `token_out`,
+/// which must stay valid until the request completes; the completion's
+/// `len` holds the token length. Returns a request id, or 0 on failure.
+export fn zault_async_create_share(
+    handle: ?*ZaultAsync,
+    file_hash_ptr: ?[*]const u8,
+    file_hash_len: usize,
+    recipient_kem_pk_ptr: ?[*]const u8,
+    recipient_kem_pk_len: usize,
+    expires_at: i64,
+    token_out: ?[*]u8,
+    token_out_len: usize,
+) u64 {
+    if (handle == null or file_hash_ptr == null or file_hash_len != ZAULT_HASH_LEN) return 0;
+    if (recipient_kem_pk_ptr == null or recipient_kem_pk_len != ZAULT_MLKEM768_PK_LEN) return 0;
+    if (token_out == null) return 0;
+
+    return submitRequest(handle, .{ .share = .{
+        .hash = file_hash_ptr.?[0..ZAULT_HASH_LEN].*,
+        .recipient = recipient_kem_pk_ptr.?[0..ZAULT_MLKEM768_PK_LEN].*,
+        .expires_at = expires_at,
+        .token_out = token_out.?,
+        .token_out_len = token_out_len,
+    } });
+}
+
+/// Queue zault_vault_redeem_share; the token is copied. The completion's
+/// `hash` holds the shared file hash. Returns a request id, or 0 on failure.
+export fn zault_async_redeem_share(
+    handle: ?*ZaultAsync,
+    token_ptr: ?[*]const u8,
+    token_len: usize,
+) u64 {
+    if (handle == null or token_ptr == null or token_len == 0) return 0;
+    const token = ffi_allocator.dupe(u8, token_ptr.?[0..token_len]) catch return 0;
+    return submitRequest(handle, .{ .redeem = .{ .token = token } });
+}
+
+/// Copy finished requests into `out` and release them
+fn collect(tasks: []*Task, out: [*]ZaultCompletion) usize {
+    for (tasks, 0..) |task, i| {
+        const request: *Request = @fieldParentPtr("task", task);
+        out[i] = .{
+            .id = task.id,
+            .status = request.status,
+            .hash = request.hash,
+            .len = request.len,
+        };
+        request.destroy();
+    }
+    return tasks.len;
+}
+
+/// Collect up to `max` completions without blocking.
+/// Returns the number written to `out`.
+export fn zault_async_poll(handle: ?*ZaultAsync, out: ?[*]ZaultCompletion, max: usize) usize {
+    const context: *AsyncContext = @ptrCast(@alignCast(handle orelse return 0));
+    if (out == null) return 0;
+
+    var done: [64]*Task = undefined;
+    return collect(context.executor.poll(done[0..@min(max, done.len)]), out.?);
+}
+
+/// Like zault_async_poll, but block until at least one completion is
+/// ready, nothing is outstanding, or `timeout_ms` passes (negative = wait
+/// indefinitely).
+export fn zault_async_wait(handle: ?*ZaultAsync, out: ?[*]ZaultCompletion, max: usize, timeout_ms: i64) usize {
+    const context: *AsyncContext = @ptrCast(@alignCast(handle orelse return 0));
+    if (out == null) return 0;
+
+    // A timeout too long to count in nanoseconds is as good as none
+    const timeout_ns: ?u64 = if (timeout_ms < 0)
+        null
+    else
+        std.math.mul(u64, @intCast(timeout_ms), std.time.ns_per_ms) catch null;
+
+    var done: [64]*Task = undefined;
+    return collect(context.executor.wait(done[0..@min(max, done.len)], timeout_ns), out.?);
+}
+
 // =============================================================================
 // Crypto utilities (standalone, no vault needed)
 // =============================================================================
@@ -489,7 +973,9 @@ export fn zault_sha3_256(
 
     const data = if (data_ptr) |p| p[0..data_len] else &[_]u8{};
     var hash: [32]u8 = undefined;
+    const span = metrics.start(.sha3);
     crypto.Sha3_256.hash(data, &hash, .{});
+    span.end(data.len);
     @memcpy(hash_out.?[0..32], &hash);
     return ZAULT_OK;
 }
@@ -540,7 +1026,9 @@ export fn zault_encrypt_message(
     };
 
     // Encapsulate: generate shared secret
+    const encaps_span = metrics.start(.encaps);
     const encapsulation = recipient_pk.encaps(null); // null = random seed
+    encaps_span.end(0);
 
     // Derive encryption key from shared secret using HKDF
     const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &encapsulation.shared_secret);
@@ -570,6 +1058,7 @@ export fn zault_encrypt_message(
     // Encrypt message with ChaCha20-Poly1305
     // Note: We use empty AD since the recipient doesn't have sender identity during decryption
     // For authenticated messages, use zault_sign() separately
+    const seal_span = metrics.start(.aead_seal);
     crypto.ChaCha20Poly1305.encrypt(
         out[enc_start..][0..plaintext_len],
         out[tag_start..][0..16],
@@ -578,6 +1067,7 @@ export fn zault_encrypt_message(
         nonce,
         derived_key,
     );
+    seal_span.end(plaintext_len);
 
     // Sender identity is reserved for future use (e.g., embedding signature)
     _ = identity;
@@ -637,13 +1127,15 @@ export fn zault_decrypt_message(
     var tag: [16]u8 = undefined;
     @memcpy(&tag, input[tag_start..][0..16]);
 
-    // Decapsulate: recover shared secret
-    const secret_key = crypto.MLKem768.SecretKey.fromBytes(&ident.kem_secret_key) catch {
+    // Decapsulate: recover shared secret (key decoded once per identity)
+    const secret_key = ident.kemSecretKey() catch {
         return ZAULT_ERR_CRYPTO;
     };
+    const decaps_span = metrics.start(.decaps);
     const shared_secret = secret_key.decaps(&kem_ct) catch {
         return ZAULT_ERR_AUTH_FAILED;
     };
+    decaps_span.end(0);
 
     // Derive decryption key
     const prk = crypto.HkdfSha3_256.extract(&[_]u8{}, &shared_secret);
@@ -653,6 +1145,7 @@ export fn zault_decrypt_message(
     // Decrypt with ChaCha20-Poly1305
     // Note: We don't have sender's identity here for AD verification in anonymous case
     // For authenticated messages, caller should verify signature separately
+    const open_span = metrics.start(.aead_open);
     crypto.ChaCha20Poly1305.decrypt(
         plaintext_out.?[0..encrypted_len],
         input[enc_start..][0..encrypted_len],
@@ -664,6 +1157,7 @@ export fn zault_decrypt_message(
         @memset(&derived_key, 0);
         return ZAULT_ERR_AUTH_FAILED;
     };
+    open_span.end(encrypted_len);
 
     // Zero out derived key
     @memset(&derived_key, 0);
@@ -693,18 +1187,19 @@ export fn zault_sign(
     const ident: *const Identity = @ptrCast(@alignCast(identity.?));
     const data = if (data_ptr) |p| p[0..data_len] else &[_]u8{};
 
-    // Reconstruct secret key and create keypair for signing
-    const secret_key = crypto.MLDSA65.SecretKey.fromBytes(ident.secret_key) catch {
-        return ZAULT_ERR_CRYPTO;
-    };
-    const keypair = crypto.MLDSA65.KeyPair.fromSecretKey(secret_key) catch {
+    // Secret key is decoded once per identity, not per call
+    const secret_key = ident.signingKey() catch {
         return ZAULT_ERR_CRYPTO;
     };
 
-    // Sign the data
-    const signature = keypair.sign(data, null) catch {
+    // Sign the data (deterministic)
+    const span = metrics.start(.sign);
+    var signer = secret_key.signer(null) catch {
         return ZAULT_ERR_CRYPTO;
     };
+    signer.update(data);
+    const signature = signer.finalize();
+    span.end(data.len);
 
     @memcpy(signature_out.?[0..ZAULT_MLDSA65_SIG_LEN], &signature.toBytes());
     return ZAULT_OK;
@@ -739,9 +1234,11 @@ export fn zault_verify(
     };
 
     // Verify
+    const span = metrics.start(.verify);
     signature.verify(data, public_key) catch {
         return ZAULT_ERR_AUTH_FAILED;
     };
+    span.end(data.len);
 
     return ZAULT_OK;
 }
@@ -848,6 +1345,7 @@ export fn zault_chacha20_encrypt(
     @memcpy(out[0..12], &nonce);
 
     // Encrypt
+    const span = metrics.start(.aead_seal);
     crypto.ChaCha20Poly1305.encrypt(
         out[28..][0..plaintext_len],
         out[12..][0..16],
@@ -856,6 +1354,7 @@ export fn zault_chacha20_encrypt(
         nonce,
         key.*,
     );
+    span.end(plaintext_len);
 
     if (ciphertext_len_out) |len_out| {
         len_out.* = required_len;
@@ -893,6 +1392,7 @@ export fn zault_chacha20_decrypt(
     @memcpy(&tag, input[12..28]);
 
     // Decrypt
+    const span = metrics.start(.aead_open);
     crypto.ChaCha20Poly1305.decrypt(
         plaintext_out.?[0..encrypted_len],
         input[28..][0..encrypted_len],
@@ -903,6 +1403,7 @@ export fn zault_chacha20_decrypt(
     ) catch {
         return ZAULT_ERR_AUTH_FAILED;
     };
+    span.end(encrypted_len);
 
     if (plaintext_len_out) |len_out| {
         len_out.* = encrypted_len;
@@ -911,6 +1412,70 @@ export fn zault_chacha20_decrypt(
     return ZAULT_OK;
 }
 
+// =============================================================================
+// Metrics
+// =============================================================================
+
+// Stage indexes into ZaultMetrics.stages (zault_metrics_snapshot)
+pub const ZAULT_METRIC_SIGN: c_int = 0;
+pub const ZAULT_METRIC_VERIFY: c_int = 1;
+pub const ZAULT_METRIC_ENCAPS: c_int = 2;
+pub const ZAULT_METRIC_DECAPS: c_int = 3;
+pub const ZAULT_METRIC_AEAD_SEAL: c_int = 4;
+pub const ZAULT_METRIC_AEAD_OPEN: c_int = 5;
+pub const ZAULT_METRIC_SHA3: c_int = 6;
+pub const ZAULT_METRIC_STORE_READ: c_int = 7;
+pub const ZAULT_METRIC_STORE_WRITE: c_int = 8;
+pub const ZAULT_METRIC_FSYNC: c_int = 9;
+pub const ZAULT_METRIC_COUNT: usize = metrics.stage_count;
+pub const ZAULT_METRIC_BUCKETS: usize = metrics.bucket_count;
+
+comptime {
+    std.debug.assert(ZAULT_METRIC_FSYNC == @intFromEnum(metrics.Stage.fsync));
+    std.debug.assert(ZAULT_METRIC_COUNT == 10 and ZAULT_METRIC_BUCKETS == 32);
+}
+
+/// Totals for one instrumented stage. buckets[i] counts calls that took
+/// [2^i, 2^(i+1)) ns; the last bucket also holds everything slower.
+pub const ZaultMetricStage = extern struct {
+    count: u64,
+    total_ns: u64,
+    bytes: u64,
+    buckets: [ZAULT_METRIC_BUCKETS]u64,
+};
+
+/// Process-wide metrics, as returned by zault_metrics_snapshot
+pub const ZaultMetrics = extern struct {
+    /// 0 when libzault was built without -Dmetrics (all counters zero)
+    enabled: u32,
+    stage_count: u32,
+    stages: [ZAULT_METRIC_COUNT]ZaultMetricStage,
+};
+
+/// Copy the current counters and latency histograms of every stage.
+/// Safe to call from any thread while operations are running.
+export fn zault_metrics_snapshot(out: ?*ZaultMetrics) c_int {
+    if (out == null) return ZAULT_ERR_INVALID_ARG;
+
+    const totals = metrics.snapshot();
+    out.?.enabled = @intFromBool(metrics.enabled);
+    out.?.stage_count = ZAULT_METRIC_COUNT;
+    for (&out.?.stages, totals.stages) |*stage, total| {
+        stage.* = .{
+            .count = total.count,
+            .total_ns = total.total_ns,
+            .bytes = total.bytes,
+            .buckets = total.buckets,
+        };
+    }
+    return ZAULT_OK;
+}
+
+/// Zero every counter.
+export fn zault_metrics_reset() void {
+    metrics.reset();
+}
+
 // =============================================================================
 // Error strings
 // =============================================================================
@@ -1210,3 +1775,74 @@ test "ffi chacha20 tamper detection" {
     try std.testing.expectEqual(ZAULT_ERR_AUTH_FAILED, dec_result);
 }
 
+test "ffi async add and get round-trip" {
+    const test_dir = "zig-cache/test-ffi-async";
+    std.fs.cwd().deleteTree(test_dir) catch {};
+    defer std.fs.cwd().deleteTree(test_dir) catch {};
+    try std.fs.cwd().makePath(test_dir);
+
+    const input_path = test_dir ++ "/input.txt";
+    const output_path = test_dir ++ "/output.txt";
+    const content = "queued through the async API";
+    {
+        const file = try std.fs.cwd().createFile(input_path, .{});
+        defer file.close();
+        try file.writeAll(content);
+    }
+
+    const vault = zault_vault_init(test_dir ++ "/vault", (test_dir ++ "/vault").len);
+    try std.testing.expect(vault != null);
+    defer zault_vault_destroy(vault);
+
+    const context = zault_async_create(vault, 2);
+    try std.testing.expect(context != null);
+    defer zault_async_destroy(context);
+
+    var completions: [4]ZaultCompletion = undefined;
+
+    const add_id = zault_async_add_file(context, input_path, input_path.len);
+    try std.testing.expect(add_id != 0);
+    try std.testing.expectEqual(@as(usize, 1), zault_async_wait(context, &completions, completions.len, -1));
+    try std.testing.expectEqual(add_id, completions[0].id);
+    try std.testing.expectEqual(ZAULT_OK, completions[0].status);
+
+    const hash = completions[0].hash;
+    const get_id = zault_async_get_file(context, &hash, hash.len, output_path, output_path.len);
+    try std.testing.expect(get_id > add_id);
+    try std.testing.expectEqual(@as(usize, 1), zault_async_wait(context, &completions, completions.len, -1));
+    try std.testing.expectEqual(ZAULT_OK, completions[0].status);
+
+    const restored = try std.fs.cwd().readFileAlloc(output_path, std.testing.allocator, @enumFromInt(1024));
+    defer std.testing.allocator.free(restored);
+    try std.testing.expectEqualStrings(content, restored);
+
+    // Unknown hash completes with not found, as the blocking calls do;
+    // nothing left afterwards
+    const missing = [_]u8{0xAB} ** ZAULT_HASH_LEN;
+    _ = zault_async_get_file(context, &missing, missing.len, output_path, output_path.len);
+    try std.testing.expectEqual(@as(usize, 1), zault_async_wait(context, &completions, completions.len, -1));
+    try std.testing.expectEqual(ZAULT_ERR_NOT_FOUND, completions[0].status);
+    try std.testing.expectEqual(ZAULT_ERR_NOT_FOUND, zault_vault_get_file(vault, &missing, missing.len, output_path, output_path.len));
+    try std.testing.expectEqual(@as(usize, 0), zault_async_poll(context, &completions, completions.len));
+}
+
+test "ffi metrics snapshot" {
+    var snapshot: ZaultMetrics = undefined;
+    try std.testing.expectEqual(ZAULT_ERR_INVALID_ARG, zault_metrics_snapshot(null));
+
+    zault_metrics_reset();
+    const data = "measured";
+    var hash: [32]u8 = undefined;
+    try std.testing.expectEqual(ZAULT_OK, zault_sha3_256(data.ptr, data.len, &hash, hash.len));
+
+    try std.testing.expectEqual(ZAULT_OK, zault_metrics_snapshot(&snapshot));
+    try std.testing.expectEqual(@as(u32, ZAULT_METRIC_COUNT), snapshot.stage_count);
+
+    const sha3 = snapshot.stages[@intCast(ZAULT_METRIC_SHA3)];
+    if (snapshot.enabled == 0) {
+        try std.testing.expectEqual(@as(u64, 0), sha3.count);
+    } else {
+        try std.testing.expectEqual(@as(u64, 1), sha3.count);
+        try std.testing.expectEqual(@as(u64, data.len), sha3.bytes);
+    }
+}
@@ -9,18 +9,45 @@ pub const crypto = @import("core/crypto.zig");
 pub const identity = @import("core/identity.zig");
 pub const block = @import("core/block.zig");
 pub const store = @import("core/store.zig");
+pub const packstore = @import("core/packstore.zig");
+pub const memstore = @import("core/memstore.zig");
+pub const uring = @import("core/uring.zig");
+pub const executor = @import("core/executor.zig");
+pub const cache = @import("core/cache.zig");
+pub const verified = @import("core/verified.zig");
+pub const keys = @import("core/keys.zig");
+pub const metrics = @import("core/metrics.zig");
 pub const vault = @import("core/vault.zig");
 pub const metadata = @import("core/metadata.zig");
+pub const manifest = @import("core/manifest.zig");
+pub const index = @import("core/index.zig");
+pub const cdc = @import("core/cdc.zig");
+pub const batch = @import("core/batch.zig");
+pub const ingest = @import("core/ingest.zig");
+pub const verify = @import("core/verify.zig");
 pub const share = @import("core/share.zig");
 // Re-export commonly used types
 pub const Identity = identity.Identity;
 pub const Block = block.Block;
 pub const BlockType = block.BlockType;
+pub const BlockView = block.BlockView;
+pub const BlockHeader = block.BlockHeader;
+pub const BlockBuilder = block.BlockBuilder;
 pub const BlockStore = store.BlockStore;
 pub const BlockHash = store.BlockHash;
+pub const StoredBlock = store.StoredBlock;
+pub const LooseStore = store.LooseStore;
+pub const PackStore = packstore.PackStore;
+pub const MemoryStore = memstore.MemoryStore;
 pub const Vault = vault.Vault;
 pub const FileMetadata = metadata.FileMetadata;
+pub const ChunkManifest = manifest.ChunkManifest;
+pub const FileIndex = index.FileIndex;
 pub const Share = share.Share;
+pub const Executor = executor.Executor;
+pub const BlockCache = cache.BlockCache;
+pub const VerifiedSet = verified.VerifiedSet;
+pub const KeyRegistry = keys.KeyRegistry;
 
 test "core modules are accessible (also doubles as a test aggregator)" {
     // Verify all modules are accessible
@@ -28,7 +55,21 @@ test "core modules are accessible (also doubles as a test aggregator)" {
     _ = identity;
     _ = block;
     _ = store;
+    _ = packstore;
+    _ = memstore;
+    _ = uring;
+    _ = executor;
+    _ = cache;
+    _ = verified;
+    _ = keys;
+    _ = metrics;
     _ = vault;
     _ = metadata;
+    _ = manifest;
+    _ = index;
+    _ = cdc;
+    _ = batch;
+    _ = ingest;
+    _ = verify;
     _ = share;
 }